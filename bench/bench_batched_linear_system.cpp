@@ -0,0 +1,63 @@
+// Multi-channel convolution: one BatchedLinearSystem against one
+// MultiKernelLinearSystem per channel, 1..64 channels x 2 kernels
+#include "bench_harness.h"
+#include "utils/BatchedLinearSystem.h"
+#include "utils/MultiKernelLinearSystem.h"
+
+#include <vector>
+
+constexpr int KERNELS = 2;
+
+template <typename Config> static void benchChannels(int channels) {
+  constexpr int IR = static_cast<int>(Config::IR_SIZE);
+  constexpr int B = static_cast<int>(Config::BLOCK_SIZE);
+  using Batched = BatchedLinearSystem<IR, Config>;
+  using Single = MultiKernelLinearSystem<IR, KERNELS, Config>;
+
+  Batched batched(channels, KERNELS);
+  std::vector<Single> singles(channels);
+  for (int c = 0; c < channels; ++c) {
+    for (int k = 0; k < KERNELS; ++k) {
+      const typename Single::IRBlock h = Single::IRBlock::Random(IR);
+      batched.setImpulseResponse(c, k, h);
+      singles[c].setImpulseResponse(k, h);
+    }
+  }
+
+  const typename Batched::Frame x = Batched::Frame::Random(channels, B);
+  std::vector<typename Batched::Frame> outputs(KERNELS);
+  std::vector<typename Config::Block> inputs(channels);
+  for (int c = 0; c < channels; ++c)
+    inputs[c] = x.row(c).transpose();
+  std::array<typename Config::Block, KERNELS> ys;
+  const std::string size = "/B=" + std::to_string(B) +
+                           "/channels=" + std::to_string(channels);
+  const int iters = std::max(20, 20000 / channels);
+
+  const BenchResult s = runBench(
+      "per-channel" + size,
+      [&] {
+        for (int c = 0; c < channels; ++c) {
+          singles[c].step(inputs[c], ys);
+          doNotOptimize(ys);
+        }
+      },
+      iters);
+  const BenchResult b = runBench(
+      "batched" + size,
+      [&] {
+        batched.step(x, outputs);
+        doNotOptimize(outputs);
+      },
+      iters);
+  std::printf("  batched %.2fx vs per-channel, %.1f ns per channel\n",
+              s.ns_per_iter / b.ns_per_iter, b.ns_per_iter / channels);
+}
+
+int main() {
+  for (int channels : {1, 2, 4, 8, 16, 32, 64}) {
+    benchChannels<dsp::LowLatency64Config>(channels);
+    benchChannels<dsp::DefaultConfig>(channels);
+  }
+  return 0;
+}
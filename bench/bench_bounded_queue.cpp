@@ -0,0 +1,151 @@
+// BoundedQueue (lock-free MPMC) against a mutex + condition variable queue:
+// uncontended push/pop, then 1-16 threads split evenly between producers
+// and consumers moving a fixed number of items through a 1024-slot queue.
+#include "bench_harness.h"
+#include "utils/BoundedQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MutexQueue {
+public:
+  explicit MutexQueue(size_t capacity) : capacity_(capacity) {}
+
+  bool tryPush(uint64_t v) {
+    std::lock_guard<std::mutex> lk(m_);
+    if (q_.size() >= capacity_)
+      return false;
+    q_.push_back(v);
+    return true;
+  }
+  bool tryPop(uint64_t &out) {
+    std::lock_guard<std::mutex> lk(m_);
+    if (q_.empty())
+      return false;
+    out = q_.front();
+    q_.pop_front();
+    return true;
+  }
+  bool push(uint64_t v) {
+    std::unique_lock<std::mutex> lk(m_);
+    notFull_.wait(lk, [&] { return q_.size() < capacity_ || closed_; });
+    if (closed_)
+      return false;
+    q_.push_back(v);
+    notEmpty_.notify_one();
+    return true;
+  }
+  bool pop(uint64_t &out) {
+    std::unique_lock<std::mutex> lk(m_);
+    notEmpty_.wait(lk, [&] { return !q_.empty() || closed_; });
+    if (q_.empty())
+      return false;
+    out = q_.front();
+    q_.pop_front();
+    notFull_.notify_one();
+    return true;
+  }
+  void close() {
+    std::lock_guard<std::mutex> lk(m_);
+    closed_ = true;
+    notFull_.notify_all();
+    notEmpty_.notify_all();
+  }
+
+private:
+  std::mutex m_;
+  std::condition_variable notFull_, notEmpty_;
+  std::deque<uint64_t> q_;
+  size_t capacity_;
+  bool closed_ = false;
+};
+
+// `threads` threads (half producers, half consumers; one thread does both)
+// move `items` values through the queue. Returns items per second.
+template <typename Queue> double contended(int threads, uint64_t items) {
+  Queue q(1024);
+  const int producers = std::max(1, threads / 2);
+  const int consumers = std::max(1, threads - producers);
+  std::atomic<uint64_t> checksum{0};
+
+  const auto t0 = std::chrono::steady_clock::now();
+  if (threads == 1) {
+    uint64_t v = 0, sum = 0;
+    for (uint64_t i = 0; i < items; ++i) {
+      q.tryPush(i);
+      q.tryPop(v);
+      sum += v;
+    }
+    checksum = sum;
+  } else {
+    std::vector<std::jthread> pool;
+    for (int c = 0; c < consumers; ++c)
+      pool.emplace_back([&] {
+        uint64_t v, sum = 0;
+        while (q.pop(v))
+          sum += v;
+        checksum.fetch_add(sum);
+      });
+    {
+      std::vector<std::jthread> prod;
+      for (int p = 0; p < producers; ++p)
+        prod.emplace_back([&, p] {
+          for (uint64_t i = p; i < items; i += producers)
+            q.push(i);
+        });
+    }
+    q.close();
+  }
+  // consumers joined by the pool going out of scope above
+  const auto t1 = std::chrono::steady_clock::now();
+  doNotOptimize(checksum);
+  return items / std::chrono::duration<double>(t1 - t0).count();
+}
+
+template <typename Queue> double bestOf(int threads, uint64_t items) {
+  double best = 0;
+  for (int r = 0; r < 3; ++r)
+    best = std::max(best, contended<Queue>(threads, items));
+  return best;
+}
+
+int main() {
+  BoundedQueue<uint64_t> bq(1024);
+  uint64_t out = 0, i = 0;
+  runBench(
+      "queue/bounded_mpmc_push_pop",
+      [&] {
+        bq.tryPush(++i);
+        bq.tryPop(out);
+        doNotOptimize(out);
+      },
+      1000000);
+
+  MutexQueue mq(1024);
+  runBench(
+      "queue/mutex_push_pop",
+      [&] {
+        mq.tryPush(++i);
+        mq.tryPop(out);
+        doNotOptimize(out);
+      },
+      1000000);
+
+  std::printf("\n%-8s %16s %16s %8s\n", "threads", "mpmc items/s",
+              "mutex items/s", "ratio");
+  constexpr uint64_t kItems = 400000;
+  for (int threads : {1, 2, 4, 8, 16}) {
+    const double lockFree = bestOf<BoundedQueue<uint64_t>>(threads, kItems);
+    const double locked = bestOf<MutexQueue>(threads, kItems);
+    std::printf("%-8d %16.0f %16.0f %7.2fx\n", threads, lockFree, locked,
+                lockFree / locked);
+  }
+  return 0;
+}
@@ -0,0 +1,72 @@
+// Complex MAC acc += sum_p X_p * H_p: each ISA kernel on split spectra
+// against the interleaved Eigen cwiseProduct loop the engines used before,
+// at the bin / partition counts of the partitioned convolvers
+#include "bench_harness.h"
+#include "utils/ComplexMac.h"
+
+#include <Eigen/Dense>
+#include <vector>
+
+static void benchSize(int bins, int parts) {
+  const int stride = simd::splitStride(bins);
+  std::vector<Eigen::VectorXcf> x(parts), h(parts);
+  std::vector<Eigen::VectorXf> xs(parts), hs(parts);
+  std::vector<const float *> xp(parts), hp(parts);
+  for (int p = 0; p < parts; ++p) {
+    x[p] = Eigen::VectorXcf::Random(bins);
+    h[p] = Eigen::VectorXcf::Random(bins);
+    xs[p].resize(2 * stride);
+    hs[p].resize(2 * stride);
+    simd::toSplit(x[p].data(), xs[p].data(), stride, bins);
+    simd::toSplit(h[p].data(), hs[p].data(), stride, bins);
+    xp[p] = xs[p].data();
+    hp[p] = hs[p].data();
+  }
+  Eigen::VectorXcf acc = Eigen::VectorXcf::Zero(bins);
+  const int iters = std::max(20, 2000000 / (bins * parts));
+  const std::string size =
+      "/bins=" + std::to_string(bins) + "/parts=" + std::to_string(parts);
+
+  const BenchResult base = runBench(
+      "eigen_interleaved" + size,
+      [&] {
+        acc.setZero();
+        for (int p = 0; p < parts; ++p)
+          acc.noalias() += x[p].cwiseProduct(h[p]);
+        doNotOptimize(acc);
+      },
+      iters);
+
+  for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2,
+                        simd::Isa::AVX512}) {
+    const simd::ComplexMacFn fn = simd::complexMacKernel(isa);
+    if (!fn) {
+      std::printf("%-48s %12s\n",
+                  (std::string(simd::isaName(isa)) + size).c_str(),
+                  "unsupported");
+      continue;
+    }
+    const BenchResult r = runBench(
+        std::string(simd::isaName(isa)) + size,
+        [&] {
+          acc.setZero();
+          fn(acc.data(), xp.data(), hp.data(), parts, stride, bins, false);
+          doNotOptimize(acc);
+        },
+        iters);
+    std::printf("  %.2fx vs eigen  %.2f GFLOP/s\n",
+                base.ns_per_iter / r.ns_per_iter,
+                8.0 * bins * parts / r.ns_per_iter);
+  }
+}
+
+int main() {
+  std::printf("detected ISA: %s\n", simd::isaName(simd::detectedIsa()));
+  // Half-spectrum sizes of the 2B transforms for B = 64, 128, 256, 512
+  for (int bins : {65, 129, 257, 513}) {
+    for (int parts : {4, 32, 256}) {
+      benchSize(bins, parts);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Direct-form FIR for short responses: each ISA kernel on one block, and
+// LinearSystem (direct form) against the partitioned FFT engine for
+// 16..256 nonzero taps at the small block sizes where direct form pays off
+#include "bench_harness.h"
+#include "utils/DirectFir.h"
+#include "utils/LinearSystem.h"
+#include "utils/MultiKernelLinearSystem.h"
+
+#include <Eigen/Dense>
+
+static void benchKernels(int taps, int n) {
+  Eigen::VectorXf history = Eigen::VectorXf::Random(taps - 1 + n);
+  Eigen::VectorXf h = Eigen::VectorXf::Random(taps);
+  Eigen::VectorXf y(n);
+  const float *x = history.data() + taps - 1;
+  const std::string size =
+      "/taps=" + std::to_string(taps) + "/n=" + std::to_string(n);
+  double scalar = 0.0;
+  for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2,
+                        simd::Isa::AVX512}) {
+    const simd::DirectFirFn fn = simd::directFirKernel(isa);
+    if (!fn) {
+      std::printf("%-48s %12s\n",
+                  (std::string(simd::isaName(isa)) + size).c_str(),
+                  "unsupported");
+      continue;
+    }
+    const BenchResult r = runBench(
+        std::string(simd::isaName(isa)) + size,
+        [&] {
+          fn(y.data(), x, h.data(), taps, n);
+          doNotOptimize(y);
+        },
+        std::max(20, 4000000 / (taps * n)));
+    if (isa == simd::Isa::Scalar)
+      scalar = r.ns_per_iter;
+    else
+      std::printf("  %.2fx vs scalar\n", scalar / r.ns_per_iter);
+  }
+}
+
+// Engine step() with a response of `taps` nonzero taps out of IR_SIZE
+template <typename Config> static void benchEngines(int taps) {
+  constexpr int IR = static_cast<int>(Config::IR_SIZE);
+  using Direct = LinearSystem<IR, Config>;
+  using Partitioned = MultiKernelLinearSystem<IR, 1, Config>;
+  typename Direct::IRBlock h = Direct::IRBlock::Zero();
+  h.head(taps).setRandom();
+
+  Direct direct(h);
+  Partitioned partitioned;
+  partitioned.setImpulseResponse(0, h);
+  const typename Config::Block x = Config::Block::Random();
+  typename Config::Block y;
+  std::array<typename Config::Block, 1> ys;
+  const std::string size = "/B=" + std::to_string(Config::BLOCK_SIZE) +
+                           "/taps=" + std::to_string(taps);
+
+  const BenchResult d = runBench(
+      "direct" + size,
+      [&] {
+        direct.step(x, y);
+        doNotOptimize(y);
+      },
+      4000);
+  const BenchResult p = runBench(
+      "partitioned" + size,
+      [&] {
+        partitioned.step(x, ys);
+        doNotOptimize(ys);
+      },
+      4000);
+  std::printf("  direct %.2fx vs partitioned\n",
+              p.ns_per_iter / d.ns_per_iter);
+}
+
+int main() {
+  std::printf("detected ISA: %s\n", simd::isaName(simd::detectedIsa()));
+  for (int taps : {16, 64, 128})
+    for (int n : {32, 256})
+      benchKernels(taps, n);
+
+  for (int taps : {16, 64, 128, 256}) {
+    benchEngines<dsp::LowLatency32Config>(taps);
+    benchEngines<dsp::DefaultConfig>(taps);
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+// FastLinearSystem: half-spectrum (R2C/C2R) path vs. full complex spectrum
+#include "bench_harness.h"
+#include "utils/FastLinearSystem.h"
+
+template <bool HALF> static BenchResult benchStep(const char *name) {
+  using Sys = FastLinearSystem<dsp::IR_SIZE, HALF>;
+  Sys sys(Sys::IRBlock::Random());
+  typename Sys::Block x = Sys::Block::Random();
+  typename Sys::Block y;
+  return runBench(
+      name,
+      [&] {
+        sys.step(x, y);
+        doNotOptimize(y);
+      },
+      2000);
+}
+
+int main() {
+  std::printf("BLOCK_SIZE=%zu IR_SIZE=%zu FFT_SIZE=%d\n", dsp::BLOCK_SIZE,
+              dsp::IR_SIZE, FastLinearSystem<dsp::IR_SIZE>::FFT_SIZE);
+  const BenchResult full = benchStep<false>("step/full_spectrum");
+  const BenchResult half = benchStep<true>("step/half_spectrum");
+  std::printf("speedup: %.2fx, kernel bytes: %zu -> %zu\n",
+              full.ns_per_iter / half.ns_per_iter,
+              sizeof(FastLinearSystem<dsp::IR_SIZE, false>::FFTBlock),
+              sizeof(FastLinearSystem<dsp::IR_SIZE, true>::FFTBlock));
+  return 0;
+}
@@ -0,0 +1,34 @@
+// fft::RealFFT backends: forward + inverse pair at the transform sizes the
+// engines use (2B for the partitioned engines at B = 32..1024, the
+// FastLinearSystem / KernelComposer sizes, and the non-uniform tail levels)
+#include "bench_harness.h"
+#include "utils/RealFFT.h"
+
+#include <Eigen/Dense>
+
+static double benchBackend(fft::Backend backend, int n) {
+  fft::RealFFT t(n, backend);
+  Eigen::VectorXf x = Eigen::VectorXf::Random(n);
+  Eigen::VectorXcf X(t.bins());
+  Eigen::VectorXf y(n);
+  return runBench(std::string(fft::backendName(backend)) +
+                      "/n=" + std::to_string(n),
+                  [&] {
+                    t.fwd(X.data(), x.data());
+                    t.inv(y.data(), X.data());
+                    doNotOptimize(y);
+                  },
+                  std::max(20, 4000000 / n))
+      .ns_per_iter;
+}
+
+int main() {
+  std::printf("default backend: %s\n",
+              fft::backendName(fft::defaultBackend()));
+  for (int n : {64, 128, 512, 2048, 4096, 8192, 32768}) {
+    const double kiss = benchBackend(fft::Backend::Kiss, n);
+    const double split = benchBackend(fft::Backend::Split, n);
+    std::printf("  split %.2fx vs kiss\n", kiss / split);
+  }
+  return 0;
+}
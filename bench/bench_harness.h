@@ -0,0 +1,40 @@
+// Minimal benchmark harness — no external dependencies
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Keep the optimizer from discarding results that are otherwise unused
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+  std::string name;
+  double ns_per_iter;
+};
+
+// Time `fn` for `iters` iterations after a short warm-up. Reports the best of
+// `reps` repetitions, which is the least noisy estimate on a shared machine.
+template <typename Fn>
+inline BenchResult runBench(const std::string &name, Fn &&fn, int iters,
+                            int reps = 5) {
+  using Clock = std::chrono::steady_clock;
+  for (int i = 0; i < std::max(1, iters / 10); ++i)
+    fn();
+
+  double best = 1e300;
+  for (int r = 0; r < reps; ++r) {
+    const auto t0 = Clock::now();
+    for (int i = 0; i < iters; ++i)
+      fn();
+    const auto t1 = Clock::now();
+    const double ns =
+        std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+    best = std::min(best, ns);
+  }
+  std::printf("%-48s %12.1f ns/iter\n", name.c_str(), best);
+  return {name, best};
+}
@@ -0,0 +1,110 @@
+// Latest-value handoff of a mic-sized payload (two 256-float blocks):
+// DoubleBufferSPSC (can tear), TripleBuffer, and a mutex-guarded copy. Then
+// both sides running concurrently, counting torn reads.
+#include "bench_harness.h"
+#include "dsp_config.h"
+#include "utils/DoubleBufferSPSC.h"
+#include "utils/TripleBuffer.h"
+
+#include <Eigen/Dense>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using Payload = Eigen::Matrix<float, 2 * dsp::BLOCK_SIZE, 1>;
+
+struct MutexLatest {
+  void publish(const Payload &v) {
+    std::lock_guard<std::mutex> lk(m);
+    value = v;
+    fresh = true;
+  }
+  bool tryRead(Payload &out) {
+    std::lock_guard<std::mutex> lk(m);
+    if (!fresh)
+      return false;
+    out = value;
+    fresh = false;
+    return true;
+  }
+  std::mutex m;
+  Payload value = Payload::Zero();
+  bool fresh = false;
+};
+
+// Writer publishes for `ms`; reader polls. Reports rates and torn reads.
+template <typename Chan> void concurrent(const char *name, int ms) {
+  Chan ch;
+  std::atomic<bool> stop{false};
+  uint64_t writes = 0;
+  std::jthread writer([&] {
+    Payload p;
+    while (!stop.load(std::memory_order_relaxed)) {
+      p.setConstant(static_cast<float>(++writes));
+      ch.publish(p);
+    }
+  });
+
+  uint64_t reads = 0, torn = 0;
+  Payload out;
+  const auto until =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+  while (std::chrono::steady_clock::now() < until) {
+    if (ch.tryRead(out)) {
+      ++reads;
+      torn += out.minCoeff() != out.maxCoeff();
+    }
+  }
+  stop = true;
+  writer.join();
+  const double s = ms / 1000.0;
+  std::printf("%-32s %10.0f writes/s %10.0f reads/s %8llu torn\n", name,
+              writes / s, reads / s, static_cast<unsigned long long>(torn));
+}
+
+int main() {
+  Payload p = Payload::Random(), out;
+
+  DoubleBufferSPSC<Payload> db;
+  runBench(
+      "latest/double_buffer_publish_read",
+      [&] {
+        db.publish(p);
+        db.tryRead(out);
+        doNotOptimize(out);
+      },
+      200000);
+
+  TripleBuffer<Payload> tb;
+  runBench(
+      "latest/triple_buffer_publish_read",
+      [&] {
+        tb.publish(p);
+        tb.tryRead(out);
+        doNotOptimize(out);
+      },
+      200000);
+  runBench(
+      "latest/triple_buffer_publish_acquire",
+      [&] {
+        tb.publish(p);
+        doNotOptimize(tb.acquire());
+      },
+      200000);
+
+  MutexLatest ml;
+  runBench(
+      "latest/mutex_publish_read",
+      [&] {
+        ml.publish(p);
+        ml.tryRead(out);
+        doNotOptimize(out);
+      },
+      200000);
+
+  std::printf("\n");
+  concurrent<DoubleBufferSPSC<Payload>>("concurrent/double_buffer", 300);
+  concurrent<TripleBuffer<Payload>>("concurrent/triple_buffer", 300);
+  concurrent<MutexLatest>("concurrent/mutex", 300);
+  return 0;
+}
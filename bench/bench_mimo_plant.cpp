@@ -0,0 +1,82 @@
+// MIMO plant propagation per block: one PartitionedLinearSystem per path
+// (mics x (1 + speakers) convolutions, each with its own FFT pair) vs.
+// MimoLinearSystem path matrices for the noise and the speakers with one
+// SpectralSum per mic, as BasicDSPInterface runs them
+#include "bench_harness.h"
+#include "utils/MimoLinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+#include <string>
+#include <vector>
+
+using PLS = PartitionedLinearSystem<dsp::IR_SIZE>;
+using Mimo = MimoLinearSystem<dsp::IR_SIZE>;
+using Block = PLS::Block;
+using IRBlock = PLS::IRBlock;
+
+static void benchTopology(int referenceMics, int errorMics, int speakers) {
+  const int mics = referenceMics + errorMics;
+  std::vector<PLS> noiseSeparate(mics), speakerSeparate(mics * speakers);
+  Mimo noisePaths(1, mics), speakerPaths(speakers, mics);
+  for (int m = 0; m < mics; ++m) {
+    const IRBlock h = IRBlock::Random();
+    noiseSeparate[m].setImpulseResponse(h);
+    noisePaths.setImpulseResponse(m, 0, h);
+    for (int l = 0; l < speakers; ++l) {
+      const IRBlock c = IRBlock::Random();
+      speakerSeparate[m * speakers + l].setImpulseResponse(c);
+      speakerPaths.setImpulseResponse(m, l, c);
+    }
+  }
+
+  const Block n = Block::Random();
+  const Eigen::MatrixXf u = Eigen::MatrixXf::Random(dsp::BLOCK_SIZE, speakers);
+  std::vector<Block> us(speakers);
+  for (int l = 0; l < speakers; ++l)
+    us[l] = u.col(l);
+  std::vector<Block> out(mics);
+  std::vector<SpectralSum> sums(mics);
+  Block y;
+  const std::string name = "/" + std::to_string(referenceMics) + "x" +
+                           std::to_string(errorMics) + "x" +
+                           std::to_string(speakers);
+
+  const BenchResult separate = runBench(
+      "mimo_plant/separate_paths" + name,
+      [&] {
+        for (int m = 0; m < mics; ++m) {
+          noiseSeparate[m].step(n, out[m]);
+          for (int l = 0; l < speakers; ++l) {
+            speakerSeparate[m * speakers + l].step(us[l], y);
+            out[m] += y;
+          }
+        }
+        doNotOptimize(out);
+      },
+      1000);
+  const BenchResult matrix = runBench(
+      "mimo_plant/path_matrices" + name,
+      [&] {
+        noisePaths.push(n);
+        speakerPaths.push(u);
+        for (int m = 0; m < mics; ++m) {
+          sums[m].clear();
+          noisePaths.accumulate(m, sums[m]);
+          speakerPaths.accumulate(m, sums[m]);
+          sums[m].finish(out[m]);
+        }
+        doNotOptimize(out);
+      },
+      1000);
+  std::printf("  path matrices %.2fx vs separate paths (%d convolutions)\n",
+              separate.ns_per_iter / matrix.ns_per_iter,
+              mics * (1 + speakers));
+}
+
+int main() {
+  benchTopology(1, 1, 1);
+  benchTopology(2, 1, 1);
+  benchTopology(2, 2, 2);
+  benchTopology(4, 2, 2);
+  return 0;
+}
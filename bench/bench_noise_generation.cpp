@@ -0,0 +1,55 @@
+// Gaussian noise for one block: per-sample std::normal_distribution over
+// mt19937 (the old generateMicNoiseBlock_ path) vs. Philox4x32 block fills
+#include "bench_harness.h"
+#include "dsp_config.h"
+#include "utils/Philox.h"
+
+#include <random>
+
+using Block = Eigen::Matrix<float, dsp::BLOCK_SIZE, 1>;
+using IRBlock = Eigen::Matrix<float, dsp::IR_SIZE, 1>;
+
+int main() {
+  std::mt19937 mt(42);
+  Block out;
+  const BenchResult scalar = runBench(
+      "noise/mt19937_normal_per_sample",
+      [&] {
+        for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+          std::normal_distribution<float> dist(0.0f, 1.0f);
+          out(i) = dist(mt);
+        }
+        doNotOptimize(out);
+      },
+      20000);
+
+  Philox4x32 rng(42, 0);
+  const BenchResult philox = runBench(
+      "noise/philox_fill_normal",
+      [&] {
+        rng.fillNormal(out);
+        doNotOptimize(out);
+      },
+      20000);
+
+  runBench(
+      "noise/philox_fill_uniform",
+      [&] {
+        rng.fillUniform(out, -1.0f, 1.0f);
+        doNotOptimize(out);
+      },
+      20000);
+
+  IRBlock ir;
+  runBench(
+      "noise/philox_fill_uniform_ir",
+      [&] {
+        rng.fillUniform(ir, -1.0f, 1.0f);
+        doNotOptimize(ir);
+      },
+      5000);
+
+  std::printf("\nphilox normal speedup: %.2fx\n",
+              scalar.ns_per_iter / philox.ns_per_iter);
+  return 0;
+}
@@ -0,0 +1,49 @@
+// NonUniformLinearSystem: 1 s and 2 s impulse responses paced in real time.
+// Reports what the audio callback pays (head only) and the worker's slack.
+#include "bench_harness.h"
+#include "utils/NonUniformLinearSystem.h"
+
+#include <thread>
+
+template <int N> static void benchRealTime(int seconds) {
+  using Sys = NonUniformLinearSystem<N>;
+  using Clock = std::chrono::steady_clock;
+  typename Sys::IRBlock h = Sys::IRBlock::Random(N) * 0.01f;
+  Sys sys(h);
+  typename Sys::Block x = Sys::Block::Random();
+  typename Sys::Block y;
+
+  const int blocks = seconds * dsp::SAMPLE_RATE / dsp::BLOCK_SIZE;
+  const auto period = std::chrono::microseconds(dsp::BLOCK_LATENCY_US);
+  double sumNs = 0.0;
+  double maxNs = 0.0;
+  auto next = Clock::now();
+  for (int b = 0; b < blocks; ++b) {
+    const auto t0 = Clock::now();
+    sys.step(x, y);
+    doNotOptimize(y);
+    const double ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    sumNs += ns;
+    maxNs = std::max(maxNs, ns);
+    next += period;
+    std::this_thread::sleep_until(next);
+  }
+
+  const auto s = sys.workerStats();
+  std::printf("ir=%d taps (%.1f s), %zu tail levels\n", N,
+              N / static_cast<double>(dsp::SAMPLE_RATE), sys.levels().size());
+  std::printf("  callback: mean %.1f us, max %.1f us (budget %d us)\n",
+              sumNs / blocks * 1e-3, maxNs * 1e-3, dsp::BLOCK_LATENCY_US);
+  std::printf("  worker: %llu segments, %llu late, slack min %.1f us mean "
+              "%.1f us, max stall %.1f us\n",
+              static_cast<unsigned long long>(s.segments),
+              static_cast<unsigned long long>(s.late), s.minSlackUs,
+              s.meanSlackUs, s.maxWaitUs);
+}
+
+int main() {
+  benchRealTime<dsp::SAMPLE_RATE>(3);
+  benchRealTime<2 * dsp::SAMPLE_RATE>(4);
+  return 0;
+}
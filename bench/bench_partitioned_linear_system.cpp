@@ -0,0 +1,50 @@
+// PartitionedLinearSystem: per-block cost vs. IR length, against the real-time
+// budget of one block (BLOCK_SIZE / SAMPLE_RATE)
+#include "bench_harness.h"
+#include "utils/FastLinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+template <int N> static void benchPartitioned() {
+  using Sys = PartitionedLinearSystem<N>;
+  typename Sys::IRBlock h = Sys::IRBlock::Random(N);
+  Sys sys(h);
+  typename Sys::Block x = Sys::Block::Random();
+  typename Sys::Block y;
+  const BenchResult r = runBench(
+      "partitioned/ir=" + std::to_string(N),
+      [&] {
+        sys.step(x, y);
+        doNotOptimize(y);
+      },
+      std::max(50, 200000 / N));
+  std::printf("  partitions=%d  %.2f%% of block budget\n", Sys::NUM_PARTITIONS,
+              100.0 * r.ns_per_iter / (dsp::BLOCK_LATENCY_US * 1000.0));
+}
+
+int main() {
+  std::printf("BLOCK_SIZE=%zu FFT_SIZE=%d budget=%d us/block\n",
+              dsp::BLOCK_SIZE, Partitioning::FFT_SIZE, dsp::BLOCK_LATENCY_US);
+
+  // Reference point: single-FFT engine at the only length it supports
+  {
+    using Fast = FastLinearSystem<dsp::IR_SIZE>;
+    Fast sys(Fast::IRBlock::Random());
+    Fast::Block x = Fast::Block::Random();
+    Fast::Block y;
+    runBench("fast/ir=" + std::to_string(dsp::IR_SIZE),
+             [&] {
+               sys.step(x, y);
+               doNotOptimize(y);
+             },
+             200);
+  }
+
+  benchPartitioned<1024>();
+  benchPartitioned<2048>();
+  benchPartitioned<4096>();
+  benchPartitioned<8192>();
+  benchPartitioned<16384>();
+  benchPartitioned<32768>();
+  benchPartitioned<65536>();
+  return 0;
+}
@@ -0,0 +1,107 @@
+// Plant propagation per block: independent engines per path vs. shared input
+// spectra with per-mic frequency-domain summation vs. additionally folding
+// the speaker stage into the C and S kernels
+#include "bench_harness.h"
+#include "utils/KernelComposition.h"
+#include "utils/MultiKernelLinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+using PLS = PartitionedLinearSystem<dsp::IR_SIZE>;
+using MK = MultiKernelLinearSystem<dsp::IR_SIZE, 2>;
+using Block = PLS::Block;
+using IRBlock = PLS::IRBlock;
+
+int main() {
+  const IRBlock H = IRBlock::Random(), P = IRBlock::Random();
+  const IRBlock C = IRBlock::Random(), S = IRBlock::Random();
+  const IRBlock spk = IRBlock::Random();
+  const Block n = Block::Random(), u = Block::Random();
+
+  // 5 forward + 5 inverse FFTs
+  PLS speaker(spk), sysH(H), sysP(P), sysC(C), sysS(S);
+  Block uSpk, yH, yP, yC, yS, outside, inear;
+  const BenchResult separate = runBench(
+      "plant/separate_engines",
+      [&] {
+        speaker.step(u, uSpk);
+        sysC.step(uSpk, yC);
+        sysS.step(uSpk, yS);
+        sysH.step(n, yH);
+        sysP.step(n, yP);
+        outside = yH + yC;
+        inear = yP + yS;
+        doNotOptimize(outside);
+        doNotOptimize(inear);
+      },
+      2000);
+
+  // 3 forward + 3 inverse FFTs (speaker stage kept separate)
+  PLS speaker2(spk);
+  MK noisePaths, speakerPaths;
+  noisePaths.setImpulseResponse(0, H);
+  noisePaths.setImpulseResponse(1, P);
+  speakerPaths.setImpulseResponse(0, C);
+  speakerPaths.setImpulseResponse(1, S);
+  SpectralSum outsideMic, inearMic;
+  const BenchResult shared = runBench(
+      "plant/shared_spectra",
+      [&] {
+        speaker2.step(u, uSpk);
+        noisePaths.push(n);
+        speakerPaths.push(uSpk);
+        outsideMic.clear();
+        noisePaths.accumulate(0, outsideMic.spectrum());
+        speakerPaths.accumulate(0, outsideMic.spectrum());
+        outsideMic.finish(outside);
+        inearMic.clear();
+        noisePaths.accumulate(1, inearMic.spectrum());
+        speakerPaths.accumulate(1, inearMic.spectrum());
+        inearMic.finish(inear);
+        doNotOptimize(outside);
+        doNotOptimize(inear);
+      },
+      2000);
+
+  // 2 forward + 2 inverse FFTs
+  using Composer = KernelComposer<dsp::IR_SIZE, dsp::IR_SIZE>;
+  Composer composer;
+  composer.setFirst(spk);
+  MultiKernelLinearSystem<Composer::OUT_SIZE, 2> foldedPaths;
+  foldedPaths.setImpulseResponse(0, composer.compose(C));
+  foldedPaths.setImpulseResponse(1, composer.compose(S));
+  MK noisePaths2;
+  noisePaths2.setImpulseResponse(0, H);
+  noisePaths2.setImpulseResponse(1, P);
+  const BenchResult folded = runBench(
+      "plant/shared_spectra_folded_speaker",
+      [&] {
+        noisePaths2.push(n);
+        foldedPaths.push(u);
+        outsideMic.clear();
+        noisePaths2.accumulate(0, outsideMic.spectrum());
+        foldedPaths.accumulate(0, outsideMic.spectrum());
+        outsideMic.finish(outside);
+        inearMic.clear();
+        noisePaths2.accumulate(1, inearMic.spectrum());
+        foldedPaths.accumulate(1, inearMic.spectrum());
+        inearMic.finish(inear);
+        doNotOptimize(outside);
+        doNotOptimize(inear);
+      },
+      2000);
+
+  // Cost of refolding S after it changes (paid per kernel update)
+  Composer::Composed foldedS;
+  runBench(
+      "fold/recompose_speaker_S",
+      [&] {
+        composer.compose(S, foldedS);
+        doNotOptimize(foldedS);
+      },
+      500);
+
+  std::printf("speedup vs separate: shared %.2fx, folded %.2fx\n",
+              separate.ns_per_iter / shared.ns_per_iter,
+              separate.ns_per_iter / folded.ns_per_iter);
+  return 0;
+}
@@ -0,0 +1,48 @@
+// Effective-length trimming: an exponentially decaying response (RT60 0.1 s
+// at 48 kHz) in a 16384-tap buffer on the partitioned engine, kept exact and
+// trimmed to -100 / -80 / -60 dB, at B = 32 and 256
+#include "bench_harness.h"
+#include "utils/ImpulseResponseAnalysis.h"
+#include "utils/MultiKernelLinearSystem.h"
+
+#include <cmath>
+
+template <typename Config> static void benchTolerances() {
+  constexpr int N = 16384;
+  constexpr int B = static_cast<int>(Config::BLOCK_SIZE);
+  using Sys = MultiKernelLinearSystem<N, 1, Config>;
+  typename Sys::IRBlock h = Sys::IRBlock::Random(N);
+  // -60 dB after 0.1 s: amplitude falls by 10^(-3 / 4800) per sample
+  for (int i = 0; i < N; ++i)
+    h(i) *= std::pow(10.0f, -3.0f * i / 4800.0f);
+
+  const typename Config::Block x = Config::Block::Random();
+  std::array<typename Config::Block, 1> y;
+  double exact = 0.0;
+  for (float tol : {kExactTolerance, -100.0f, -80.0f, -60.0f}) {
+    typename Sys::IRBlock trimmed = h;
+    trimToTolerance(trimmed, B, tol);
+    Sys sys;
+    sys.setImpulseResponse(0, trimmed);
+    const std::string name =
+        "B=" + std::to_string(B) + "/" +
+        (tol > kExactTolerance ? std::to_string(int(tol)) + "dB" : "exact");
+    const BenchResult r = runBench(
+        name,
+        [&] {
+          sys.step(x, y);
+          doNotOptimize(y);
+        },
+        std::max(200, 200000 / B));
+    if (tol == kExactTolerance)
+      exact = r.ns_per_iter;
+    std::printf("  %d of %d taps, %.2fx vs exact\n", effectiveLength(trimmed),
+                N, exact / r.ns_per_iter);
+  }
+}
+
+int main() {
+  benchTolerances<dsp::LowLatency32Config>();
+  benchTolerances<dsp::DefaultConfig>();
+  return 0;
+}
@@ -1,16 +1,23 @@
 #include "audio_source.h"
 #include "wav_file_source.h"
 
-std::unique_ptr<AudioSource> AudioSourceFactory::create(const Config& config) {
+template <typename DspConfig>
+std::unique_ptr<BasicAudioSource<DspConfig>>
+AudioSourceFactory::create(const Config& config) {
     switch (config.type) {
         case Type::WavFile: {
-            WavFileSource::Config wavConfig;
+            typename BasicWavFileSource<DspConfig>::Config wavConfig;
             wavConfig.inputPath = config.inputWavPath;
             wavConfig.outputPath = config.outputWavPath;
             wavConfig.loop = config.loop;
-            return std::make_unique<WavFileSource>(wavConfig);
+            return std::make_unique<BasicWavFileSource<DspConfig>>(wavConfig);
         }
     }
     
     return nullptr;
 }
+
+#define INSTANTIATE_CREATE(C)                                                  \
+  template std::unique_ptr<BasicAudioSource<C>>                                \
+  AudioSourceFactory::create<C>(const Config &);
+DSP_FOR_EACH_CONFIG(INSTANTIATE_CREATE)
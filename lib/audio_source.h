@@ -10,12 +10,16 @@ using Block = Eigen::Matrix<float, dsp::BLOCK_SIZE, 1>;
 
 /**
  * @brief Abstract interface for audio sources (WAV file, etc.)
+ *
+ * Delivers blocks of Config::BLOCK_SIZE samples.
  */
-class AudioSource {
+template <typename Config = dsp::DefaultConfig> class BasicAudioSource {
 public:
+  using Block = typename Config::Block;
   using AudioCallback = std::function<void(const Block &input, Block &output)>;
+  using LookaheadCallback = std::function<void(const Block &input)>;
 
-  virtual ~AudioSource() = default;
+  virtual ~BasicAudioSource() = default;
 
   /**
    * @brief Open the audio source with a callback
@@ -23,6 +27,17 @@ public:
    */
   virtual void open(AudioCallback callback) = 0;
 
+  /**
+   * @brief Announce input blocks ahead of their callback
+   *
+   * A source that knows its input in advance (a file) calls `lookahead` once
+   * per input block, in order, as soon as the block is available: for block
+   * k+1 before the callback for block k. Live sources cannot, and keep the
+   * default. Set after open() and before start() / processBlock().
+   * @return true if the source will call `lookahead`
+   */
+  virtual bool setLookahead(LookaheadCallback /*lookahead*/) { return false; }
+
   /**
    * @brief Start streaming audio
    */
@@ -38,6 +53,16 @@ public:
    */
   virtual void close() = 0;
 
+  /**
+   * @brief Offline (pull) mode: run one block through the callback on the
+   * calling thread
+   *
+   * For an open() source that has not been start()ed. No pacing, no extra
+   * threads, so blocks are produced as fast as the caller consumes them.
+   * @return false once the input is exhausted (no callback is made)
+   */
+  virtual bool processBlock() = 0;
+
   /**
    * @brief Check if source is running
    */
@@ -49,6 +74,8 @@ public:
   virtual int getSampleRate() const = 0;
 };
 
+using AudioSource = BasicAudioSource<>;
+
 /**
  * @brief Factory to create audio sources
  */
@@ -65,5 +92,8 @@ public:
     bool loop = false; // Loop WAV file when it ends
   };
 
-  static std::unique_ptr<AudioSource> create(const Config &config);
+  // Instantiated for the configurations in dsp::dispatchBlockSize()
+  template <typename DspConfig = dsp::DefaultConfig>
+  static std::unique_ptr<BasicAudioSource<DspConfig>>
+  create(const Config &config);
 };
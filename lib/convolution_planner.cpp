@@ -0,0 +1,106 @@
+#include "convolution_planner.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+std::string ConvolutionWisdom::cpuName() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int regs[12];
+  if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+    for (unsigned int leaf = 0; leaf < 3; ++leaf) {
+      __get_cpuid(0x80000002 + leaf, &regs[4 * leaf], &regs[4 * leaf + 1],
+                  &regs[4 * leaf + 2], &regs[4 * leaf + 3]);
+    }
+    char brand[sizeof(regs) + 1] = {};
+    std::memcpy(brand, regs, sizeof(regs));
+    std::string name(brand);
+    const auto first = name.find_first_not_of(' ');
+    const auto last = name.find_last_not_of(' ');
+    if (first != std::string::npos)
+      return name.substr(first, last - first + 1);
+  }
+#endif
+  return "unknown";
+}
+
+bool ConvolutionWisdom::load(const std::string &path) {
+  std::ifstream in(path);
+  if (!in)
+    return true;
+
+  // Parse the whole file before keeping any of it
+  std::map<Key, Entry> entries;
+  std::map<std::string, std::vector<std::string>> foreign;
+  std::string line;
+  std::string cpu;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    if (line.rfind("cpu ", 0) == 0) {
+      cpu = line.substr(4);
+      continue;
+    }
+    std::istringstream fields(line);
+    Key key;
+    std::string strategy;
+    Entry entry;
+    fields >> key.blockSize >> key.irSize >> key.taps >> key.fft >> strategy;
+    for (double &ns : entry.nsPerBlock)
+      fields >> ns;
+    if (!fields)
+      return false;
+    try {
+      entry.strategy = parseStrategy(strategy);
+    } catch (const std::invalid_argument &) {
+      return false;
+    }
+    if (cpu == cpu_)
+      entries[key] = entry;
+    else
+      foreign[cpu].push_back(line);
+  }
+
+  for (const auto &[key, entry] : entries)
+    entries_[key] = entry;
+  for (auto &[name, lines] : foreign)
+    foreign_[name] = std::move(lines);
+  return true;
+}
+
+bool ConvolutionWisdom::save(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+  out << "# convolution wisdom: block length taps fft strategy ns/block "
+         "(direct fft partitioned)\n";
+  out << "cpu " << cpu_ << "\n";
+  out << std::fixed << std::setprecision(1);
+  for (const auto &[key, entry] : entries_) {
+    out << key.blockSize << ' ' << key.irSize << ' ' << key.taps << ' '
+        << key.fft << ' ' << strategyName(entry.strategy);
+    for (double ns : entry.nsPerBlock)
+      out << ' ' << ns;
+    out << '\n';
+  }
+  // Other machines' measurements, as they were loaded
+  for (const auto &[name, lines] : foreign_) {
+    out << "cpu " << name << "\n";
+    for (const std::string &line : lines)
+      out << line << '\n';
+  }
+  return static_cast<bool>(out);
+}
+
+std::optional<ConvolutionWisdom::Entry>
+ConvolutionWisdom::lookup(const Key &key) const {
+  const auto it = entries_.find(key);
+  if (it == entries_.end())
+    return std::nullopt;
+  return it->second;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "utils/PathEngine.h"
+#include "utils/RealFFT.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <compare>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Measured choice of convolution strategy per path, persisted as "wisdom".
+//
+// For a path of a given length, block size and effective length (taps up to
+// the last nonzero one, i.e. how sparse its tail is), every strategy is
+// timed on this machine with the path's own response and the fastest one is
+// recorded. The wisdom file is plain text:
+//
+//   cpu <brand string>
+//   <block> <length> <taps> <fft backend> <strategy> <ns direct> <ns fft>
+//   <ns partitioned>
+//
+// (one entry per line). Entries measured on a different CPU are ignored, as
+// are timings from another FFT backend.
+class ConvolutionWisdom {
+public:
+  struct Key {
+    int blockSize = 0;
+    int irSize = 0;
+    int taps = 0; // effective length, rounded up to whole blocks
+    std::string fft;
+    auto operator<=>(const Key &) const = default;
+  };
+
+  struct Entry {
+    ConvolutionStrategy strategy = ConvolutionStrategy::Partitioned;
+    std::array<double, kConvolutionStrategies.size()> nsPerBlock{};
+  };
+
+  ConvolutionWisdom() : cpu_(cpuName()) {}
+
+  // Adds the entries of `path` recorded on this CPU, and keeps the other
+  // CPUs' lines for save(). A missing file is not an error (nothing learned
+  // yet); a malformed one adds nothing and returns false.
+  bool load(const std::string &path);
+  // Writes this CPU's entries followed by the other CPUs' loaded lines
+  bool save(const std::string &path) const;
+
+  std::optional<Entry> lookup(const Key &key) const;
+  void record(const Key &key, const Entry &entry) { entries_[key] = entry; }
+
+  size_t size() const { return entries_.size(); }
+  const std::string &cpu() const { return cpu_; }
+
+  // CPUID brand string ("unknown" where unavailable)
+  static std::string cpuName();
+
+private:
+  std::string cpu_;
+  std::map<Key, Entry> entries_;
+  // Lines recorded on other CPUs, by CPU name, passed through to save()
+  std::map<std::string, std::vector<std::string>> foreign_;
+};
+
+// When planPath() measures instead of trusting the wisdom
+enum class TuneMode {
+  Never,   // unknown paths get the default (Partitioned)
+  Missing, // measure paths the wisdom has no entry for
+  Always,  // re-measure every path
+};
+
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+ConvolutionWisdom::Key
+wisdomKey(const typename PathEngine<IR_SIZE, Config>::IRBlock &ir) {
+  constexpr int B = static_cast<int>(Config::BLOCK_SIZE);
+  const int taps = (effectiveLength(ir) + B - 1) / B * B;
+  return {B, IR_SIZE, taps, fft::backendName(fft::defaultBackend())};
+}
+
+// Per-block cost of every strategy for `ir` (best of a few runs of ~1 ms)
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+ConvolutionWisdom::Entry
+benchmarkPath(const typename PathEngine<IR_SIZE, Config>::IRBlock &ir) {
+  using Clock = std::chrono::steady_clock;
+  using Block = typename Config::Block;
+
+  ConvolutionWisdom::Entry entry;
+  const Block input = Block::Random();
+  Block output;
+  double best = 0.0;
+  for (size_t i = 0; i < kConvolutionStrategies.size(); ++i) {
+    auto engine = makePathEngine<IR_SIZE, Config>(kConvolutionStrategies[i]);
+    engine->setImpulseResponse(ir);
+
+    auto timeBlocks = [&](int blocks) {
+      const auto t0 = Clock::now();
+      for (int b = 0; b < blocks; ++b)
+        engine->step(input, output);
+      return std::chrono::duration<double, std::nano>(Clock::now() - t0)
+                 .count() /
+             blocks;
+    };
+    const double first = timeBlocks(4); // warm-up, and a scale for the runs
+    const int blocks = std::clamp(static_cast<int>(1e6 / first), 4, 2000);
+    double ns = first;
+    for (int rep = 0; rep < 3; ++rep)
+      ns = std::min(ns, timeBlocks(blocks));
+
+    entry.nsPerBlock[i] = ns;
+    if (i == 0 || ns < best) {
+      best = ns;
+      entry.strategy = kConvolutionStrategies[i];
+    }
+  }
+  return entry;
+}
+
+// Strategy for one path: the wisdom's, measured (and recorded) as `mode`
+// says, or Partitioned if unknown
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+ConvolutionStrategy
+planPath(const typename PathEngine<IR_SIZE, Config>::IRBlock &ir,
+         ConvolutionWisdom &wisdom, TuneMode mode) {
+  const ConvolutionWisdom::Key key = wisdomKey<IR_SIZE, Config>(ir);
+  if (mode != TuneMode::Always) {
+    if (auto known = wisdom.lookup(key))
+      return known->strategy;
+    if (mode == TuneMode::Never)
+      return ConvolutionStrategy::Partitioned;
+  }
+  const ConvolutionWisdom::Entry entry = benchmarkPath<IR_SIZE, Config>(ir);
+  wisdom.record(key, entry);
+  return entry.strategy;
+}
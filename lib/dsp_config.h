@@ -1,31 +1,108 @@
 #pragma once
 
+#include <bit>
 #include <cstddef>
+#include <stdexcept>
+#include <string>
 
 #include <Eigen/Dense>
 #include <unsupported/Eigen/FFT>
 
 namespace dsp {
 
-constexpr int SAMPLE_RATE = 48000;
+// Smallest power-of-two FFT that holds a block convolved with an IR without
+// circular wrap-around (linear convolution is BLOCK + IR - 1 samples long)
+constexpr size_t linearConvolutionFFTSize(size_t blockSize, size_t irSize) {
+  return std::bit_ceil(blockSize + irSize - 1);
+}
+
+// Compile-time DSP configuration. Every block-size dependent type (Block,
+// FastLinearSystem, IIRFilter, DSPInterface, ...) takes one of these, so
+// several configurations can live in one binary and every derived size (FFT,
+// context, latency) follows from the two sizes given here.
+template <size_t BlockSize, size_t IRSize, int SampleRate = 48000>
+struct Config {
+  static_assert(BlockSize > 0 && IRSize > 0);
+
+  static constexpr int SAMPLE_RATE = SampleRate;
+  static constexpr size_t BLOCK_SIZE = BlockSize;
+  static constexpr size_t IR_SIZE = IRSize;
+
+  // IIR filter state size (for biquad: 2)
+  static constexpr size_t IIR_STATE_SIZE = 2;
+
+  // Blocks spanned by one impulse response (at least one)
+  static constexpr size_t CONTEXT_BLOCKS =
+      IR_SIZE >= BLOCK_SIZE ? IR_SIZE / BLOCK_SIZE : 1;
+
+  static constexpr int BLOCK_LATENCY_US =
+      static_cast<int>((BLOCK_SIZE * 1'000'000) / SAMPLE_RATE);
+
+  // Single-transform overlap-save size for a full IR (FastLinearSystem)
+  static constexpr size_t FFT_SIZE =
+      linearConvolutionFFTSize(BLOCK_SIZE, IR_SIZE);
+
+  using Block = Eigen::Matrix<float, BLOCK_SIZE, 1>;
+  using IRBlock = Eigen::Matrix<float, IR_SIZE, 1>;
+};
+
+// 256 samples @ 48kHz = ~5.3ms per block, 1024-tap (~21ms) responses
+using DefaultConfig = Config<256, 1024>;
+// Low-latency test configurations (~0.7ms / ~1.3ms per block)
+using LowLatency32Config = Config<32, 1024>;
+using LowLatency64Config = Config<64, 1024>;
+// Offline throughput: fewer, larger blocks
+using Offline1024Config = Config<1024, 1024>;
+
+// Applies X(Config) to every compiled-in configuration; the library's
+// translation units use it for their explicit instantiations. Keep in step
+// with dispatchBlockSize() below.
+#define DSP_FOR_EACH_CONFIG(X)                                                 \
+  X(dsp::LowLatency32Config)                                                   \
+  X(dsp::LowLatency64Config)                                                   \
+  X(dsp::DefaultConfig)                                                        \
+  X(dsp::Offline1024Config)
+
+// Runtime selection of a compiled-in configuration: calls fn(Config{}) with
+// the configuration whose block size is `blockSize` and returns its result.
+// Throws std::invalid_argument for any other block size.
+template <typename Fn>
+decltype(auto) dispatchBlockSize(size_t blockSize, Fn &&fn) {
+  switch (blockSize) {
+  case LowLatency32Config::BLOCK_SIZE:
+    return fn(LowLatency32Config{});
+  case LowLatency64Config::BLOCK_SIZE:
+    return fn(LowLatency64Config{});
+  case DefaultConfig::BLOCK_SIZE:
+    return fn(DefaultConfig{});
+  case Offline1024Config::BLOCK_SIZE:
+    return fn(Offline1024Config{});
+  }
+  throw std::invalid_argument("unsupported block size " +
+                              std::to_string(blockSize) +
+                              " (supported: 32, 64, 256, 1024)");
+}
+
+// The default configuration under the names used throughout the code
+constexpr int SAMPLE_RATE = DefaultConfig::SAMPLE_RATE;
 
 // Block size: 256 samples @ 48kHz = ~5.3ms latency per block
-constexpr size_t BLOCK_SIZE = 256;
+constexpr size_t BLOCK_SIZE = DefaultConfig::BLOCK_SIZE;
 
 // Impulse response size for convolution (1024 @ 48kHz = ~21ms)
-constexpr size_t IR_SIZE = 1024;
+constexpr size_t IR_SIZE = DefaultConfig::IR_SIZE;
 
 // IIR filter state size (for biquad: 2)
-constexpr size_t IIR_STATE_SIZE = 2;
+constexpr size_t IIR_STATE_SIZE = DefaultConfig::IIR_STATE_SIZE;
 
 // Number of blocks to buffer for latency compensation
-constexpr size_t CONTEXT_BLOCKS = IR_SIZE / BLOCK_SIZE; // 4 blocks for 1024-sample IR
+// 4 blocks for 1024-sample IR
+constexpr size_t CONTEXT_BLOCKS = DefaultConfig::CONTEXT_BLOCKS;
 
 // constexpr float BLOCK_LATENCY_MS =
 //     ((BLOCK_SIZE * 1000.0f) / static_cast<float>(SAMPLE_RATE)); // ~5ms
 
-constexpr int BLOCK_LATENCY_US =
-    (BLOCK_SIZE * 1'000'000) / SAMPLE_RATE; // ~5333us
+constexpr int BLOCK_LATENCY_US = DefaultConfig::BLOCK_LATENCY_US; // ~5333us
 
 
 } // namespace dsp
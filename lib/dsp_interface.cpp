@@ -1,241 +1,590 @@
 #include "dsp_interface.h"
 
-DSPInterface::DSPInterface(Params &params, int systemLatencyBlocks)
-    : params_(params), systemLatencyBlocks_(systemLatencyBlocks) {
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+template <typename Params> uint64_t resolveSeed(const Params &params) {
+  if (params.seed)
+    return *params.seed;
+  if (params.mode == RunMode::Offline)
+    return 0;
+  std::random_device rd;
+  return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+} // namespace
+
+template <typename Config>
+Topology BasicDSPInterface<Config>::checkTopology_(const Params &params) {
+  const Topology t = params.paths.topology();
+  if (t.referenceMics < 1 || t.referenceMics > MAX_REFERENCE_MICS ||
+      t.errorMics < 1 || t.errorMics > MAX_ERROR_MICS || t.speakers < 1 ||
+      t.speakers > MAX_SPEAKERS)
+    throw std::invalid_argument("Unsupported plant topology");
+  const auto &C = params.paths.C;
+  const auto &S = params.state.S;
+  if (params.paths.H.cols() != 1 || params.paths.P.cols() != 1 ||
+      C.rows() != t.referenceMics || C.cols() != t.speakers ||
+      S.rows() != t.errorMics || S.cols() != t.speakers)
+    throw std::invalid_argument(
+        "Plant path matrices do not match one topology");
+  return t;
+}
+
+template <typename Config>
+BasicDSPInterface<Config>::BasicDSPInterface(Params &params,
+                                             int systemLatencyBlocks)
+    : topology_(checkTopology_(params)),
+      systemLatencyBlocks_(clampLatency_(systemLatencyBlocks)),
+      controlLine_(Control::Zero(Config::BLOCK_SIZE, topology_.speakers),
+                   params.timing.hold_last_control),
+      params_(params), noisePaths_(1, topology_.mics()),
+      speakerPaths_(topology_.speakers, topology_.mics()),
+      offline_(params.mode == RunMode::Offline), S_base_(params.state.S),
+      drift_(topology_.errorMics, topology_.speakers),
+      driftFilters_(static_cast<size_t>(topology_.errorMics) *
+                        topology_.speakers,
+                    params.state.S_dynamics_ng) {
+
+  checkToleranceDb(params.convolution.irToleranceDb);
+
+  const uint64_t seed = resolveSeed(params);
+  noiseRng_ = Philox4x32(seed, kNoiseStream);
+  dynamicsRng_ = Philox4x32(seed, kDynamicsStream);
+
+  ConvolutionWisdom wisdom;
+  const std::string &wisdomFile = params.convolution.wisdomFile;
+  if (!wisdomFile.empty() && !wisdom.load(wisdomFile))
+    std::cerr << "Ignoring malformed wisdom file " << wisdomFile << std::endl;
+  plan_ = planPaths(params, wisdom,
+                    params.convolution.tune ? TuneMode::Missing
+                                            : TuneMode::Never);
+  if (params.convolution.tune && !wisdomFile.empty())
+    wisdom.save(wisdomFile);
+
+  const int mics = topology_.mics();
+  const int speakers = topology_.speakers;
+  noiseEngines_.resize(mics);
+  speakerEngines_.resize(static_cast<size_t>(mics) * speakers);
+  noiseShared_ = speakerShared_ = false;
+  for (int m = 0; m < mics; ++m) {
+    if (plan_[noiseClass_(m)] != ConvolutionStrategy::Partitioned)
+      noiseEngines_[m] = makePathEngine<IR_SIZE, Config>(plan_[noiseClass_(m)]);
+    else
+      noiseShared_ = true;
+    for (int l = 0; l < speakers; ++l) {
+      if (plan_[speakerClass_(m)] != ConvolutionStrategy::Partitioned)
+        speakerEngines_[m * speakers + l] =
+            makePathEngine<SPEAKER_PATH_SIZE, Config>(plan_[speakerClass_(m)]);
+      else
+        speakerShared_ = true;
+    }
+  }
 
-  H_system_.setImpulseResponse(params.paths.H);
-  P_system_.setImpulseResponse(params.paths.P);
-  C_system_.setImpulseResponse(params.paths.C);
-  speakerSystem_.setImpulseResponse(params.paths.speaker);
-  S_system_.setImpulseResponse(params.state.S);
+  const int R = topology_.referenceMics;
+  for (int m = 0; m < mics; ++m) {
+    const IRBlock ir = trimmed_(
+        m < R ? params.paths.H(m, 0) : params.paths.P(m - R, 0), params);
+    if (noiseEngines_[m])
+      noiseEngines_[m]->setImpulseResponse(ir);
+    else
+      noisePaths_.setImpulseResponse(m, 0, ir);
+  }
+  speakerComposers_.resize(speakers);
+  foldedRow_.assign(speakers, SpeakerPath::Zero(SPEAKER_PATH_SIZE));
+  for (int l = 0; l < speakers; ++l)
+    speakerComposers_[l].setFirst(params.paths.speaker[l]);
+  std::vector<const IRBlock *> row(speakers);
+  for (int m = 0; m < mics; ++m) {
+    for (int l = 0; l < speakers; ++l)
+      row[l] = m < R ? &params.paths.C(m, l) : &params.state.S(m - R, l);
+    setSpeakerPaths_(m, row);
+  }
 
   LPButterworthCoeff noiseFcLpf(params_.noise.fc_lpf_hz,
-                                static_cast<float>(dsp::SAMPLE_RATE));
+                                static_cast<float>(Config::SAMPLE_RATE));
   params_.noise.noise_color_filter.setCoefficients(
       noiseFcLpf.getCoefficients());
 
-  // Initialize control ring buffer with systemLatencyBlocks_ elements
-  controlBuf.resize(systemLatencyBlocks_);
-  for (int i = 0; i < systemLatencyBlocks_; ++i) {
-    controlBuf[i] = Block::Zero();
-  }
-  controlBufIndex_ = 0;
+  MicHandle initial = micPool_.acquire();
+  initial->outside.setZero(Config::BLOCK_SIZE, topology_.referenceMics);
+  initial->inear.setZero(Config::BLOCK_SIZE, topology_.errorMics);
+  inputBuf.publish(std::move(initial));
 
-  inputBuf.publish(MicBlock{Block::Zero(), Block::Zero()});
+  // Noise generators are fully set up: start rendering ahead. Offline runs
+  // consume on one thread, so they render the noise in place instead.
+  if (!offline_) {
+    micNoise_.start();
+    driftNoise_.start();
+  }
 
   // Create audio source
-  audioSource_ = AudioSourceFactory::create(params.audioConfig);
+  audioSource_ = AudioSourceFactory::create<Config>(params.audioConfig);
 
   audioSource_->open([this](const Block &input, Block &output) {
     audioCallback_(input, output);
   });
+  // Offline runs stay on one thread: the noise paths run inline
+  if (params.plant_lookahead && !offline_)
+    lookahead_ = audioSource_->setLookahead(
+        [this](const Block &input) { onLookahead_(input); });
+
+  // Offline runs are driven entirely by runOffline()
+  if (offline_)
+    return;
+
+  kernelThread_ =
+      std::jthread([this](std::stop_token st) { kernelThreadLoop_(st); });
+
   audioSource_->start();
 
   // ANC processing thread
   dspThread_ = std::jthread([this](std::stop_token st) { dspThreadLoop_(st); });
 }
-DSPInterface::~DSPInterface() {
+template <typename Config> BasicDSPInterface<Config>::~BasicDSPInterface() {
   // Stop audio source first
   if (audioSource_) {
     audioSource_->stop();
     audioSource_->close();
   }
 
-  if (dspThread_.joinable())
+  // The DSP thread polls audioSource_, which is destroyed before it
+  if (dspThread_.joinable()) {
     dspThread_.request_stop();
+    micQueue_.wake();
+    dspThread_.join();
+  }
 
-  mic_cv_.notify_all();
+  // The kernel thread updates drift_ from driftNoise_, which are declared
+  // after it and so destroyed before it
+  if (kernelThread_.joinable()) {
+    kernelThread_.request_stop();
+    kernelThread_.join();
+  }
 }
 
-void DSPInterface::audioCallback_(const Block &input, Block &output) {
-  // read command signal U from the ring buffer (delayed by
-  // systemLatencyBlocks_)
-  Block u = Block::Zero();
-  {
-    std::lock_guard<std::mutex> lk(controlBuf_mutex_);
-    u = controlBuf[controlBufIndex_];
-  }
+template <typename Config>
+void BasicDSPInterface<Config>::audioCallback_(const Block &input,
+                                               Block &output) {
+  // Written once, here; consumers get handles to the same slot
+  MicHandle slot = micPool_.acquire();
+  MicBlock &mb = slot ? *slot : scratchMic_;
+  mb.timestamp = Clock::now();
+  mb.seq = mic_seq_.fetch_add(1, std::memory_order_relaxed) + 1;
 
-  // simulate ambientNoise
-  const Block ambientNoise = input + generateMicNoiseBlock_();
+  // read command signal U from the delay line (the control computed from
+  // the mic block systemLatencyBlocks_ ago)
+  Control u;
+  mb.control = readControl_(mb.seq, u);
 
-  // update S using a slowly drifting secondary path
-  updateDynamicsS_();
+  // update S using a slowly drifting secondary path (off this thread)
+  if (!offline_) {
+    kernelTicks_.fetch_add(1, std::memory_order_release);
+    kernelTicks_.notify_one();
+  }
 
   // Propagate full plant with previous u and current noise
-  //    outside = H*n + C*speaker(u)
-  //    inear   = P*n + S*speaker(u)
-  MicBlock mb;
-  mb.timestamp = Clock::now();
-  mb.seq = mic_seq_.fetch_add(1, std::memory_order_relaxed) + 1;
-  {
-    std::lock_guard<std::mutex> lk(paths_mutex_);
-    propagatePlant_(u, ambientNoise, mb);
+  //    outside_r = H_r*n + sum_l C_rl*speaker_l(u_l)
+  //    inear_e   = P_e*n + sum_l S_el*speaker_l(u_l)
+  if (lookahead_) {
+    // H*n and P*n were started when this block was announced
+    propagateSpeaker_(u, noiseStage_.wait(), mb);
+    noiseStage_.release();
+  } else {
+    // simulate ambientNoise (rendered ahead by the noise thread; silent for
+    // a block it has not rendered in time)
+    Block ambientNoise;
+    if (!micNoise_.pop(ambientNoise))
+      ambientNoise.setZero();
+    ambientNoise += input;
+    propagateNoise_(ambientNoise, serialNoise_);
+    propagateSpeaker_(u, serialNoise_, mb);
   }
 
-  // the output is the inear mic. This is what the user hears and what we cares
-  // about
-  output = mb.inear;
+  // the output is the (first) inear mic. This is what the user hears and what
+  // we cares about
+  output = mb.inear.col(0);
 
   // Update noise profile statistics
-  lastOutside_ = mb.outside;
-  lastInear_ = mb.inear;
-  updateNoiseProfile_();
+  updateNoiseProfile_(mb);
 
   // publishMics to the inputBuf
-  inputBuf.publish(mb);
+  if (slot)
+    inputBuf.publish(slot);
+
+  if (lastCallbackStart_ != Clock::time_point{})
+    telemetry_.callbackInterval.record(mb.timestamp - lastCallbackStart_);
+  lastCallbackStart_ = mb.timestamp;
+
+  if (offline_) {
+    // runOffline() processes it before the next block. The offline loop
+    // never holds more than this block, so the pool cannot run dry.
+    offlineMic_ = std::move(slot);
+    telemetry_.callback.record(Clock::now() - mb.timestamp);
+    return;
+  }
+
+  // enque dspthread for the next processing step (dropped and counted if
+  // the DSP thread is a full queue behind)
+  mb.queued = Clock::now();
+  if (slot)
+    micQueue_.push(std::move(slot));
+  telemetry_.callback.record(Clock::now() - mb.timestamp);
+}
 
-  // enque dspthread for the next processing step
-  {
-    std::lock_guard<std::mutex> lk(mic_mutex_);
-    micQueue_.push_back(mb);
+template <typename Config>
+void BasicDSPInterface<Config>::kernelThreadLoop_(std::stop_token st) {
+  std::stop_callback wake(st, [this] {
+    kernelTicks_.fetch_add(1, std::memory_order_release);
+    kernelTicks_.notify_one();
+  });
+
+  uint32_t seen = kernelTicks_.load(std::memory_order_acquire);
+  while (!st.stop_requested()) {
+    kernelTicks_.wait(seen, std::memory_order_acquire);
+    if (st.stop_requested())
+      return;
+    seen = kernelTicks_.load(std::memory_order_acquire);
+
+    updateDynamicsS_();
   }
-  mic_cv_.notify_all();
 }
 
-void DSPInterface::dspThreadLoop_(std::stop_token st) {
-  Block control = Block::Zero();
+template <typename Config>
+void BasicDSPInterface<Config>::dspThreadLoop_(std::stop_token st) {
+  // A running source delivers a block every period; going two periods
+  // without one means the producer stalled
+  constexpr auto stallTimeout =
+      std::chrono::microseconds(2 * Config::BLOCK_LATENCY_US);
+
+  Control control = Control::Zero(Config::BLOCK_SIZE, topology_.speakers);
+  MicHandle mb;
   while (!st.stop_requested()) {
-    MicBlock mb;
-    {
-      std::unique_lock<std::mutex> lk(mic_mutex_);
-      mic_cv_.wait(lk, [&] {
-        return st.stop_requested() || micQueue_.front() != nullptr;
-      });
-
-      if (st.stop_requested())
-        return;
-
-      const MicBlock *p = micQueue_.front();
-      if (!p)
-        continue;
-      mb = *p;
-      micQueue_.pop_front();
+    if (!micQueue_.tryPop(mb)) {
+      if (!micQueue_.waitFor(stallTimeout) && !st.stop_requested() &&
+          isAudioSourceRunning())
+        micUnderruns_.fetch_add(1, std::memory_order_relaxed);
+      continue;
     }
 
-    control = callProcessMicsWithTimeout_(mb, dsp::BLOCK_LATENCY_US);
+    telemetry_.queueWait.record(Clock::now() - mb->queued);
 
-    // Publish speaker command to ring buffer
-    {
-      std::lock_guard<std::mutex> lk(controlBuf_mutex_);
-      controlBuf[controlBufIndex_] = control;
-      controlBufIndex_ = (controlBufIndex_ + 1) % systemLatencyBlocks_;
+    // Publish speaker command to the delay line. A missed deadline
+    // publishes nothing, and the callback substitutes and reports it.
+    if (callProcessMicsWithTimeout_(mb, Config::BLOCK_LATENCY_US, control)) {
+      controlLine_.write(mb->seq, control);
+      telemetry_.loop.record(Clock::now() - mb->timestamp);
     }
+    mb.reset(); // an abandoned processMics call keeps its own handle
   }
 }
 
-void DSPInterface::setProcessMics(ProcessMicsFn fn) {
+template <typename Config>
+size_t BasicDSPInterface<Config>::runOffline(size_t maxBlocks) {
+  if (!offline_)
+    throw std::logic_error("runOffline() requires RunMode::Offline");
+
+  size_t blocks = 0;
+  Control control;
+  while (blocks < maxBlocks && audioSource_->processBlock()) {
+    ++blocks;
+
+    const MicBlock &mb = offlineMic_ ? *offlineMic_ : scratchMic_;
+    runProcessMics_(mb, control);
+    controlLine_.write(mb.seq, control);
+    telemetry_.loop.record(Clock::now() - mb.timestamp);
+
+    // The next block sees the S drifted by this one, as the kernel thread
+    // would deliver it in real time when it keeps up
+    updateDynamicsS_();
+  }
+  return blocks;
+}
+
+template <typename Config>
+void BasicDSPInterface<Config>::runProcessMics_(const MicBlock &mb,
+                                                Control &control) {
+  control.setZero(Config::BLOCK_SIZE, topology_.speakers);
+  std::lock_guard<std::mutex> lk(process_mutex_);
+  if (!processMics_)
+    return;
+  const auto start = Clock::now();
+  processMics_(mb, control);
+  telemetry_.processMics.record(Clock::now() - start);
+}
+
+template <typename Config>
+void BasicDSPInterface<Config>::setProcessMics(ProcessMicsFn fn) {
   std::lock_guard<std::mutex> lk(process_mutex_);
   processMics_ = std::move(fn);
 }
 
-std::optional<MicBlock> DSPInterface::getMics() {
-  MicBlock mb;
-  if (inputBuf.tryRead(mb)) {
-    return mb;
+template <typename Config>
+void BasicDSPInterface<Config>::setProcessMics(ProcessMicsBlockFn fn) {
+  if (!fn) {
+    setProcessMics(ProcessMicsFn{});
+    return;
+  }
+  setProcessMics(ProcessMicsFn(
+      [fn = std::move(fn), u = Block()](const MicBlock &mb,
+                                        Control &control) mutable {
+        u.setZero();
+        fn(mb, u);
+        control.col(0) = u;
+      }));
+}
+
+template <typename Config>
+auto BasicDSPInterface<Config>::getMics() -> std::optional<MicBlock> {
+  if (const MicHandle *mb = inputBuf.acquire()) {
+    return **mb;
   }
   return std::nullopt;
 }
-void DSPInterface::sendControl(const Block &control) {
-  std::lock_guard<std::mutex> lk(controlBuf_mutex_);
-  controlBuf[controlBufIndex_] = control;
-  controlBufIndex_ = (controlBufIndex_ + 1) % systemLatencyBlocks_;
+
+template <typename Config>
+auto BasicDSPInterface<Config>::getMicHandle() -> MicHandle {
+  const MicHandle *mb = inputBuf.acquire();
+  return mb ? *mb : MicHandle{};
 }
-void DSPInterface::step_() {}
-void DSPInterface::updateNoiseProfile_() {
-  auto &noise = params_.noise;
-  noise.outside_mic_stddev = computeStddev_(lastOutside_);
-  noise.inear_mic_stddev = computeStddev_(lastInear_);
+template <typename Config>
+void BasicDSPInterface<Config>::sendControl(const Control &control) {
+  assert(control.cols() == topology_.speakers);
+  controlLine_.write(mic_seq_.load(std::memory_order_acquire), control);
 }
 
-void DSPInterface::updateDynamicsS_() {
-  auto &state = params_.state;
-  auto &dyn = params_.dynamics;
-
-  static bool initialized = false;
-  static IRBlock S_true = state.S_true;
+template <typename Config>
+void BasicDSPInterface<Config>::sendControl(const Block &control) {
+  Control u = Control::Zero(Config::BLOCK_SIZE, topology_.speakers);
+  u.col(0) = control;
+  sendControl(u);
+}
 
-  if (!initialized) {
-    S_true = state.S;
-    initialized = true;
+template <typename Config>
+ControlStatus BasicDSPInterface<Config>::readControl_(uint64_t seq,
+                                                      Control &u) {
+  const uint64_t latency = static_cast<uint64_t>(
+      systemLatencyBlocks_.load(std::memory_order_relaxed));
+  if (seq <= latency) {
+    // No control can exist yet for the first blocks
+    u.setZero(Config::BLOCK_SIZE, topology_.speakers);
+    return ControlStatus::Fresh;
   }
 
-  // Generate filtered white noise for the entire IR
-  IRBlock w_lp;
-  constexpr int num_blocks = dsp::IR_SIZE / dsp::BLOCK_SIZE;
-  for (int i = 0; i < num_blocks; ++i) {
-    Block w_block = Block::Random();
-    Block w_lp_block = state.S_dynamics_ng.filterBlock(w_block);
-    w_lp.segment<dsp::BLOCK_SIZE>(i * dsp::BLOCK_SIZE) = w_lp_block;
+  const ControlStatus status = controlLine_.read(seq - latency, u);
+  switch (status) {
+  case ControlStatus::Fresh:
+    controlFresh_.fetch_add(1, std::memory_order_relaxed);
+    break;
+  case ControlStatus::Stale:
+    controlStale_.fetch_add(1, std::memory_order_relaxed);
+    break;
+  case ControlStatus::Zero:
+    controlZero_.fetch_add(1, std::memory_order_relaxed);
+    break;
   }
+  return status;
+}
+template <typename Config> void BasicDSPInterface<Config>::step_() {}
 
-  IRBlock S_new = S_true + dyn.noise_gain * w_lp;
+template <typename Config>
+void BasicDSPInterface<Config>::updateNoiseProfile_(const MicBlock &mb) {
+  auto &noise = params_.noise;
+  noise.outside_mic_stddev = computeStddev_(mb.outside);
+  noise.inear_mic_stddev = computeStddev_(mb.inear);
+}
 
-  // renormalize
-  const float eps = 1e-12f;
-  const float n0 = std::sqrt(S_true.squaredNorm());
-  const float n1 = std::sqrt(S_new.squaredNorm());
-  if (n0 > eps && n1 > eps) {
-    S_new *= (n0 / n1);
+template <typename Config>
+void BasicDSPInterface<Config>::renderDriftNoise_(PathMatrix &w_lp) {
+  const int E = topology_.errorMics;
+  const int L = topology_.speakers;
+  if (w_lp.rows() != E || w_lp.cols() != L)
+    w_lp.resize(E, L);
+
+  // Generate filtered white noise for the entire IR of every entry of S, in
+  // row-major order from one stream
+  IRBlock w;
+  constexpr int B = static_cast<int>(Config::BLOCK_SIZE);
+  constexpr int num_blocks = static_cast<int>(Config::IR_SIZE) / B;
+  for (int e = 0; e < E; ++e) {
+    for (int l = 0; l < L; ++l) {
+      auto &filter = driftFilters_[e * L + l];
+      dynamicsRng_.fillUniform(w, -1.0f, 1.0f);
+      for (int i = 0; i < num_blocks; ++i) {
+        const Block w_block = w.template segment<B>(i * B);
+        w_lp(e, l).template segment<B>(i * B) = filter.filterBlock(w_block);
+      }
+    }
   }
+}
 
-  // clip
-  constexpr float clip = 1.0f;
-  for (int i = 0; i < S_new.size(); ++i) {
-    if (S_new(i) > clip)
-      S_new(i) = clip;
-    if (S_new(i) < -clip)
-      S_new(i) = -clip;
-  }
+template <typename Config>
+void BasicDSPInterface<Config>::updateDynamicsS_() {
+  auto &state = params_.state;
+  auto &dyn = params_.dynamics;
+
+  // On an underrun drift_ keeps the previous update's drift
+  driftNoise_.pop(drift_);
+
+  const int R = topology_.referenceMics;
+  const int L = topology_.speakers;
+  for (int e = 0; e < topology_.errorMics; ++e) {
+    for (int l = 0; l < L; ++l) {
+      const IRBlock &S_true = S_base_(e, l);
+      IRBlock S_new = S_true + dyn.noise_gain * drift_(e, l);
+
+      // renormalize
+      const float eps = 1e-12f;
+      const float n0 = std::sqrt(S_true.squaredNorm());
+      const float n1 = std::sqrt(S_new.squaredNorm());
+      if (n0 > eps && n1 > eps) {
+        S_new *= (n0 / n1);
+      }
+
+      // clip
+      constexpr float clip = 1.0f;
+      for (int i = 0; i < S_new.size(); ++i) {
+        if (S_new(i) > clip)
+          S_new(i) = clip;
+        if (S_new(i) < -clip)
+          S_new(i) = -clip;
+      }
+
+      state.S(e, l) = S_new;
+      speakerComposers_[l].compose(state.S(e, l), foldedRow_[l]);
+      foldedRow_[l] = trimmed_(foldedRow_[l], params_);
+    }
 
-  state.S = S_new;
-  {
-    std::lock_guard<std::mutex> lk(paths_mutex_);
-    S_system_.setImpulseResponse(state.S);
+    // Picked up by the audio thread at its next block
+    const int m = R + e;
+    if (speakerEngine_(m, 0)) {
+      for (int l = 0; l < L; ++l)
+        speakerEngine_(m, l)->prepareImpulseResponse(foldedRow_[l]);
+    } else {
+      speakerPaths_.prepareImpulseResponses(m, foldedRow_);
+    }
   }
 }
 
-void DSPInterface::propagatePlant_(const Block &u, const Block &n,
-                                   MicBlock &mb) {
-  // Speaker coloration
-  speakerSystem_.step(u, u_spk_);
+template <typename Config>
+void BasicDSPInterface<Config>::onLookahead_(const Block &input) {
+  // simulate ambientNoise (rendered ahead by the noise thread) and start its
+  // paths while the callback for the current block runs
+  Block ambientNoise;
+  if (!micNoise_.pop(ambientNoise))
+    ambientNoise.setZero(); // not rendered in time: a counted dropout
+  ambientNoise += input;
+  noiseStage_.submit(ambientNoise);
+}
 
-  // Speaker -> outside mic (C path) and speaker -> in-ear mic (S path)
-  C_system_.step(u_spk_, yC_);
-  S_system_.step(u_spk_, yS_);
+template <typename Config>
+void BasicDSPInterface<Config>::propagateNoise_(const Block &n,
+                                                NoiseSpectra &out) {
+  // One forward FFT for the noise input. H and P are fixed, so there is no
+  // kernel crossfade on this side.
+  if (noiseShared_)
+    noisePaths_.push(n);
+  for (int m = 0; m < topology_.mics(); ++m) {
+    out.mic[m].setZero();
+    if (noiseEngines_[m])
+      noiseEngines_[m]->step(n, out.direct[m]);
+    else
+      noisePaths_.accumulate(m, out.mic[m]);
+  }
+}
 
-  // Noise -> outside mic (H path) and noise -> in-ear mic (P path)
-  H_system_.step(n, yH_);
-  P_system_.step(n, yP_);
+template <typename Config>
+void BasicDSPInterface<Config>::propagateSpeaker_(const Control &u,
+                                                  const NoiseSpectra &noise,
+                                                  MicBlock &mb) {
+  // Speaker coloration is folded into the C and S kernels, and all speakers
+  // are transformed in one batched FFT. A freshly prepared row of S is
+  // crossfaded in by the sums.
+  if (speakerShared_)
+    speakerPaths_.push(u);
+
+  mb.outside.resize(Config::BLOCK_SIZE, topology_.referenceMics);
+  mb.inear.resize(Config::BLOCK_SIZE, topology_.errorMics);
+  for (int m = 0; m < topology_.mics(); ++m) {
+    // outside_r = H_r*n + sum_l C_rl*speaker_l(u_l), inear_e likewise with
+    // P and S
+    auto &sum = micSums_[m];
+    sum.clear(noise.mic[m]);
+    if (!speakerEngine_(m, 0))
+      speakerPaths_.accumulate(m, sum);
+    sum.finish(micOut_);
+    if (noiseEngines_[m])
+      micOut_ += noise.direct[m];
+    if (speakerEngine_(m, 0)) {
+      for (int l = 0; l < topology_.speakers; ++l) {
+        speakerEngine_(m, l)->step(u.col(l), speakerDirect_);
+        micOut_ += speakerDirect_;
+      }
+    }
+    storeMic_(mb, m);
+  }
+}
 
-  // outside_mic = H*n + C*speaker(u)
-  mb.outside = yH_;
-  mb.outside += yC_;
+template <typename Config>
+void BasicDSPInterface<Config>::setSpeakerPaths_(
+    int m, const std::vector<const IRBlock *> &irs) {
+  for (int l = 0; l < topology_.speakers; ++l) {
+    speakerComposers_[l].compose(*irs[l], foldedRow_[l]);
+    foldedRow_[l] = trimmed_(foldedRow_[l], params_);
+    if (speakerEngine_(m, l))
+      speakerEngine_(m, l)->setImpulseResponse(foldedRow_[l]);
+    else
+      speakerPaths_.setImpulseResponse(m, l, foldedRow_[l]);
+  }
+}
 
-  // inear_mic = P*n + S*speaker(u)
-  mb.inear = yP_;
-  mb.inear += yS_;
+template <typename Config>
+PathPlan BasicDSPInterface<Config>::planPaths(const Params &params,
+                                              ConvolutionWisdom &wisdom,
+                                              TuneMode mode) {
+  // Every path of a class runs with one strategy, planned on the class's
+  // first path (mic 0, speaker 0). C and S run with the speaker folded in,
+  // so plan the folded kernels.
+  SpeakerComposer composer;
+  composer.setFirst(params.paths.speaker[0]);
+  PathPlan plan;
+  plan[kPathH] = planPath<IR_SIZE, Config>(
+      trimmed_(params.paths.H(0, 0), params), wisdom, mode);
+  plan[kPathP] = planPath<IR_SIZE, Config>(
+      trimmed_(params.paths.P(0, 0), params), wisdom, mode);
+  plan[kPathC] = planPath<SPEAKER_PATH_SIZE, Config>(
+      trimmed_(composer.compose(params.paths.C(0, 0)), params), wisdom, mode);
+  // The drift noise (DynamicsParams) covers every tap of S, so once running
+  // S spans the whole path however short it starts: plan it at that length
+  IRBlock S = params.state.S(0, 0);
+  if (params.dynamics.noise_gain != 0.0f)
+    S.array() += params.dynamics.noise_gain;
+  plan[kPathS] =
+      planPath<SPEAKER_PATH_SIZE, Config>(
+          trimmed_(composer.compose(S), params), wisdom, mode);
+  return plan;
 }
 
-Block DSPInterface::generateMicNoiseBlock_() {
-  Block fcRandom = Block::Zero();
+template <typename Config>
+void BasicDSPInterface<Config>::renderMicNoise_(Block &noise) {
   const float fcMean = params_.noise.fc_mean_hz;
   const float sigmaFc = std::max(1e-6f, params_.noise.sigma_fc_hz);
 
-  std::normal_distribution<float> fcDist(fcMean, sigmaFc);
-  for (int i = 0; i < dsp::BLOCK_SIZE; ++i) {
-    fcRandom(i) = std::abs(fcDist(noiseRng_));
-  }
+  Block fcRandom;
+  noiseRng_.fillNormal(fcRandom, fcMean, sigmaFc);
+  fcRandom = fcRandom.cwiseAbs();
 
   Block fcLowPassed = params_.noise.noise_color_filter.filterBlock(fcRandom);
   Block fcForNoise = fcLowPassed.cwiseAbs();
 
-  Block noise = Block::Zero();
+  // Per-sample mean fcForNoise(i): one standard normal block, shifted
   const float sampleSigma = std::max(1e-6f, params_.noise.sample_sigma);
-  for (int i = 0; i < dsp::BLOCK_SIZE; ++i) {
-    std::normal_distribution<float> nDist(fcForNoise(i), sampleSigma);
-    noise(i) = nDist(noiseRng_);
-  }
+  noiseRng_.fillNormal(noise, 0.0f, sampleSigma);
+  noise += fcForNoise;
 
   // Normalize to audio range: zero-mean, then scale so peak ≈ sample_sigma
   const float mean = noise.mean();
@@ -244,36 +593,64 @@ Block DSPInterface::generateMicNoiseBlock_() {
   if (peak > 1e-12f) {
     noise *= (sampleSigma / peak);
   }
-
-  return noise;
 }
 
-float DSPInterface::computeStddev_(const Block &b) const {
+template <typename Config>
+template <typename Derived>
+float BasicDSPInterface<Config>::computeStddev_(
+    const Eigen::MatrixBase<Derived> &b) {
   const float mean = b.mean();
   const float var = (b.array() - mean).square().mean();
   return std::sqrt(var);
 }
 
-Block DSPInterface::callProcessMicsWithTimeout_(const MicBlock &mb,
-                                                int timeoutUs) {
-  Block result = Block::Zero();
-
-  ProcessMicsFn fn;
-  {
-    std::lock_guard<std::mutex> lk(process_mutex_);
-    fn = processMics_;
-  }
-
-  if (!fn)
-    return result;
-
-  auto task = std::async(std::launch::async, [&]() { fn(mb, result); });
+template <typename Config>
+bool BasicDSPInterface<Config>::callProcessMicsWithTimeout_(
+    const MicHandle &mb, int timeoutUs, Control &control) {
+  // The budget runs from the moment the block was captured, so time spent
+  // queued for this thread counts against it
+  if (!processWorker_.submit(mb))
+    return false; // previous call overran and is still running
+
+  // Misses are counted by the worker (see getProcessStats)
+  const auto deadline = mb->timestamp + std::chrono::microseconds(timeoutUs);
+  return processWorker_.waitUntil(deadline, control);
+}
 
-  auto deadline = std::chrono::microseconds(timeoutUs);
-  if (task.wait_for(deadline) == std::future_status::timeout) {
-    std::cerr << "ProcessMics timeout after " << timeoutUs << " us\n";
-    result = Block::Zero();
+template <typename Config>
+void BasicDSPInterface<Config>::writeTelemetryJson(std::ostream &os) const {
+  const auto q = getMicQueueStats();
+  const auto c = getControlStats();
+  const auto d = getProcessStats();
+  const auto n = getNoiseStats();
+  const uint64_t blocks = mic_seq_.load(std::memory_order_relaxed);
+
+  os << "{\n  \"blocks\": " << blocks << ",\n  \"latency\": {";
+  const std::pair<const char *, const LatencyHistogram *> histograms[] = {
+      {"callback", &telemetry_.callback},
+      {"callback_interval", &telemetry_.callbackInterval},
+      {"queue_wait", &telemetry_.queueWait},
+      {"process_mics", &telemetry_.processMics},
+      {"loop", &telemetry_.loop},
+  };
+  for (size_t i = 0; i < std::size(histograms); ++i) {
+    os << (i ? ",\n" : "\n") << "    \"" << histograms[i].first << "\": ";
+    histograms[i].second->writeJson(os);
   }
-
-  return result;
+  os << "\n  },\n";
+  os << "  \"deadline\": {\"completed\": " << d.completed
+     << ", \"missed\": " << d.missed << ", \"late\": " << d.late
+     << ", \"skipped\": " << d.skipped << ", \"miss_rate\": "
+     << (blocks ? static_cast<double>(d.missed) / blocks : 0.0) << "},\n";
+  os << "  \"control\": {\"fresh\": " << c.fresh << ", \"stale\": " << c.stale
+     << ", \"zero\": " << c.zero << "},\n";
+  os << "  \"mic_queue\": {\"overruns\": " << q.overruns
+     << ", \"underruns\": " << q.underruns
+     << ", \"pool_exhausted\": " << q.poolExhausted << "},\n";
+  os << "  \"noise\": {\"mic_underruns\": " << n.micUnderruns
+     << ", \"drift_underruns\": " << n.driftUnderruns
+     << ", \"lookahead_stalls\": " << n.lookaheadStalls << "}\n}\n";
 }
+
+#define INSTANTIATE_DSP_INTERFACE(C) template class BasicDSPInterface<C>;
+DSP_FOR_EACH_CONFIG(INSTANTIATE_DSP_INTERFACE)
@@ -1,25 +1,39 @@
 #pragma once
 
-#include "utils/DoubleBufferSPSC.h"
-#include "utils/FastLinearSystem.h"
+#include "utils/BlockPool.h"
+#include "utils/ControlDelayLine.h"
+#include "utils/DeadlineWorker.h"
 #include "utils/IIRFilter.h"
+#include "utils/ImpulseResponseAnalysis.h"
+#include "utils/KernelComposition.h"
+#include "utils/LatencyHistogram.h"
 #include "utils/LPButterworthCoeff.h"
+#include "utils/MimoLinearSystem.h"
+#include "utils/MultiKernelLinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+#include "utils/Philox.h"
+#include "utils/PipelineStage.h"
+#include "utils/PrerenderQueue.h"
 #include "utils/RingBuffer.h"
+#include "utils/SPSCQueue.h"
+#include "utils/TripleBuffer.h"
 
 #include "audio_source.h"
+#include "convolution_planner.h"
 #include "dsp_config.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <ctime>
 #include <functional>
-#include <future>
 #include <iostream>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include <Eigen/Dense>
 
@@ -31,20 +45,78 @@ using ContextBuffer = RingBuffer<Block, dsp::CONTEXT_BLOCKS>;
 
 using Clock = std::chrono::steady_clock;
 
-struct MicBlock {
-  Block outside;
-  Block inear;
-  Clock::time_point timestamp = Clock::time_point{};
+// Channel counts of the simulated headset. Reference (outside) mics pick up
+// the noise ahead of the ear, error (in-ear) mics what the user hears, and
+// every speaker reaches every mic. 1 x 1 x 1 is the single-ear system.
+struct Topology {
+  int referenceMics = 1;
+  int errorMics = 1;
+  int speakers = 1;
+
+  int mics() const { return referenceMics + errorMics; }
+  bool operator==(const Topology &) const = default;
+};
+
+// Upper bounds of Topology. They size the mic and control buffers, which
+// are held inline (every pooled mic block and delay-line slot has room for
+// all channels), so keep them tight.
+constexpr int MAX_REFERENCE_MICS = 4;
+constexpr int MAX_ERROR_MICS = 2;
+constexpr int MAX_SPEAKERS = 2;
+
+// One block of up to MaxChannels channels, one column per channel. Storage
+// is inline, so resizing within the bound never allocates.
+template <typename Config, int MaxChannels>
+using ChannelBlock =
+    Eigen::Matrix<float, static_cast<int>(Config::BLOCK_SIZE), Eigen::Dynamic,
+                  Eigen::ColMajor, static_cast<int>(Config::BLOCK_SIZE),
+                  MaxChannels>;
+
+// Speaker drive: one column per speaker
+template <typename Config>
+using BasicControl = ChannelBlock<Config, MAX_SPEAKERS>;
+
+template <typename Config> struct BasicMicBlock {
+  using Block = typename Config::Block;
+
+  ChannelBlock<Config, MAX_REFERENCE_MICS> outside; // column per reference mic
+  ChannelBlock<Config, MAX_ERROR_MICS> inear;       // column per error mic
+  Clock::time_point timestamp = Clock::time_point{}; // callback start
+  Clock::time_point queued = Clock::time_point{};    // handed to DSP thread
   uint64_t seq = 0;
+  // Whether the speaker drive behind this block was the control computed
+  // for it, or a substitute for one that arrived too late
+  ControlStatus control = ControlStatus::Fresh;
 };
 
+using MicBlock = BasicMicBlock<dsp::DefaultConfig>;
+
 constexpr size_t MIC_QUEUE_SIZE = 32;
 
-using MicQueue = RingBuffer<MicBlock, MIC_QUEUE_SIZE>;
+// Mic blocks live in a preallocated pool and are passed by handle: the
+// callback writes a slot once and every consumer reads it in place. Sized
+// for a full queue plus the blocks held by the callback, the DSP thread, the
+// processMics worker, the observer buffer (3) and the observer.
+constexpr size_t MIC_POOL_SIZE = 64;
+static_assert(MIC_POOL_SIZE >= MIC_QUEUE_SIZE + 8);
+
+template <typename Config>
+using BasicMicPool = BlockPool<BasicMicBlock<Config>, MIC_POOL_SIZE>;
+using MicPool = BasicMicPool<dsp::DefaultConfig>;
+using MicHandle = MicPool::Handle;
+using MicQueue = SPSCQueue<MicHandle, MIC_QUEUE_SIZE>;
+
+// Slots in the control delay line; bounds the system latency
+constexpr size_t CONTROL_DELAY_SIZE = 64;
+
+using Control = BasicControl<dsp::DefaultConfig>;
+using ControlLine = ControlDelayLine<Control, CONTROL_DELAY_SIZE>;
 
 struct Timing {
   int loop_latency_samp =
       0; // total loop latency (speaker->mics->compute->speaker)
+  bool hold_last_control =
+      false; // repeat the last control if one is late (default: silence)
 };
 
 struct Dynamics {
@@ -55,7 +127,9 @@ struct Dynamics {
   float noise_gain = 0.001f;
 };
 
-struct NoiseModel {
+template <typename Config> struct BasicNoiseModel {
+  using IIRFilter = BasicIIRFilter<Config>;
+
   float outside_mic_stddev = 0.0f;
   float inear_mic_stddev = 0.0f;
 
@@ -68,84 +142,328 @@ struct NoiseModel {
   IIRFilter noise_color_filter = IIRFilter(IIRFilter::identityCoeffs());
 };
 
-struct Paths {
-  IRBlock H = IRBlock::Zero();       // noise -> outside mic
-  IRBlock P = IRBlock::Zero();       // noise -> in-ear mic
-  IRBlock C = IRBlock::Zero();       // speaker -> outside mic
-  IRBlock speaker = IRBlock::Zero(); // non-flat speaker response
+// An impulse response per (mic, input) pair: row i is mic i, column j is
+// input j (the noise, or a speaker). New entries are all zero.
+template <typename IRBlock> class PathMatrix {
+public:
+  explicit PathMatrix(int rows = 1, int cols = 1) { resize(rows, cols); }
+
+  // Entries that stay in range are kept
+  void resize(int rows, int cols) {
+    std::vector<IRBlock> irs(static_cast<size_t>(rows) * cols,
+                             IRBlock::Zero());
+    for (int i = 0; i < std::min(rows, rows_); ++i)
+      for (int j = 0; j < std::min(cols, cols_); ++j)
+        irs[static_cast<size_t>(i) * cols + j] = (*this)(i, j);
+    irs_ = std::move(irs);
+    rows_ = rows;
+    cols_ = cols;
+  }
+
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+
+  IRBlock &operator()(int i, int j) {
+    return irs_[static_cast<size_t>(i) * cols_ + j];
+  }
+  const IRBlock &operator()(int i, int j) const {
+    return irs_[static_cast<size_t>(i) * cols_ + j];
+  }
+
+private:
+  int rows_ = 0;
+  int cols_ = 0;
+  std::vector<IRBlock> irs_;
 };
 
-struct State {
-  IRBlock S = IRBlock::Zero(); // S_k (evolving transfer function)
-  IRBlock S_true = IRBlock::Zero();
+template <typename Config> struct BasicPaths {
+  using IRBlock = typename Config::IRBlock;
+  using Matrix = PathMatrix<IRBlock>;
+
+  // Sized by resize(); the default is the 1 x 1 x 1 topology
+  Matrix H; // noise -> reference mics (referenceMics x 1)
+  Matrix P; // noise -> error mics (errorMics x 1)
+  Matrix C; // speakers -> reference mics (referenceMics x speakers)
+  std::vector<IRBlock> speaker{IRBlock::Zero()}; // non-flat speaker responses
+
+  // Shape every path for `topology`, keeping the entries that fit
+  void resize(const Topology &topology) {
+    H.resize(topology.referenceMics, 1);
+    P.resize(topology.errorMics, 1);
+    C.resize(topology.referenceMics, topology.speakers);
+    speaker.resize(topology.speakers, IRBlock::Zero());
+  }
+
+  Topology topology() const {
+    return {H.rows(), P.rows(), static_cast<int>(speaker.size())};
+  }
+};
 
-  ContextBuffer S_context;
+template <typename Config> struct BasicState {
+  using IRBlock = typename Config::IRBlock;
+  using IIRFilter = BasicIIRFilter<Config>;
+  using Matrix = PathMatrix<IRBlock>;
 
+  Matrix S; // S_k (evolving transfer function), errorMics x speakers
+  Matrix S_true;
+
+  RingBuffer<typename Config::Block, Config::CONTEXT_BLOCKS> S_context;
+
+  // Drift filter of S; every entry of S drifts through its own copy
   IIRFilter S_dynamics_ng = IIRFilter(IIRFilter::identityCoeffs());
   IIRFilter mic_noise_color = IIRFilter(IIRFilter::identityCoeffs());
+
+  void resize(const Topology &topology) {
+    S.resize(topology.errorMics, topology.speakers);
+    S_true.resize(topology.errorMics, topology.speakers);
+  }
 };
 
-struct Params {
+// Engine selection for the plant paths
+struct ConvolutionParams {
+  // Wisdom file with measured strategy choices (empty: no wisdom, every path
+  // partitioned)
+  std::string wisdomFile;
+  // Measure the paths the wisdom has no entry for at startup, and save the
+  // results back to wisdomFile
+  bool tune = false;
+  // Share of a path's energy (dB) its kernel may drop so the engines can
+  // skip it: quiet partitions and the decayed tail (see trimToTolerance).
+  // kExactTolerance keeps every nonzero tap; 0 dB and above is rejected.
+  float irToleranceDb = kExactTolerance;
+};
+
+// Plant paths by index into a PathPlan: noise -> outside / in-ear mics, and
+// speakers -> outside / in-ear mics (with the speaker responses folded in).
+// Every path of a matrix runs with the strategy of its class.
+enum PlantPath { kPathH = 0, kPathP, kPathC, kPathS, kNumPlantPaths };
+using PathPlan = std::array<ConvolutionStrategy, kNumPlantPaths>;
+
+enum class RunMode {
+  RealTime, // the source's thread drives the callback; DSP runs concurrently
+  Offline,  // runOffline() renders block by block on the caller's thread
+};
+
+template <typename Config> struct BasicParams {
+  // Shape paths and state for `topology` (see BasicPaths::resize)
+  void setTopology(const Topology &topology) {
+    paths.resize(topology);
+    state.resize(topology);
+  }
+
   Timing timing;
   Dynamics dynamics;
-  NoiseModel noise;
-  Paths paths;
-  State state;
+  BasicNoiseModel<Config> noise;
+  BasicPaths<Config> paths;
+  BasicState<Config> state;
   AudioSourceFactory::Config audioConfig; // WAV file
+
+  RunMode mode = RunMode::RealTime;
+  // Seed for every random draw in the simulation. Unset: random_device in
+  // real time, 0 offline. Same seed + same input = bit-identical offline run.
+  std::optional<uint64_t> seed;
+  // Compute the noise paths (H*n, P*n) for the next block on a worker while
+  // the callback runs the control-dependent paths for the current one, if
+  // the source can announce its input ahead. Real time only; offline runs
+  // stay on one thread. Output is bit-identical either way.
+  bool plant_lookahead = true;
+  ConvolutionParams convolution;
 };
 
-class DSPInterface {
+using NoiseModel = BasicNoiseModel<dsp::DefaultConfig>;
+using Paths = BasicPaths<dsp::DefaultConfig>;
+using State = BasicState<dsp::DefaultConfig>;
+using Params = BasicParams<dsp::DefaultConfig>;
 
+// The simulation at one compile-time configuration (block and IR size, see
+// dsp_config.h). Instantiated in dsp_interface.cpp for every configuration
+// in dsp::dispatchBlockSize(); DSPInterface is the default one.
+template <typename Config> class BasicDSPInterface {
 public:
-  DSPInterface(Params &params, int systemLatencyBlocks);
-
-  ~DSPInterface();
-
-  DSPInterface(const DSPInterface &) = delete;
-  DSPInterface &operator=(const DSPInterface &) = delete;
-
-  int getSystemLatency() const { return systemLatencyBlocks_; }
-  void setSystemLatency(int latency) { systemLatencyBlocks_ = latency; }
+  using Block = typename Config::Block;
+  using IRBlock = typename Config::IRBlock;
+  using MicBlock = BasicMicBlock<Config>;
+  using MicPool = BasicMicPool<Config>;
+  using MicHandle = typename MicPool::Handle;
+  using MicQueue = SPSCQueue<MicHandle, MIC_QUEUE_SIZE>;
+  using Control = BasicControl<Config>;
+  using ControlLine = ControlDelayLine<Control, CONTROL_DELAY_SIZE>;
+  using Params = BasicParams<Config>;
+  using NoiseModel = BasicNoiseModel<Config>;
+  using Paths = BasicPaths<Config>;
+  using AudioSource = BasicAudioSource<Config>;
+
+  static_assert(Config::IR_SIZE % Config::BLOCK_SIZE == 0,
+                "the S drift is rendered a block at a time");
+
+  // Throws std::invalid_argument if the paths and state do not agree on a
+  // topology within the MAX_* bounds
+  BasicDSPInterface(Params &params, int systemLatencyBlocks);
+
+  ~BasicDSPInterface();
+
+  BasicDSPInterface(const BasicDSPInterface &) = delete;
+  BasicDSPInterface &operator=(const BasicDSPInterface &) = delete;
+
+  int getSystemLatency() const {
+    return systemLatencyBlocks_.load(std::memory_order_relaxed);
+  }
+  // Clamped to [1, ControlLine::maxLatency()]
+  void setSystemLatency(int latency) {
+    systemLatencyBlocks_.store(clampLatency_(latency),
+                               std::memory_order_relaxed);
+  }
 
   // Read input samples into buffer
   std::optional<MicBlock> getMics();
+  // As getMics(), without the copy: a handle to the block itself (empty if
+  // nothing new). Holding many handles for long starves the mic pool.
+  MicHandle getMicHandle();
 
-  // Pass in control noise cancelling signal
-  void sendControl(const Block &control);
+  // Pass in control noise cancelling signal, computed from the most recent
+  // mic block. For controllers that do not use setProcessMics; the two must
+  // not be mixed (the control delay line has a single writer).
+  void sendControl(const Control &control); // one column per speaker
+  void sendControl(const Block &control);   // speaker 0, the others silent
+
+  const Topology &getTopology() const { return topology_; }
 
   const Timing &getTiming() const { return params_.timing; }
   const Dynamics &getDynamics() const { return params_.dynamics; }
   const NoiseModel &getNoiseModel() const { return params_.noise; }
   const Paths &getPaths() const { return params_.paths; }
 
+  // Strategy per plant path for `params`: from `wisdom`, measuring paths as
+  // `mode` says (new measurements are recorded in `wisdom`). Not real-time.
+  static PathPlan planPaths(const Params &params, ConvolutionWisdom &wisdom,
+                            TuneMode mode);
+  // The plan this instance runs with
+  const PathPlan &getPathPlan() const { return plan_; }
+
+  // Offline mode: render the whole input (or up to maxBlocks) on this thread.
+  // Each block runs plant -> processMics -> control delay line in lock-step,
+  // so every control lands in time and the result depends only on the
+  // input, the params and the seed. Returns the number of blocks rendered.
+  size_t runOffline(size_t maxBlocks = std::numeric_limits<size_t>::max());
+
   // Check if audio source is still running
   bool isAudioSourceRunning() const {
     return audioSource_ && audioSource_->isRunning();
   }
 
-  using ProcessMicsFn = std::function<void(const MicBlock &, Block &)>;
+  // The controller: mic block in, speaker drive out. `control` arrives
+  // zeroed with a column per speaker.
+  using ProcessMicsFn = std::function<void(const MicBlock &, Control &)>;
   void setProcessMics(ProcessMicsFn fn);
+  // Single-speaker controller: drives speaker 0, the others stay silent
+  using ProcessMicsBlockFn = std::function<void(const MicBlock &, Block &)>;
+  void setProcessMics(ProcessMicsBlockFn fn);
+
+  // Mic blocks dropped because the DSP thread fell a full queue behind
+  // (overruns), and waits of more than two block periods for the next
+  // block while the source was running (underruns)
+  // poolExhausted: blocks that found no free pool slot and were rendered
+  // into scratch instead, reaching neither the DSP thread nor getMics
+  struct MicQueueStats {
+    uint64_t overruns = 0;
+    uint64_t underruns = 0;
+    uint64_t poolExhausted = 0;
+  };
+  MicQueueStats getMicQueueStats() const {
+    return {micQueue_.overruns(),
+            micUnderruns_.load(std::memory_order_relaxed),
+            micPool_.exhausted()};
+  }
 
-private:
-  int systemLatencyBlocks_ = 1;
+  // How the speaker drive was obtained for each block since start: the
+  // control computed for it (fresh), or the last fresh one / silence
+  // substituted because it was not ready in time
+  struct ControlStats {
+    uint64_t fresh = 0;
+    uint64_t stale = 0;
+    uint64_t zero = 0;
+  };
+  ControlStats getControlStats() const {
+    return {controlFresh_.load(std::memory_order_relaxed),
+            controlStale_.load(std::memory_order_relaxed),
+            controlZero_.load(std::memory_order_relaxed)};
+  }
+
+  // processMics deadline accounting (completed / missed / late / skipped)
+  using ProcessStats = typename DeadlineWorker<MicHandle, Control>::Stats;
+  ProcessStats getProcessStats() const { return processWorker_.stats(); }
+
+  // Noise blocks the pre-render threads had not finished when the consumer
+  // (audio callback / kernel thread) needed them; the mic noise is silent
+  // and the S drift held for those blocks
+  // lookaheadStalls: callbacks that had to wait for the noise-path worker
+  struct NoiseStats {
+    uint64_t micUnderruns = 0;
+    uint64_t driftUnderruns = 0;
+    uint64_t lookaheadStalls = 0;
+  };
+  NoiseStats getNoiseStats() const {
+    return {micNoise_.underruns(), driftNoise_.underruns(),
+            noiseStage_.stalls()};
+  }
+
+  // Per-block timing, always on (each record is a few relaxed atomics)
+  struct Telemetry {
+    LatencyHistogram callback;         // audio callback duration
+    LatencyHistogram callbackInterval; // callback start to next start
+    LatencyHistogram queueWait;        // queued -> picked up by DSP thread
+    LatencyHistogram processMics;      // processMics run time (late too)
+    LatencyHistogram loop;             // capture -> control published
+  };
+  const Telemetry &getTelemetry() const { return telemetry_; }
 
-  // Ring buffer of control blocks for system latency compensation
-  std::vector<Block> controlBuf;
-  int controlBufIndex_ = 0;
-  std::mutex controlBuf_mutex_;
+  // Histogram summaries plus the queue, control and deadline counters
+  void writeTelemetryJson(std::ostream &os) const;
 
-  // Latest mic block for app observation (getMics)
-  DoubleBufferSPSC<MicBlock> inputBuf;
+private:
+  const Topology topology_;
+  static Topology checkTopology_(const Params &params);
+
+  std::atomic<int> systemLatencyBlocks_{1};
+  static int clampLatency_(int latency) {
+    return std::clamp(latency, 1, static_cast<int>(ControlLine::maxLatency()));
+  }
 
-  // Mic blocks queued for DSP thread processing
-  std::condition_variable mic_cv_;
-  std::mutex mic_mutex_;
+  // Control blocks tagged by the mic block they were computed from; the
+  // callback for block b plays the control for block b - latency
+  ControlLine controlLine_;
+  std::atomic<uint64_t> controlFresh_{0};
+  std::atomic<uint64_t> controlStale_{0};
+  std::atomic<uint64_t> controlZero_{0};
+  ControlStatus readControl_(uint64_t seq, Control &u);
+
+  // Latest mic block for app observation (getMics); the observer side is
+  // the single reader
+  TripleBuffer<MicHandle> inputBuf;
+
+  // Storage for every mic block in flight; declared before all holders of
+  // handles so it outlives them
+  MicPool micPool_;
+  MicBlock scratchMic_; // callback only: used if the pool is exhausted
+
+  // Mic blocks queued for DSP thread processing (lock-free, never blocks
+  // the audio callback)
   std::atomic<uint64_t> mic_seq_{0};
   MicQueue micQueue_;
+  std::atomic<uint64_t> micUnderruns_{0};
 
-  std::mutex paths_mutex_;
   std::mutex process_mutex_;
   ProcessMicsFn processMics_;
+  void runProcessMics_(const MicBlock &mb, Control &control);
+
+  Telemetry telemetry_;
+  Clock::time_point lastCallbackStart_{}; // audio thread
+
+  // Runs processMics_ on a persistent thread, one block at a time
+  DeadlineWorker<MicHandle, Control> processWorker_{
+      [this](const MicHandle &mb, Control &control) {
+        runProcessMics_(*mb, control);
+      }};
 
   std::jthread dspThread_;
 
@@ -155,36 +473,144 @@ private:
 
   void step_();            // advance simulation by 1 block
   void updateDynamicsS_(); // update secondary path dynamics (slowly drifting
-                           // S_true + noise)
-  void
-  updateNoiseProfile_(); // update noise model (noise stddev & varying color)
-
-  // Full plant: outside = H*n + C*speaker(u), inear = P*n + S*speaker(u)
-  void propagatePlant_(const Block &u, const Block &n, MicBlock &mb);
+                           // S_true + noise), kernel thread only
+  using PathMatrix = ::PathMatrix<IRBlock>;
+  void renderDriftNoise_(PathMatrix &w_lp); // low-passed S drift, pre-render
+  // update noise model (noise stddev & varying color)
+  void updateNoiseProfile_(const MicBlock &mb);
+
+  // Full plant, for every reference mic r and error mic e:
+  //   outside_r = H_r*n + sum_l C_rl*speaker_l(u_l)
+  //   inear_e   = P_e*n + sum_l S_el*speaker_l(u_l)
+  // split at the sums: the noise half depends only on n, so with lookahead
+  // it is computed a block early on noiseStage_. Mics are numbered reference
+  // mics first, then error mics.
+  static constexpr int MAX_PLANT_MICS = MAX_REFERENCE_MICS + MAX_ERROR_MICS;
+  using Spectrum = typename BasicPartitioning<Config>::Spectrum;
+  struct NoiseSpectra {
+    std::array<Spectrum, MAX_PLANT_MICS> mic; // spectrum of H_r*n / P_e*n
+    // In the time domain instead, for paths with their own engine
+    std::array<Block, MAX_PLANT_MICS> direct;
+  };
+  void propagateNoise_(const Block &n, NoiseSpectra &out);
+  void propagateSpeaker_(const Control &u, const NoiseSpectra &noise,
+                         MicBlock &mb);
+  Block micOut_; // one mic's signal, callback
+  // Mic m (reference mics first) of `mb` = micOut_
+  void storeMic_(MicBlock &mb, int m) const {
+    if (m < topology_.referenceMics)
+      mb.outside.col(m) = micOut_;
+    else
+      mb.inear.col(m - topology_.referenceMics) = micOut_;
+  }
+  void onLookahead_(const Block &input); // source: block k+1 is available
 
-  Block generateMicNoiseBlock_();
-  float computeStddev_(const Block &b) const;
+  void renderMicNoise_(Block &noise); // pre-render thread
+  template <typename Derived>
+  static float computeStddev_(const Eigen::MatrixBase<Derived> &b);
 
   Params params_;
 
-  FastLinearSystem<dsp::IR_SIZE> H_system_;
-  FastLinearSystem<dsp::IR_SIZE> S_system_;
-  FastLinearSystem<dsp::IR_SIZE> C_system_;
-  FastLinearSystem<dsp::IR_SIZE> P_system_;
-  FastLinearSystem<dsp::IR_SIZE> speakerSystem_;
-
-  void dspThreadLoop_(std::stop_token st);
-  Block callProcessMicsWithTimeout_(const MicBlock &mb, int timeoutUs);
+  // Each speaker's response is folded into its column of C and S
+  // (speaker_l*C_rl, speaker_l*S_el), so the speaker stage costs no
+  // transforms of its own
+  static constexpr int IR_SIZE = static_cast<int>(Config::IR_SIZE);
+  using SpeakerComposer = KernelComposer<IR_SIZE, IR_SIZE>;
+  static constexpr int SPEAKER_PATH_SIZE = SpeakerComposer::OUT_SIZE;
+  using SpeakerPath = typename SpeakerComposer::Composed;
+  std::vector<SpeakerComposer> speakerComposers_; // one per speaker
+  std::vector<SpeakerPath> foldedRow_;            // a mic's folded paths
+  // Setup: folded paths from every speaker to mic m, given unfolded
+  void setSpeakerPaths_(int m, const std::vector<const IRBlock *> &irs);
+
+  // `ir` with what the configured tolerance allows dropped, in whole
+  // partitions where possible
+  template <typename IR> static IR trimmed_(IR ir, const Params &params) {
+    trimToTolerance(ir, static_cast<int>(Config::BLOCK_SIZE),
+                    params.convolution.irToleranceDb);
+    return ir;
+  }
 
-  // preallocate scratch buffers for plant propagation
-  Block u_spk_ = Block::Zero();
-  Block yC_ = Block::Zero(); // speaker -> outside mic
-  Block yS_ = Block::Zero(); // speaker -> in-ear mic
-  Block yH_ = Block::Zero(); // noise -> outside mic
-  Block yP_ = Block::Zero(); // noise -> in-ear mic
+  // Paths sharing an input share its spectrum, and all speakers are
+  // transformed together: one batched forward FFT per side. Paths arriving
+  // at the same mic are summed as spectra: one inverse FFT per mic.
+  // noisePaths_ has one input and a row per mic; speakerPaths_ an input per
+  // speaker and a row per mic.
+  MimoLinearSystem<IR_SIZE, Config> noisePaths_;
+  MimoLinearSystem<SPEAKER_PATH_SIZE, Config> speakerPaths_;
+  std::array<BasicSpectralSum<Config>, MAX_PLANT_MICS> micSums_;
+
+  // Class of the paths into mic m: noise side (H or P) and speaker side
+  // (C or S)
+  PlantPath noiseClass_(int m) const {
+    return m < topology_.referenceMics ? kPathH : kPathP;
+  }
+  PlantPath speakerClass_(int m) const {
+    return m < topology_.referenceMics ? kPathC : kPathS;
+  }
 
-  Block lastOutside_ = Block::Zero();
-  Block lastInear_ = Block::Zero();
+  // Paths the plan does not run partitioned have their own engine (null
+  // otherwise) and are added to the mic signal after the spectral sums;
+  // their rows of the shared systems stay zero, so cost no MACs. A side
+  // whose paths all have engines skips its forward FFT.
+  PathPlan plan_;
+  // Per mic
+  std::vector<std::unique_ptr<PathEngine<IR_SIZE, Config>>> noiseEngines_;
+  // Per mic and speaker, row-major
+  std::vector<std::unique_ptr<PathEngine<SPEAKER_PATH_SIZE, Config>>>
+      speakerEngines_;
+  PathEngine<SPEAKER_PATH_SIZE, Config> *speakerEngine_(int m, int l) {
+    return speakerEngines_[m * topology_.speakers + l].get();
+  }
+  bool noiseShared_ = true;   // some noise path is partitioned
+  bool speakerShared_ = true; // some speaker path is partitioned
+  Block speakerDirect_;
+
+  // S drifts every block, but refolding and re-transforming it is far too
+  // expensive for the audio callback. The callback only ticks this counter;
+  // the kernel thread computes the next S and hands it to speakerPaths_,
+  // which swaps it in with a one-block crossfade. Ticks arriving while an
+  // update is in flight are coalesced into the next one.
+  std::atomic<uint32_t> kernelTicks_{0};
+  std::jthread kernelThread_;
+  void kernelThreadLoop_(std::stop_token st);
 
-  std::mt19937 noiseRng_{std::random_device{}()};
+  void dspThreadLoop_(std::stop_token st);
+  bool callProcessMicsWithTimeout_(const MicHandle &mb, int timeoutUs,
+                                   Control &control);
+
+
+  const bool offline_;
+  MicHandle offlineMic_; // offline: the block just produced by the callback
+
+  // Separate Philox streams of Params::seed for the audio thread (mic noise)
+  // and the kernel thread (S drift)
+  static constexpr uint64_t kNoiseStream = 0;
+  static constexpr uint64_t kDynamicsStream = 1;
+  Philox4x32 noiseRng_;
+  Philox4x32 dynamicsRng_;
+  PathMatrix S_base_; // S at start; the drift is applied around it
+  PathMatrix drift_;  // kernel thread: this update's low-passed drift
+  // Drift pre-render thread: the filter of every entry of S, row-major
+  std::vector<typename BasicState<Config>::IIRFilter> driftFilters_;
+
+  // The mic noise and the S drift noise do not depend on the control, so
+  // they are rendered ahead on their own threads (RNG, IIR colouring and
+  // normalization) and the consumers only copy finished blocks out. Offline
+  // runs start no threads and render in place. Declared
+  // last: the producers read the members above and are joined first.
+  static constexpr size_t MIC_NOISE_AHEAD = 8;
+  static constexpr size_t DRIFT_NOISE_AHEAD = 4;
+  PrerenderQueue<Block, MIC_NOISE_AHEAD> micNoise_{
+      [this](Block &noise) { renderMicNoise_(noise); }};
+  PrerenderQueue<PathMatrix, DRIFT_NOISE_AHEAD> driftNoise_{
+      [this](PathMatrix &w_lp) { renderDriftNoise_(w_lp); }};
+
+  // Noise paths one block ahead (lookahead_) or inline (serialNoise_)
+  bool lookahead_ = false;
+  NoiseSpectra serialNoise_;
+  PipelineStage<Block, NoiseSpectra> noiseStage_{
+      [this](const Block &n, NoiseSpectra &out) { propagateNoise_(n, out); }};
 };
+
+using DSPInterface = BasicDSPInterface<dsp::DefaultConfig>;
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "ComplexMac.h"
+#include "PartitionedLinearSystem.h"
+#include "RealFFT.h"
+#include "dsp_config.h"
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <vector>
+
+// Uniformly partitioned overlap-save convolution of many channels at once.
+//
+// `channels` independent inputs are each convolved with `kernels` impulse
+// responses of their own (e.g. two ears times several reference mics), with
+// the same partitioning as PartitionedLinearSystem. Everything is stored
+// channel-interleaved (SoA): sample t of channel c sits at t * channels + c,
+// and bin b of channel c at b * channels + c. So one BatchedRealFFT call
+// transforms every channel with the lanes in the innermost, vectorized loop,
+// and the spectral MAC of a kernel is one complexMac() over
+// NUM_BINS * channels flattened bins, whatever the channel count.
+//
+//   BatchedLinearSystem<1024> conv(4, 2);
+//   conv.setImpulseResponse(c, k, ir);     // for every channel / kernel
+//   conv.step(input, outputs);             // input: 4 x BLOCK_SIZE
+//                                          // outputs[k]: 4 x BLOCK_SIZE
+//
+// Kernels are set with setImpulseResponse() only (no real-time handoff or
+// crossfade); it is not real-time safe. Partitions that are zero on every
+// channel are left out of the MAC.
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+class BatchedLinearSystem {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using IRBlock = typename Partitioning::template IRVector<IR_SIZE>;
+
+  // channels x BLOCK_SIZE, column-major, i.e. channel-interleaved
+  using Frame = Eigen::MatrixXf;
+
+  static constexpr int BLOCK_SIZE = Partitioning::PARTITION_SIZE;
+  static constexpr int FFT_SIZE = Partitioning::FFT_SIZE;
+  static constexpr int NUM_BINS = Partitioning::NUM_BINS;
+  static constexpr int NUM_PARTITIONS = Partitioning::numPartitions(IR_SIZE);
+
+  BatchedLinearSystem(int channels, int kernels)
+      : channels_(channels), kernels_(kernels),
+        stride_(simd::splitStride(NUM_BINS * channels)),
+        fft_(FFT_SIZE, channels),
+        H_(static_cast<size_t>(kernels) * NUM_PARTITIONS * 2 * stride_, 0.0f),
+        X_(static_cast<size_t>(NUM_PARTITIONS) * 2 * stride_, 0.0f),
+        nonzero_(static_cast<size_t>(kernels) * NUM_PARTITIONS * channels, 0),
+        active_(kernels), window_(Frame::Zero(channels, FFT_SIZE)),
+        y_(Frame::Zero(channels, FFT_SIZE)),
+        acc_(static_cast<size_t>(NUM_BINS) * channels),
+        x_(NUM_PARTITIONS), h_(NUM_PARTITIONS) {
+    assert(channels > 0 && kernels > 0);
+    padded_.setZero();
+  }
+
+  int channels() const { return channels_; }
+  int kernels() const { return kernels_; }
+
+  // Response of kernel k on channel c (IR_SIZE taps); other channels and
+  // kernels are untouched
+  void setImpulseResponse(int c, int k, const IRBlock &impulseResponse) {
+    assert(c >= 0 && c < channels_ && k >= 0 && k < kernels_);
+    assert(impulseResponse.size() == IR_SIZE);
+    for (int p = 0; p < NUM_PARTITIONS; ++p) {
+      const int offset = p * BLOCK_SIZE;
+      const int taps = std::min(BLOCK_SIZE, IR_SIZE - offset);
+      padded_.setZero();
+      padded_.head(taps) = impulseResponse.segment(offset, taps);
+      nonzero_[laneIndex_(k, p, c)] = !(padded_.array() == 0.0f).all();
+      single_.fwd(spectrum_.data(), padded_.data());
+
+      float *re = partition_(k, p);
+      float *im = re + stride_;
+      for (int b = 0; b < NUM_BINS; ++b) {
+        re[b * channels_ + c] = spectrum_(b).real();
+        im[b * channels_ + c] = spectrum_(b).imag();
+      }
+    }
+
+    auto &active = active_[k];
+    active.clear();
+    for (int p = 0; p < NUM_PARTITIONS; ++p) {
+      const auto first = nonzero_.begin() + laneIndex_(k, p, 0);
+      if (std::any_of(first, first + channels_, [](char n) { return n; }))
+        active.push_back(p);
+    }
+  }
+
+  // One block of every channel in, one block per channel and kernel out.
+  // `outputs` must hold kernels() frames.
+  void step(const Frame &input, std::vector<Frame> &outputs) {
+    assert(input.rows() == channels_ && input.cols() == BLOCK_SIZE);
+    assert(static_cast<int>(outputs.size()) == kernels_);
+
+    // Slide the window: [previous block | current block]
+    window_.leftCols(BLOCK_SIZE) = window_.rightCols(BLOCK_SIZE);
+    window_.rightCols(BLOCK_SIZE) = input;
+    head_ = (head_ + 1) % NUM_PARTITIONS;
+    fft_.fwd(input_(head_), stride_, window_.data());
+
+    for (int k = 0; k < kernels_; ++k) {
+      const auto &active = active_[k];
+      const int parts = static_cast<int>(active.size());
+      for (int i = 0; i < parts; ++i) {
+        x_[i] = input_((head_ + NUM_PARTITIONS - active[i]) % NUM_PARTITIONS);
+        h_[i] = partition_(k, active[i]);
+      }
+      std::fill(acc_.begin(), acc_.end(), std::complex<float>(0.0f));
+      simd::complexMac(acc_.data(), x_.data(), h_.data(), parts, stride_,
+                       NUM_BINS * channels_, false);
+
+      fft_.inv(y_.data(), acc_.data());
+      outputs[k] = y_.rightCols(BLOCK_SIZE);
+    }
+  }
+
+  void reset() {
+    window_.setZero();
+    std::fill(X_.begin(), X_.end(), 0.0f);
+    head_ = 0;
+  }
+
+private:
+  size_t laneIndex_(int k, int p, int c) const {
+    return (static_cast<size_t>(k) * NUM_PARTITIONS + p) * channels_ + c;
+  }
+  float *partition_(int k, int p) {
+    return H_.data() +
+           (static_cast<size_t>(k) * NUM_PARTITIONS + p) * 2 * stride_;
+  }
+  float *input_(int slot) { return X_.data() + slot * 2 * stride_; }
+
+  int channels_, kernels_;
+  int stride_; // split stride of one channel-interleaved spectrum
+  fft::BatchedRealFFT fft_;
+
+  // Split spectra, NUM_BINS * channels real parts then as many imaginary
+  // parts: H_ per kernel and partition, X_ as a ring of input blocks
+  std::vector<float> H_, X_;
+  std::vector<char> nonzero_; // per kernel, partition and channel
+  std::vector<std::vector<int>> active_;
+  int head_ = 0;
+
+  Frame window_, y_;
+  std::vector<std::complex<float>> acc_;
+  std::vector<const float *> x_, h_;
+
+  // Single-channel transform of kernel partitions in setImpulseResponse()
+  typename Partitioning::Window padded_;
+  typename Partitioning::Spectrum spectrum_;
+  fft::RealFFT single_ = Partitioning::makeFFT();
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Fixed pool of preallocated, cache-line aligned slots handed out through
+// reference-counted handles.
+//
+// A producer acquire()s a slot, fills it in place and passes handles on;
+// every consumer reads the same slot, and the slot returns to the pool when
+// the last handle goes away. Passing a handle costs an atomic increment
+// instead of a copy of the payload.
+//
+// acquire() belongs to a single thread. Handles may be copied, moved and
+// dropped on any thread. Released slots go onto a lock-free stack; the
+// acquiring thread takes the whole stack at once when its private free list
+// runs dry, so the only contended operation is one CAS per release. A slot
+// is reused without being reset: the producer overwrites what it needs.
+template <typename T, size_t Capacity> class BlockPool {
+  static_assert(Capacity > 0 && Capacity < UINT32_MAX);
+
+  struct alignas(64) Slot {
+    T value{};
+    std::atomic<uint32_t> refs{0};
+    uint32_t next = kNone; // free-list link
+  };
+
+public:
+  class Handle {
+  public:
+    Handle() = default;
+    Handle(const Handle &o) : pool_(o.pool_), slot_(o.slot_) {
+      if (slot_)
+        slot_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    Handle(Handle &&o) noexcept
+        : pool_(std::exchange(o.pool_, nullptr)),
+          slot_(std::exchange(o.slot_, nullptr)) {}
+    Handle &operator=(Handle o) noexcept {
+      std::swap(pool_, o.pool_);
+      std::swap(slot_, o.slot_);
+      return *this;
+    }
+    ~Handle() { reset(); }
+
+    void reset() {
+      if (slot_ && slot_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        pool_->release_(slot_);
+      pool_ = nullptr;
+      slot_ = nullptr;
+    }
+
+    explicit operator bool() const { return slot_ != nullptr; }
+    T &operator*() const { return slot_->value; }
+    T *operator->() const { return &slot_->value; }
+    T *get() const { return slot_ ? &slot_->value : nullptr; }
+
+    // Handles (including this one) sharing the slot; 0 if empty
+    uint32_t useCount() const {
+      return slot_ ? slot_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+  private:
+    friend class BlockPool;
+    Handle(BlockPool *pool, Slot *slot) : pool_(pool), slot_(slot) {}
+
+    BlockPool *pool_ = nullptr;
+    Slot *slot_ = nullptr;
+  };
+
+  BlockPool() {
+    for (uint32_t i = 0; i < Capacity; ++i)
+      slots_[i].next = i + 1 < Capacity ? i + 1 : kNone;
+    local_ = 0;
+  }
+
+  // Every handle must be gone before the pool is destroyed
+  BlockPool(const BlockPool &) = delete;
+  BlockPool &operator=(const BlockPool &) = delete;
+
+  // A free slot with one reference, or an empty handle if every slot is in
+  // use (counted). Acquiring thread only.
+  Handle acquire() {
+    if (local_ == kNone) {
+      local_ = released_.exchange(kNone, std::memory_order_acquire);
+      if (local_ == kNone) {
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return {};
+      }
+    }
+    Slot &s = slots_[local_];
+    local_ = s.next;
+    s.refs.store(1, std::memory_order_relaxed);
+    return Handle(this, &s);
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+  // acquire() calls that found no free slot
+  uint64_t exhausted() const {
+    return exhausted_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  void release_(Slot *s) {
+    const uint32_t idx = static_cast<uint32_t>(s - slots_.data());
+    uint32_t head = released_.load(std::memory_order_relaxed);
+    do {
+      s->next = head;
+    } while (!released_.compare_exchange_weak(
+        head, idx, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  std::array<Slot, Capacity> slots_;
+
+  alignas(64) uint32_t local_ = kNone;             // acquirer's free list
+  alignas(64) std::atomic<uint32_t> released_{kNone}; // returned slots
+  std::atomic<uint64_t> exhausted_{0};
+};
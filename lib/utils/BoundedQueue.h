@@ -1,16 +1,193 @@
-#include <condition_variable>
-#include <deque>
+#pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Lock-free bounded multi-producer / multi-consumer FIFO (D. Vyukov's
+// bounded MPMC queue).
+//
+// Each cell carries a sequence number that says whose turn it is: a producer
+// may fill cell i when its sequence equals the enqueue position, a consumer
+// may empty it when it equals that position + 1. Claiming a position is one
+// CAS on the shared head or tail, and the cell's sequence then publishes the
+// data, so producers never wait for other producers except on the same
+// cell. Head, tail and every cell sit on their own cache lines.
+//
+// tryPush()/tryPop() never block. push()/pop() block while the queue is full
+// / empty, sleeping on an atomic wait rather than spinning, until close()
+// wakes them. Capacity is rounded up to a power of two and allocated once.
 template <typename T> class BoundedQueue {
 public:
-  BoundedQueue() {}
-  ~BoundedQueue() {}
+  explicit BoundedQueue(size_t capacity)
+      : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+        mask_(capacity_ - 1), cells_(std::make_unique<Cell[]>(capacity_)) {
+    for (size_t i = 0; i < capacity_; ++i)
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  // --- non-blocking ---
+  bool tryPush(const T &item) { return tryPush_(item); }
+  bool tryPush(T &&item) { return tryPush_(std::move(item)); }
+
+  bool tryPop(T &out) {
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const size_t seq = cell->seq.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // empty
+      } else {
+        pos = dequeuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    out = std::move(cell->data);
+    cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+    signal_(notFull_);
+    return true;
+  }
+
+  // --- blocking ---
+  // Wait for space. Returns false (item not queued) once closed.
+  bool push(const T &item) { return push_(item); }
+  bool push(T &&item) { return push_(std::move(item)); }
 
-  void push(const T &item) {}
-  void pop(const T &item);
+  // Wait for an item. Returns false once closed and drained.
+  bool pop(T &out) {
+    while (true) {
+      if (tryPop(out))
+        return true;
+      if (closed())
+        return tryPop(out);
+      const uint32_t seen = prepareWait_(notEmpty_);
+      const bool popped = tryPop(out);
+      if (!popped && !closed())
+        notEmpty_.count.wait(seen, std::memory_order_acquire);
+      doneWaiting_(notEmpty_);
+      if (popped)
+        return true;
+    }
+  }
+
+  // Wake every blocked push()/pop(); afterwards push() fails and pop()
+  // drains what is left. tryPush() still works.
+  void close() {
+    closed_.store(true, std::memory_order_seq_cst);
+    wake_(notEmpty_);
+    wake_(notFull_);
+  }
+  bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+  size_t capacity() const { return capacity_; }
+
+  // Racy snapshot, for monitoring only
+  size_t sizeApprox() const {
+    const size_t tail = enqueuePos_.load(std::memory_order_relaxed);
+    const size_t head = dequeuePos_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
 
 private:
-  int max_capacity_;
-  std::condition_variable signal_cv;
-  std::deque<T> items_;
+  struct alignas(64) Cell {
+    std::atomic<size_t> seq{0};
+    T data{};
+  };
+
+  template <typename U> bool tryPush_(U &&item) {
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      const size_t seq = cell->seq.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::forward<U>(item);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    signal_(notEmpty_);
+    return true;
+  }
+
+  template <typename U> bool push_(U &&item) {
+    while (!closed()) {
+      if (tryPush_(std::forward<U>(item)))
+        return true;
+      const uint32_t seen = prepareWait_(notFull_);
+      const bool pushed = tryPush_(std::forward<U>(item));
+      if (!pushed && !closed())
+        notFull_.count.wait(seen, std::memory_order_acquire);
+      doneWaiting_(notFull_);
+      if (pushed)
+        return true;
+    }
+    return false;
+  }
+
+  // Wake-ups for the blocking calls. A sleeper counts itself in `sleepers`,
+  // fences, then retries once before sleeping, and only leaves the count
+  // once it is awake again; a signaller fences after publishing its cell,
+  // then reads `sleepers`. Either the signaller sees the sleeper, or the
+  // sleeper's retry sees the cell. A count rather than a flag the signaller
+  // clears, so a thread that sleeps after another consumer (producer) beat
+  // it to a cell is still seen by the next signal. With nobody asleep the
+  // signal is a fence and a load.
+  struct alignas(64) Event {
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> sleepers{0};
+  };
+
+  static uint32_t prepareWait_(Event &e) {
+    e.sleepers.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return e.count.load(std::memory_order_acquire);
+  }
+
+  static void doneWaiting_(Event &e) {
+    e.sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  static void signal_(Event &e) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (e.sleepers.load(std::memory_order_relaxed) != 0)
+      wake_(e);
+  }
+
+  static void wake_(Event &e) {
+    e.count.fetch_add(1, std::memory_order_release);
+    e.count.notify_all();
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+
+  alignas(64) std::atomic<size_t> enqueuePos_{0};
+  alignas(64) std::atomic<size_t> dequeuePos_{0};
+
+  Event notEmpty_;
+  Event notFull_;
+  std::atomic<bool> closed_{false};
 };
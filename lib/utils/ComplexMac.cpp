@@ -0,0 +1,210 @@
+// ISA-specific complex MAC kernels (see ComplexMac.h). Built with
+// -ffp-contract=off so that no multiply/add pair is fused into an FMA on the
+// ISAs that have one: every kernel must round exactly like the scalar one.
+#include "ComplexMac.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+namespace {
+
+// Bins [begin, end), one at a time. The reference every kernel must match,
+// and the tail of the vector kernels.
+void macScalar_(std::complex<float> *acc, const float *const *x,
+                const float *const *h, int parts, int stride, int begin,
+                int end, bool subtract) {
+  for (int k = begin; k < end; ++k) {
+    float sr = 0.0f;
+    float si = 0.0f;
+    for (int p = 0; p < parts; ++p) {
+      const float xr = x[p][k], xi = x[p][stride + k];
+      const float hr = h[p][k], hi = h[p][stride + k];
+      sr = sr + (xr * hr - xi * hi);
+      si = si + (xr * hi + xi * hr);
+    }
+    acc[k] = subtract ? std::complex<float>(acc[k].real() - sr,
+                                            acc[k].imag() - si)
+                      : std::complex<float>(acc[k].real() + sr,
+                                            acc[k].imag() + si);
+  }
+}
+
+void macScalar(std::complex<float> *acc, const float *const *x,
+               const float *const *h, int parts, int stride, int bins,
+               bool subtract) {
+  macScalar_(acc, x, h, parts, stride, 0, bins, subtract);
+}
+
+#ifdef SIMD_X86
+
+__attribute__((target("sse2"))) void
+macSse2(std::complex<float> *acc, const float *const *x, const float *const *h,
+        int parts, int stride, int bins, bool subtract) {
+  int k = 0;
+  for (; k + 4 <= bins; k += 4) {
+    __m128 sr = _mm_setzero_ps();
+    __m128 si = _mm_setzero_ps();
+    for (int p = 0; p < parts; ++p) {
+      const __m128 xr = _mm_loadu_ps(x[p] + k);
+      const __m128 xi = _mm_loadu_ps(x[p] + stride + k);
+      const __m128 hr = _mm_loadu_ps(h[p] + k);
+      const __m128 hi = _mm_loadu_ps(h[p] + stride + k);
+      sr = _mm_add_ps(sr, _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi)));
+      si = _mm_add_ps(si, _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr)));
+    }
+    // [r0 r1 r2 r3] [i0 i1 i2 i3] -> [r0 i0 r1 i1] [r2 i2 r3 i3]
+    float *a = reinterpret_cast<float *>(acc + k);
+    const __m128 lo = _mm_unpacklo_ps(sr, si);
+    const __m128 hi = _mm_unpackhi_ps(sr, si);
+    const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4);
+    _mm_storeu_ps(a, subtract ? _mm_sub_ps(a0, lo) : _mm_add_ps(a0, lo));
+    _mm_storeu_ps(a + 4, subtract ? _mm_sub_ps(a1, hi) : _mm_add_ps(a1, hi));
+  }
+  macScalar_(acc, x, h, parts, stride, k, bins, subtract);
+}
+
+__attribute__((target("avx2"))) void
+macAvx2(std::complex<float> *acc, const float *const *x, const float *const *h,
+        int parts, int stride, int bins, bool subtract) {
+  int k = 0;
+  for (; k + 8 <= bins; k += 8) {
+    __m256 sr = _mm256_setzero_ps();
+    __m256 si = _mm256_setzero_ps();
+    for (int p = 0; p < parts; ++p) {
+      const __m256 xr = _mm256_loadu_ps(x[p] + k);
+      const __m256 xi = _mm256_loadu_ps(x[p] + stride + k);
+      const __m256 hr = _mm256_loadu_ps(h[p] + k);
+      const __m256 hi = _mm256_loadu_ps(h[p] + stride + k);
+      sr = _mm256_add_ps(
+          sr, _mm256_sub_ps(_mm256_mul_ps(xr, hr), _mm256_mul_ps(xi, hi)));
+      si = _mm256_add_ps(
+          si, _mm256_add_ps(_mm256_mul_ps(xr, hi), _mm256_mul_ps(xi, hr)));
+    }
+    // unpack works per 128-bit lane: lo = [r0 i0 r1 i1 | r4 i4 r5 i5],
+    // hi = [r2 i2 r3 i3 | r6 i6 r7 i7]; then regroup the lanes
+    float *a = reinterpret_cast<float *>(acc + k);
+    const __m256 lo = _mm256_unpacklo_ps(sr, si);
+    const __m256 hi = _mm256_unpackhi_ps(sr, si);
+    const __m256 v0 = _mm256_permute2f128_ps(lo, hi, 0x20);
+    const __m256 v1 = _mm256_permute2f128_ps(lo, hi, 0x31);
+    const __m256 a0 = _mm256_loadu_ps(a), a1 = _mm256_loadu_ps(a + 8);
+    _mm256_storeu_ps(a, subtract ? _mm256_sub_ps(a0, v0)
+                                 : _mm256_add_ps(a0, v0));
+    _mm256_storeu_ps(a + 8, subtract ? _mm256_sub_ps(a1, v1)
+                                     : _mm256_add_ps(a1, v1));
+  }
+  macScalar_(acc, x, h, parts, stride, k, bins, subtract);
+}
+
+__attribute__((target("avx512f"))) void
+macAvx512(std::complex<float> *acc, const float *const *x,
+          const float *const *h, int parts, int stride, int bins,
+          bool subtract) {
+  // 128-bit lane picks from lo (0-15) and hi (16-31) giving interleaved order
+  const __m512i first = _mm512_setr_epi32(0, 1, 2, 3, 16, 17, 18, 19, 4, 5, 6,
+                                          7, 20, 21, 22, 23);
+  const __m512i second = _mm512_setr_epi32(8, 9, 10, 11, 24, 25, 26, 27, 12,
+                                           13, 14, 15, 28, 29, 30, 31);
+  int k = 0;
+  for (; k + 16 <= bins; k += 16) {
+    __m512 sr = _mm512_setzero_ps();
+    __m512 si = _mm512_setzero_ps();
+    for (int p = 0; p < parts; ++p) {
+      const __m512 xr = _mm512_loadu_ps(x[p] + k);
+      const __m512 xi = _mm512_loadu_ps(x[p] + stride + k);
+      const __m512 hr = _mm512_loadu_ps(h[p] + k);
+      const __m512 hi = _mm512_loadu_ps(h[p] + stride + k);
+      sr = _mm512_add_ps(
+          sr, _mm512_sub_ps(_mm512_mul_ps(xr, hr), _mm512_mul_ps(xi, hi)));
+      si = _mm512_add_ps(
+          si, _mm512_add_ps(_mm512_mul_ps(xr, hi), _mm512_mul_ps(xi, hr)));
+    }
+    float *a = reinterpret_cast<float *>(acc + k);
+    const __m512 lo = _mm512_unpacklo_ps(sr, si);
+    const __m512 hi = _mm512_unpackhi_ps(sr, si);
+    const __m512 v0 = _mm512_permutex2var_ps(lo, first, hi);
+    const __m512 v1 = _mm512_permutex2var_ps(lo, second, hi);
+    const __m512 a0 = _mm512_loadu_ps(a), a1 = _mm512_loadu_ps(a + 16);
+    _mm512_storeu_ps(a, subtract ? _mm512_sub_ps(a0, v0)
+                                 : _mm512_add_ps(a0, v0));
+    _mm512_storeu_ps(a + 16, subtract ? _mm512_sub_ps(a1, v1)
+                                      : _mm512_add_ps(a1, v1));
+  }
+  macScalar_(acc, x, h, parts, stride, k, bins, subtract);
+}
+
+#endif // SIMD_X86
+
+} // namespace
+
+const char *isaName(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return "scalar";
+  case Isa::SSE2:
+    return "sse2";
+  case Isa::AVX2:
+    return "avx2";
+  case Isa::AVX512:
+    return "avx512";
+  }
+  return "?";
+}
+
+Isa detectedIsa() {
+  static const Isa isa = [] {
+#ifdef SIMD_X86
+    // __builtin_cpu_supports checks CPUID and that the OS saves the
+    // corresponding register state (XGETBV)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+      return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+      return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+  }();
+  return isa;
+}
+
+ComplexMacFn complexMacKernel(Isa isa) {
+  if (static_cast<int>(isa) > static_cast<int>(detectedIsa()))
+    return nullptr;
+  switch (isa) {
+  case Isa::Scalar:
+    return macScalar;
+#ifdef SIMD_X86
+  case Isa::SSE2:
+    return macSse2;
+  case Isa::AVX2:
+    return macAvx2;
+  case Isa::AVX512:
+    return macAvx512;
+#else
+  default:
+    break;
+#endif
+  }
+  return nullptr;
+}
+
+void toSplit(const std::complex<float> *in, float *split, int stride,
+             int bins) {
+  float *re = split;
+  float *im = split + stride;
+  for (int k = 0; k < bins; ++k) {
+    re[k] = in[k].real();
+    im[k] = in[k].imag();
+  }
+  for (int k = bins; k < stride; ++k) {
+    re[k] = 0.0f;
+    im[k] = 0.0f;
+  }
+}
+
+} // namespace simd
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+// Split-complex multiply-accumulate kernels for the frequency-domain
+// convolution engines, dispatched at runtime on the CPU's instruction set.
+//
+// A partitioned convolution spends most of its time in
+//
+//   acc[k] += sum_p X_p[k] * H_p[k]
+//
+// The kernels read X and H in split (SoA) layout: each spectrum is `stride`
+// real parts followed by `stride` imaginary parts, so a complex product is
+// four plain vector multiplies with no shuffles. The sum over all partitions
+// stays in registers and acc (interleaved, as the FFT wants it) is read and
+// written once per bin instead of once per partition. That changes the order
+// of the float additions, so results match a per-partition acc += X_p * H_p
+// loop within rounding, not bit for bit.
+//
+// One build carries SSE2, AVX2 and AVX-512 versions; the best one the CPU
+// (and OS) supports is picked by CPUID on first use. All of them perform the
+// same float operations in the same order, without FMA contraction, so every
+// ISA gives bit-identical results and an offline render does not depend on
+// the machine it ran on.
+namespace simd {
+
+enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+const char *isaName(Isa isa);
+
+// Best instruction set supported by this CPU and build (detected once)
+Isa detectedIsa();
+
+// Split layout stride for `bins` complex values: padded to a multiple of 16
+// floats so the widest kernel never reads past the end. Padding stays zero.
+constexpr int splitStride(int bins) { return (bins + 15) & ~15; }
+
+// acc[k] += sum_{p < parts} x[p][k] * h[p][k] for k < bins (acc -= ... if
+// `subtract`). x[p] and h[p] are split spectra with the given stride.
+using ComplexMacFn = void (*)(std::complex<float> *acc, const float *const *x,
+                              const float *const *h, int parts, int stride,
+                              int bins, bool subtract);
+
+// Kernel for `isa`, or nullptr if this build or CPU cannot run it
+ComplexMacFn complexMacKernel(Isa isa);
+
+// Kernel for detectedIsa()
+inline void complexMac(std::complex<float> *acc, const float *const *x,
+                       const float *const *h, int parts, int stride, int bins,
+                       bool subtract = false) {
+  static const ComplexMacFn fn = complexMacKernel(detectedIsa());
+  fn(acc, x, h, parts, stride, bins, subtract);
+}
+
+// Interleaved -> split (padding zeroed)
+void toSplit(const std::complex<float> *in, float *split, int stride,
+             int bins);
+
+} // namespace simd
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+enum class ControlStatus : uint8_t {
+  Fresh, // the block computed for this slot arrived in time
+  Stale, // it did not; the last fresh block was repeated
+  Zero,  // it did not; silence was substituted
+};
+
+// Lock-free fixed-latency delay line between a control writer and a reader.
+//
+// Every block is tagged with the sequence number it was computed for. The
+// writer stores block s in slot s % Capacity; the reader asks for exactly the
+// sequence it needs (e.g. current - latency) and gets it only if that block
+// has landed. Anything else - not yet written, overwritten, or caught
+// mid-write - is a miss, and the reader substitutes the last fresh block or
+// zeros and says so. Neither side ever waits.
+//
+// Each slot is a seqlock: the writer bumps the slot's version to odd, writes,
+// and bumps it back to even. The reader never retries; a version that is odd
+// or changes during its copy counts as a miss. Single writer, single reader.
+template <typename T, size_t Capacity> class ControlDelayLine {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "ControlDelayLine capacity must be a power of two");
+
+public:
+  static constexpr size_t MASK = Capacity - 1;
+
+  // Latency must stay below Capacity so a slot is never reused before it is
+  // read
+  static constexpr size_t maxLatency() { return Capacity - 1; }
+
+  explicit ControlDelayLine(const T &zero, bool holdLast = false)
+      : zero_(zero), last_(zero), holdLast_(holdLast) {
+    for (auto &s : slots_)
+      s.value = zero;
+  }
+
+  // --- writer ---
+  void write(uint64_t seq, const T &value) {
+    Slot &s = slots_[seq & MASK];
+    const uint64_t v = s.version.load(std::memory_order_relaxed);
+    s.version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.tag.store(seq, std::memory_order_relaxed);
+    s.value = value;
+    s.version.store(v + 2, std::memory_order_release);
+  }
+
+  // --- reader ---
+  // Block for `seq` into `out`, or the substitute if it has not landed
+  ControlStatus read(uint64_t seq, T &out) {
+    const Slot &s = slots_[seq & MASK];
+    const uint64_t v0 = s.version.load(std::memory_order_acquire);
+    if ((v0 & 1) == 0 && s.tag.load(std::memory_order_relaxed) == seq) {
+      out = s.value;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s.version.load(std::memory_order_relaxed) == v0) {
+        if (holdLast_)
+          last_ = out;
+        hasLast_ = true;
+        return ControlStatus::Fresh;
+      }
+    }
+
+    if (holdLast_ && hasLast_) {
+      out = last_;
+      return ControlStatus::Stale;
+    }
+    out = zero_;
+    return ControlStatus::Zero;
+  }
+
+private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint64_t> tag{std::numeric_limits<uint64_t>::max()};
+    T value;
+  };
+
+  std::array<Slot, Capacity> slots_;
+
+  // Reader state
+  const T zero_;
+  T last_;
+  bool holdLast_;
+  bool hasLast_ = false;
+};
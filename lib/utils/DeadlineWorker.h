@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <semaphore>
+#include <thread>
+
+// Pre-spawned worker that runs one job at a time against a deadline.
+//
+// The caller submit()s a job and then waits for its result until a deadline.
+// A job that misses its deadline is abandoned, not joined: the caller moves
+// on immediately and the result is discarded when the job eventually
+// finishes (counted as late). While an abandoned job is still running, new
+// submissions are skipped rather than queued, so one slow call cannot build
+// up a backlog.
+//
+// Job and result live in preallocated slots, and the handoff is a pair of
+// semaphores, so the per-job path does not allocate or spawn threads. Single
+// caller thread; every accepted submit() must be followed by a wait.
+template <typename Job, typename Result> class DeadlineWorker {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Fn = std::function<void(const Job &, Result &)>;
+
+  struct Stats {
+    uint64_t completed = 0; // results delivered before their deadline
+    uint64_t missed = 0;    // deadlines missed (including skipped jobs)
+    uint64_t late = 0;      // abandoned jobs that finished after the fact
+    uint64_t skipped = 0;   // not started: previous job still running
+  };
+
+  explicit DeadlineWorker(Fn fn) : fn_(std::move(fn)) {
+    worker_ = std::jthread([this](std::stop_token st) { workerLoop_(st); });
+  }
+
+  ~DeadlineWorker() {
+    worker_.request_stop();
+    start_.release();
+  }
+
+  DeadlineWorker(const DeadlineWorker &) = delete;
+  DeadlineWorker &operator=(const DeadlineWorker &) = delete;
+
+  // Copy `job` into the worker's slot and start it. Returns false (and counts
+  // a skip) if an abandoned job is still occupying the worker.
+  bool submit(const Job &job) {
+    if (busy_.load(std::memory_order_acquire)) {
+      skipped_.fetch_add(1, std::memory_order_relaxed);
+      missed_.fetch_add(1, std::memory_order_relaxed);
+      pending_ = false;
+      return false;
+    }
+    job_ = job;
+    phase_.store(kRunning, std::memory_order_relaxed);
+    busy_.store(true, std::memory_order_relaxed);
+    pending_ = true;
+    start_.release();
+    return true;
+  }
+
+  // Wait for the submitted job until `deadline`. On time: copies the result
+  // into `out` and returns true. Otherwise abandons the job and returns false
+  // without blocking further.
+  bool waitUntil(Clock::time_point deadline, Result &out) {
+    if (!pending_)
+      return false;
+    pending_ = false;
+
+    if (!done_.try_acquire_until(deadline)) {
+      // Race the worker for the job: whoever swaps the phase first decides
+      // whether the result is delivered or discarded.
+      if (phase_.exchange(kAbandoned, std::memory_order_acq_rel) != kDone) {
+        missed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      // Finished right at the deadline; its release is already posted
+      done_.acquire();
+    }
+    out = result_;
+    busy_.store(false, std::memory_order_release);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool waitFor(std::chrono::microseconds timeout, Result &out) {
+    return waitUntil(Clock::now() + timeout, out);
+  }
+
+  Stats stats() const {
+    return {completed_.load(std::memory_order_relaxed),
+            missed_.load(std::memory_order_relaxed),
+            late_.load(std::memory_order_relaxed),
+            skipped_.load(std::memory_order_relaxed)};
+  }
+
+private:
+  enum Phase : uint32_t { kRunning, kDone, kAbandoned };
+
+  void workerLoop_(std::stop_token st) {
+    while (true) {
+      start_.acquire();
+      if (st.stop_requested())
+        return;
+
+      fn_(job_, result_);
+
+      if (phase_.exchange(kDone, std::memory_order_acq_rel) == kAbandoned) {
+        // Nobody is waiting for this result any more
+        late_.fetch_add(1, std::memory_order_relaxed);
+        busy_.store(false, std::memory_order_release);
+      } else {
+        done_.release();
+      }
+    }
+  }
+
+  Fn fn_;
+  Job job_{};
+  Result result_{};
+  bool pending_ = false; // caller side: a submitted job awaits waitUntil()
+
+  std::atomic<uint32_t> phase_{kDone};
+  std::atomic<bool> busy_{false};
+  std::counting_semaphore<2> start_{0}; // a job plus the stop wake-up
+  std::binary_semaphore done_{0};
+
+  std::atomic<uint64_t> completed_{0};
+  std::atomic<uint64_t> missed_{0};
+  std::atomic<uint64_t> late_{0};
+  std::atomic<uint64_t> skipped_{0};
+
+  std::jthread worker_;
+};
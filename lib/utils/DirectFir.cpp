@@ -0,0 +1,150 @@
+// ISA-specific direct-form FIR kernels (see DirectFir.h). Built with
+// -ffp-contract=off, like ComplexMac.cpp, so every kernel rounds exactly like
+// the scalar one.
+#include "DirectFir.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+namespace {
+
+// Outputs [begin, end), one at a time. The reference every kernel must
+// match, and the tail of the vector kernels.
+void firScalar_(float *y, const float *x, const float *h, int taps,
+                int begin, int end) {
+  for (int i = begin; i < end; ++i) {
+    float acc = 0.0f;
+    for (int k = 0; k < taps; ++k)
+      acc = acc + h[k] * x[i - k];
+    y[i] = acc;
+  }
+}
+
+void firScalar(float *y, const float *x, const float *h, int taps, int n) {
+  firScalar_(y, x, h, taps, 0, n);
+}
+
+#ifdef SIMD_X86
+
+// Four vectors of outputs per pass: one tap broadcast feeds four
+// independent accumulators, which also hides the add latency
+__attribute__((target("sse2"))) void
+firSse2(float *y, const float *x, const float *h, int taps, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    __m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+    for (int k = 0; k < taps; ++k) {
+      const __m128 hk = _mm_set1_ps(h[k]);
+      const float *xk = x + i - k;
+      a0 = _mm_add_ps(a0, _mm_mul_ps(hk, _mm_loadu_ps(xk)));
+      a1 = _mm_add_ps(a1, _mm_mul_ps(hk, _mm_loadu_ps(xk + 4)));
+      a2 = _mm_add_ps(a2, _mm_mul_ps(hk, _mm_loadu_ps(xk + 8)));
+      a3 = _mm_add_ps(a3, _mm_mul_ps(hk, _mm_loadu_ps(xk + 12)));
+    }
+    _mm_storeu_ps(y + i, a0);
+    _mm_storeu_ps(y + i + 4, a1);
+    _mm_storeu_ps(y + i + 8, a2);
+    _mm_storeu_ps(y + i + 12, a3);
+  }
+  firScalar_(y, x, h, taps, i, n);
+}
+
+__attribute__((target("avx2"))) void
+firAvx2(float *y, const float *x, const float *h, int taps, int n) {
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+    for (int k = 0; k < taps; ++k) {
+      const __m256 hk = _mm256_set1_ps(h[k]);
+      const float *xk = x + i - k;
+      a0 = _mm256_add_ps(a0, _mm256_mul_ps(hk, _mm256_loadu_ps(xk)));
+      a1 = _mm256_add_ps(a1, _mm256_mul_ps(hk, _mm256_loadu_ps(xk + 8)));
+      a2 = _mm256_add_ps(a2, _mm256_mul_ps(hk, _mm256_loadu_ps(xk + 16)));
+      a3 = _mm256_add_ps(a3, _mm256_mul_ps(hk, _mm256_loadu_ps(xk + 24)));
+    }
+    _mm256_storeu_ps(y + i, a0);
+    _mm256_storeu_ps(y + i + 8, a1);
+    _mm256_storeu_ps(y + i + 16, a2);
+    _mm256_storeu_ps(y + i + 24, a3);
+  }
+  for (; i + 8 <= n; i += 8) {
+    __m256 a = _mm256_setzero_ps();
+    for (int k = 0; k < taps; ++k)
+      a = _mm256_add_ps(
+          a, _mm256_mul_ps(_mm256_set1_ps(h[k]), _mm256_loadu_ps(x + i - k)));
+    _mm256_storeu_ps(y + i, a);
+  }
+  firScalar_(y, x, h, taps, i, n);
+}
+
+__attribute__((target("avx512f"))) void
+firAvx512(float *y, const float *x, const float *h, int taps, int n) {
+  int i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+    __m512 a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+    for (int k = 0; k < taps; ++k) {
+      const __m512 hk = _mm512_set1_ps(h[k]);
+      const float *xk = x + i - k;
+      a0 = _mm512_add_ps(a0, _mm512_mul_ps(hk, _mm512_loadu_ps(xk)));
+      a1 = _mm512_add_ps(a1, _mm512_mul_ps(hk, _mm512_loadu_ps(xk + 16)));
+      a2 = _mm512_add_ps(a2, _mm512_mul_ps(hk, _mm512_loadu_ps(xk + 32)));
+      a3 = _mm512_add_ps(a3, _mm512_mul_ps(hk, _mm512_loadu_ps(xk + 48)));
+    }
+    _mm512_storeu_ps(y + i, a0);
+    _mm512_storeu_ps(y + i + 16, a1);
+    _mm512_storeu_ps(y + i + 32, a2);
+    _mm512_storeu_ps(y + i + 48, a3);
+  }
+  for (; i + 32 <= n; i += 32) {
+    __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+    for (int k = 0; k < taps; ++k) {
+      const __m512 hk = _mm512_set1_ps(h[k]);
+      const float *xk = x + i - k;
+      a0 = _mm512_add_ps(a0, _mm512_mul_ps(hk, _mm512_loadu_ps(xk)));
+      a1 = _mm512_add_ps(a1, _mm512_mul_ps(hk, _mm512_loadu_ps(xk + 16)));
+    }
+    _mm512_storeu_ps(y + i, a0);
+    _mm512_storeu_ps(y + i + 16, a1);
+  }
+  for (; i + 16 <= n; i += 16) {
+    __m512 a = _mm512_setzero_ps();
+    for (int k = 0; k < taps; ++k)
+      a = _mm512_add_ps(
+          a, _mm512_mul_ps(_mm512_set1_ps(h[k]), _mm512_loadu_ps(x + i - k)));
+    _mm512_storeu_ps(y + i, a);
+  }
+  firScalar_(y, x, h, taps, i, n);
+}
+
+#endif // SIMD_X86
+
+} // namespace
+
+DirectFirFn directFirKernel(Isa isa) {
+  if (static_cast<int>(isa) > static_cast<int>(detectedIsa()))
+    return nullptr;
+  switch (isa) {
+  case Isa::Scalar:
+    return firScalar;
+#ifdef SIMD_X86
+  case Isa::SSE2:
+    return firSse2;
+  case Isa::AVX2:
+    return firAvx2;
+  case Isa::AVX512:
+    return firAvx512;
+#else
+  default:
+    break;
+#endif
+  }
+  return nullptr;
+}
+
+} // namespace simd
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ComplexMac.h"
+
+// Direct-form FIR kernels for short responses, dispatched at runtime on the
+// CPU's instruction set like the complex MAC kernels (see ComplexMac.h).
+//
+//   y[i] = sum_{k < taps} h[k] * x[i - k]      for i < n
+//
+// x points at the sample of the first output in a contiguous history:
+// x[1 - taps] .. x[n - 1] must be readable. The vector kernels compute
+// several vectors of consecutive outputs at once, so each broadcast tap is
+// reused across all of them and the history is read with plain unaligned
+// loads. Every output accumulates its taps in order k = 0, 1, ... without
+// FMA contraction, so all ISAs give the scalar kernel's results bit for bit.
+namespace simd {
+
+using DirectFirFn = void (*)(float *y, const float *x, const float *h,
+                             int taps, int n);
+
+// Kernel for `isa`, or nullptr if this build or CPU cannot run it
+DirectFirFn directFirKernel(Isa isa);
+
+// Kernel for detectedIsa()
+inline void directFir(float *y, const float *x, const float *h, int taps,
+                      int n) {
+  static const DirectFirFn fn = directFirKernel(detectedIsa());
+  fn(y, x, h, taps, n);
+}
+
+} // namespace simd
@@ -1,81 +1,163 @@
 #pragma once
 
+#include "KernelSlots.h"
+#include "RealFFT.h"
 #include "dsp_config.h"
 #include <Eigen/Dense>
 #include <unsupported/Eigen/FFT>
 
-// Fast convolution using overlap-add FFT method
-template <int IR_SIZE> class FastLinearSystem {
+#include <algorithm>
+#include <type_traits>
+
+// Fast convolution using the overlap-save FFT method: one transform per block
+// over the last FFT_SIZE input samples
+//
+// HALF_SPECTRUM = true (default) runs the real-input/real-output path: R2C
+// forward transform, FFT_SIZE/2+1 bin multiply and C2R inverse, with the
+// kernel stored as a half spectrum. HALF_SPECTRUM = false keeps the original
+// full complex spectrum path (mainly for benchmarking against it) on a
+// complex Eigen::FFT; the half-spectrum path uses the fft::RealFFT backend.
+//
+// The block size comes from Config; FFT_SIZE is derived from it and IR_SIZE.
+template <int IR_SIZE, bool HALF_SPECTRUM = true,
+          typename Config = dsp::DefaultConfig>
+class FastLinearSystem {
 public:
-  using Block = Eigen::Matrix<float, dsp::BLOCK_SIZE, 1>;
+  static constexpr int BLOCK_SIZE = static_cast<int>(Config::BLOCK_SIZE);
+
+  using Block = typename Config::Block;
   using IRBlock = Eigen::Matrix<float, IR_SIZE, 1>;
 
-  // FFT size must be >= BLOCK_SIZE + IR_SIZE - 1 for linear convolution
-  static constexpr int FFT_SIZE = 2048; // Next power of 2 after 256+1024-1=1279
-  static constexpr int OVERLAP_SIZE = IR_SIZE - 1; // 1023 samples
+  // Smallest power of two >= BLOCK_SIZE + IR_SIZE - 1 (no wrap-around in the
+  // output block), e.g. 2048 for 256 + 1024 - 1 = 1279
+  static constexpr int FFT_SIZE =
+      static_cast<int>(dsp::linearConvolutionFFTSize(BLOCK_SIZE, IR_SIZE));
+
+  // A real signal's spectrum is conjugate-symmetric, so bins above Nyquist
+  // carry no information.
+  static constexpr int NUM_BINS = HALF_SPECTRUM ? FFT_SIZE / 2 + 1 : FFT_SIZE;
 
-  using FFTBlock = Eigen::Matrix<std::complex<float>, FFT_SIZE, 1>;
+  using FFTBlock = Eigen::Matrix<std::complex<float>, NUM_BINS, 1>;
   using RealFFTBlock = Eigen::Matrix<float, FFT_SIZE, 1>;
-  using OverlapBuffer = Eigen::Matrix<float, OVERLAP_SIZE, 1>;
 
   FastLinearSystem() {
-    H_fft_.setZero();
-    overlap_.setZero();
+    history_.setZero();
+    h_padded_.setZero();
   }
 
   FastLinearSystem(const IRBlock &impulseResponse) : FastLinearSystem() {
     setImpulseResponse(impulseResponse);
   }
 
+  // Not real-time safe and must not run concurrently with step()
   void setImpulseResponse(const IRBlock &impulseResponse) {
-    impulseResponse_ = impulseResponse;
-
-    // Precompute FFT of impulse response (zero-padded to FFT_SIZE)
-    RealFFTBlock h_padded;
-    h_padded.setZero();
-    h_padded.head(IR_SIZE) = impulseResponse;
+    computeKernel_(impulseResponse, kernels_.setupFront(), fft_);
+  }
 
-    fft_.fwd(H_fft_, h_padded);
+  // Time-varying kernel: computes the new spectrum on the calling (non-audio)
+  // thread and publishes it lock-free. The next step() swaps it in and
+  // crossfades from the old kernel's output to the new one over that block,
+  // so step() never pays for a kernel FFT. One preparing thread at a time,
+  // and not concurrently with setImpulseResponse().
+  void prepareImpulseResponse(const IRBlock &impulseResponse) {
+    computeKernel_(impulseResponse, kernels_.back(), prepareFft_);
+    kernels_.publish();
   }
 
-  const IRBlock &getImpulseResponse() const { return impulseResponse_; }
+  // Kernel currently used by step()
+  const IRBlock &getImpulseResponse() const { return kernels_.front().ir; }
 
-  // Fast overlap-add convolution
+  // Fast overlap-save convolution
   void step(const Block &input, Block &output) {
-    // Zero-pad input to FFT_SIZE
-    RealFFTBlock x_padded;
-    x_padded.setZero();
-    x_padded.head(dsp::BLOCK_SIZE) = input;
-
-    // FFT of input
-    FFTBlock X_fft;
-    fft_.fwd(X_fft, x_padded);
+    const bool fading = kernels_.acquire();
+    const FFTBlock &H = kernels_.front().H;
+
+    // Slide the input window: the newest block goes at the end
+    std::copy(history_.data() + BLOCK_SIZE, history_.data() + FFT_SIZE,
+              history_.data());
+    history_.template tail<BLOCK_SIZE>() = input;
+
+    // FFT of the window
+    fwd_(fft_, X_fft_.data(), history_.data());
+
+    // Kernel just changed: the old kernel's output differs from the new one's
+    // by X * (H_old - H), faded out across this block
+    if (fading) {
+      Y_fade_ = X_fft_.cwiseProduct(kernels_.previous().H - H);
+      inv_(fft_, y_fade_.data(), Y_fade_.data());
+    }
 
     // Frequency-domain multiplication (pointwise)
-    FFTBlock Y_fft = X_fft.cwiseProduct(H_fft_);
+    X_fft_ = X_fft_.cwiseProduct(H);
 
     // IFFT back to time domain
-    RealFFTBlock y_full;
-    fft_.inv(y_full, Y_fft);
-
-    // Overlap-add: first BLOCK_SIZE samples + overlap from previous block
-    for (int i = 0; i < dsp::BLOCK_SIZE; ++i) {
-      if (i < OVERLAP_SIZE) {
-        output(i) = y_full(i) + overlap_(i);
-      } else {
-        output(i) = y_full(i);
-      }
+    inv_(fft_, y_full_.data(), X_fft_.data());
+
+    // The last BLOCK_SIZE samples are free of circular wrap-around, since
+    // FFT_SIZE >= BLOCK_SIZE + IR_SIZE - 1. Every output sample is the
+    // current kernel applied to the whole input history, as in LinearSystem,
+    // so a kernel change takes effect on the tails of earlier blocks too.
+    output = y_full_.template tail<BLOCK_SIZE>();
+    if (fading) {
+      output += crossfadeOutRamp<Config>().cwiseProduct(
+          y_fade_.template tail<BLOCK_SIZE>());
     }
-
-    // Save overlap for next block (samples BLOCK_SIZE to
-    // BLOCK_SIZE+OVERLAP_SIZE-1)
-    overlap_ = y_full.segment<OVERLAP_SIZE>(dsp::BLOCK_SIZE);
   }
 
 private:
-  IRBlock impulseResponse_ = IRBlock::Zero();
-  FFTBlock H_fft_;
-  OverlapBuffer overlap_ = OverlapBuffer::Zero();
+  using Transform =
+      std::conditional_t<HALF_SPECTRUM, fft::RealFFT, Eigen::FFT<float>>;
+
+  static Transform makeTransform_() {
+    if constexpr (HALF_SPECTRUM)
+      return fft::RealFFT(FFT_SIZE);
+    else
+      return Transform();
+  }
+
+  static void fwd_(Transform &fft, std::complex<float> *dst,
+                   const float *src) {
+    if constexpr (HALF_SPECTRUM)
+      fft.fwd(dst, src);
+    else
+      fft.fwd(dst, src, FFT_SIZE);
+  }
+
+  static void inv_(Transform &fft, float *dst,
+                   const std::complex<float> *src) {
+    if constexpr (HALF_SPECTRUM)
+      fft.inv(dst, src);
+    else
+      fft.inv(dst, src, FFT_SIZE);
+  }
+
+  struct Kernel {
+    IRBlock ir = IRBlock::Zero();
+    FFTBlock H = FFTBlock::Zero();
+  };
+
+  // Precompute FFT of impulse response (zero-padded to FFT_SIZE)
+  void computeKernel_(const IRBlock &impulseResponse, Kernel &k,
+                      Transform &fft) {
+    k.ir = impulseResponse;
+    h_padded_.head(IR_SIZE) = impulseResponse;
+    fwd_(fft, k.H.data(), h_padded_.data());
+  }
+
+  KernelSlots<Kernel> kernels_;
+  // Last FFT_SIZE input samples, oldest first
+  RealFFTBlock history_;
+
+  // Scratch buffers, kept as members so step() does not put ~40 KB on the
+  // stack every block
+  FFTBlock X_fft_;
+  RealFFTBlock y_full_;
+  FFTBlock Y_fade_;
+  RealFFTBlock y_fade_;
+
+  Transform fft_ = makeTransform_();
 
-  Eigen::FFT<float> fft_;
+  // Kernel transform scratch (set/prepare side only; the tail stays zero)
+  RealFFTBlock h_padded_;
+  Transform prepareFft_ = makeTransform_();
 };
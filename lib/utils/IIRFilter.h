@@ -3,19 +3,17 @@
 #include "dsp_config.h"
 #include <Eigen/Dense>
 
-// 2nd Order IIR Filter
-class IIRFilter {
+// 2nd Order IIR Filter, filterBlock() working on Config's block size
+template <typename Config = dsp::DefaultConfig> class BasicIIRFilter {
 public:
-  using Block = Eigen::Matrix<float, dsp::BLOCK_SIZE, 1>;
+  using Block = typename Config::Block;
   using FilterCoeff = Eigen::Matrix<float, 5, 1>; // [b0, b1, b2, a1, a2]
 
-  IIRFilter() : coeffs_(identityCoeffs()) {}
-  IIRFilter(const FilterCoeff &coeffs) : coeffs_(coeffs) {}
+  BasicIIRFilter() : coeffs_(identityCoeffs()) {}
+  BasicIIRFilter(const FilterCoeff &coeffs) : coeffs_(coeffs) {}
 
   static FilterCoeff identityCoeffs() {
-    FilterCoeff coeffs;
-    coeffs << 1.0f, 0.0f, 0.0f, 0.0f, 0.0f;
-    return coeffs;
+    return FilterCoeff(1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
   }
 
   void setCoefficients(const FilterCoeff &coeffs) { coeffs_ = coeffs; }
@@ -34,7 +32,7 @@ public:
   }
 
   const Block &filterBlock(const Block &input) {
-    for (int i = 0; i < dsp::BLOCK_SIZE; ++i) {
+    for (int i = 0; i < static_cast<int>(Config::BLOCK_SIZE); ++i) {
       out_(i) = filterSample(input(i));
     }
     return out_;
@@ -50,3 +48,5 @@ private:
 
   Block out_ = Block::Zero();
 };
+
+using IIRFilter = BasicIIRFilter<>;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+// How much of an impulse response actually matters.
+//
+// The engines skip what is exactly zero on their own: LinearSystem convolves
+// only up to effectiveLength(), and the partitioned engines leave all-zero
+// partitions out of the MAC. trimToTolerance() makes a response sparse on
+// purpose, zeroing whatever contributes less than a given share of its
+// energy, so those skips also cover acoustic tails that decay far below
+// audibility long before the end of the buffer.
+
+// Taps of `ir` up to and including the last nonzero one
+template <typename Derived>
+int effectiveLength(const Eigen::MatrixBase<Derived> &ir) {
+  int n = static_cast<int>(ir.size());
+  while (n > 0 && ir(n - 1) == 0.0f)
+    --n;
+  return n;
+}
+
+// Tolerance that keeps every nonzero tap (nothing is trimmed)
+inline constexpr float kExactTolerance =
+    -std::numeric_limits<float>::infinity();
+
+// A tolerance of 0 dB or more would let a response lose all of its energy;
+// throws std::invalid_argument for those (and NaN)
+inline void checkToleranceDb(float toleranceDb) {
+  if (!(toleranceDb < 0.0f))
+    throw std::invalid_argument(
+        "IR tolerance must be below 0 dB (e.g. -100)");
+}
+
+// Zeroes the parts of `ir` that together hold at most 10^(toleranceDb / 10)
+// of its energy: first the quietest whole `segment`-tap segments (partitions
+// an engine can skip, interior gaps included), then, with what is left of
+// that budget, the tail sample by sample. Returns the share of the energy
+// removed, which is at most the tolerance.
+template <typename Derived>
+float trimToTolerance(Eigen::MatrixBase<Derived> &ir, int segment,
+                      float toleranceDb) {
+  const double total = ir.template cast<double>().squaredNorm();
+  if (!(toleranceDb > kExactTolerance) || total == 0.0)
+    return 0.0f;
+  double budget = total * std::pow(10.0, toleranceDb / 10.0);
+  const double allowed = budget;
+
+  const int n = static_cast<int>(ir.size());
+  const int segments = (n + segment - 1) / segment;
+  std::vector<double> energy(segments);
+  for (int s = 0; s < segments; ++s) {
+    const int len = std::min(segment, n - s * segment);
+    energy[s] =
+        ir.segment(s * segment, len).template cast<double>().squaredNorm();
+  }
+  std::vector<int> order(segments);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return energy[a] < energy[b]; });
+  for (int s : order) {
+    if (energy[s] > budget)
+      break;
+    budget -= energy[s];
+    const int len = std::min(segment, n - s * segment);
+    ir.segment(s * segment, len).setZero();
+  }
+
+  for (int i = effectiveLength(ir) - 1; i >= 0; --i) {
+    const double e = double(ir(i)) * ir(i);
+    if (e > budget)
+      break;
+    budget -= e;
+    ir(i) = 0.0f;
+  }
+  return static_cast<float>((allowed - budget) / total);
+}
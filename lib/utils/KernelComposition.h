@@ -0,0 +1,110 @@
+#pragma once
+
+#include "PartitionedLinearSystem.h"
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+
+#include <cassert>
+
+// Folding of LTI cascades into a single effective kernel.
+//
+// A chain x -> h_a -> h_b -> y is the same system as x -> (h_a * h_b) -> y,
+// whose kernel has SIZE_A + SIZE_B - 1 taps. The composition is computed with
+// an FFT of at least that length so the circular product does not wrap, which
+// keeps the folded kernel exact (up to float rounding).
+
+constexpr int cascadeLength(int sizeA, int sizeB) { return sizeA + sizeB - 1; }
+
+// Smallest power of two holding a full linear convolution of `length` taps
+constexpr int compositionFFTSize(int length) {
+  int n = 1;
+  while (n < length)
+    n <<= 1;
+  return n;
+}
+
+// Composes a fixed first stage with a (possibly changing) second stage. The
+// first stage's spectrum is cached, so recomposing after the second kernel
+// changes costs one forward and one inverse FFT.
+template <int SIZE_A, int SIZE_B> class KernelComposer {
+public:
+  static constexpr int OUT_SIZE = cascadeLength(SIZE_A, SIZE_B);
+  static constexpr int FFT_SIZE = compositionFFTSize(OUT_SIZE);
+  static constexpr int NUM_BINS = FFT_SIZE / 2 + 1;
+
+  using IRBlockA = Partitioning::IRVector<SIZE_A>;
+  using IRBlockB = Partitioning::IRVector<SIZE_B>;
+  using Composed = Partitioning::IRVector<OUT_SIZE>;
+
+  KernelComposer()
+      : padded_(Eigen::VectorXf::Zero(FFT_SIZE)),
+        y_(Eigen::VectorXf::Zero(FFT_SIZE)),
+        A_(Eigen::VectorXcf::Zero(NUM_BINS)),
+        B_(Eigen::VectorXcf::Zero(NUM_BINS)), fft_(FFT_SIZE) {}
+
+  void setFirst(const IRBlockA &a) {
+    assert(a.size() == SIZE_A);
+    padded_.setZero();
+    padded_.head(SIZE_A) = a;
+    fft_.fwd(A_.data(), padded_.data());
+  }
+
+  // out = first * b
+  void compose(const IRBlockB &b, Composed &out) {
+    assert(b.size() == SIZE_B);
+    padded_.setZero();
+    padded_.head(SIZE_B) = b;
+    fft_.fwd(B_.data(), padded_.data());
+    B_.array() *= A_.array();
+    fft_.inv(y_.data(), B_.data());
+    out = y_.head(OUT_SIZE);
+  }
+
+  Composed compose(const IRBlockB &b) {
+    Composed out;
+    out.setZero(OUT_SIZE);
+    compose(b, out);
+    return out;
+  }
+
+private:
+  Eigen::VectorXf padded_;
+  Eigen::VectorXf y_;
+  Eigen::VectorXcf A_;
+  Eigen::VectorXcf B_;
+  fft::RealFFT fft_;
+};
+
+// One-off composition of two kernels of any length
+template <typename DerivedA, typename DerivedB>
+Eigen::VectorXf composeImpulseResponses(const Eigen::MatrixBase<DerivedA> &a,
+                                        const Eigen::MatrixBase<DerivedB> &b) {
+  const int sizeA = static_cast<int>(a.size());
+  const int sizeB = static_cast<int>(b.size());
+  const int outSize = cascadeLength(sizeA, sizeB);
+  const int nfft = compositionFFTSize(outSize);
+
+  fft::RealFFT fft(nfft);
+
+  Eigen::VectorXf padded = Eigen::VectorXf::Zero(nfft);
+  Eigen::VectorXcf A(nfft / 2 + 1), B(nfft / 2 + 1);
+  padded.head(sizeA) = a;
+  fft.fwd(A.data(), padded.data());
+  padded.setZero();
+  padded.head(sizeB) = b;
+  fft.fwd(B.data(), padded.data());
+
+  B.array() *= A.array();
+  Eigen::VectorXf y(nfft);
+  fft.inv(y.data(), B.data());
+  return y.head(outSize);
+}
+
+// Effective kernel of a chain of engines (anything with getImpulseResponse()),
+// applied in argument order: x -> first -> ... -> last
+template <typename First, typename... Rest>
+Eigen::VectorXf composeCascade(const First &first, const Rest &...rest) {
+  Eigen::VectorXf h = first.getImpulseResponse();
+  ((h = composeImpulseResponses(h, rest.getImpulseResponse())), ...);
+  return h;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "dsp_config.h"
+#include <Eigen/Dense>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free handoff of precomputed kernels to the audio thread.
+//
+// A background thread computes the next kernel (e.g. its spectrum) into
+// back() and publish()es it. The audio thread calls acquire() once per block:
+// a published kernel is swapped in by exchanging a slot index (no copy, no
+// lock), and the kernel it replaced stays valid as previous() for that block
+// so the caller can crossfade between the two outputs.
+//
+// Four slots: the audio thread owns front and previous, the background thread
+// owns back, and one sits in the shared exchange. Single producer, single
+// consumer.
+template <typename Kernel> class KernelSlots {
+public:
+  // --- background thread ---
+  Kernel &back() { return slots_[back_]; }
+
+  void publish() {
+    back_ = ready_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // --- audio thread ---
+  // Returns true if a newly published kernel was swapped in
+  bool acquire() {
+    changed_ = false;
+    if ((ready_.load(std::memory_order_relaxed) & kFresh) == 0)
+      return false;
+    const uint32_t got = ready_.exchange(previous_, std::memory_order_acq_rel);
+    previous_ = front_;
+    front_ = got & kIndexMask;
+    changed_ = true;
+    return true;
+  }
+
+  const Kernel &front() const { return slots_[front_]; }
+
+  // The kernel replaced by the last acquire(); only meaningful if changed()
+  const Kernel &previous() const { return slots_[previous_]; }
+  bool changed() const { return changed_; }
+
+  // --- setup (must not run concurrently with either side) ---
+  // Writable front kernel; any pending publication is discarded
+  Kernel &setupFront() {
+    ready_.fetch_and(kIndexMask, std::memory_order_relaxed);
+    changed_ = false;
+    return slots_[front_];
+  }
+
+private:
+  static constexpr uint32_t kFresh = 0x4;
+  static constexpr uint32_t kIndexMask = 0x3;
+
+  std::array<Kernel, 4> slots_;
+  uint32_t front_ = 0;
+  uint32_t previous_ = 1;
+  alignas(64) std::atomic<uint32_t> ready_{2};
+  alignas(64) uint32_t back_ = 3;
+  bool changed_ = false;
+};
+
+// Weight of the outgoing kernel's output across the block in which a new
+// kernel is swapped in: linear from (B-1)/B down to 0 at the last sample.
+template <typename Config = dsp::DefaultConfig>
+inline const typename Config::Block &crossfadeOutRamp() {
+  static const typename Config::Block ramp = [] {
+    typename Config::Block r;
+    for (int i = 0; i < static_cast<int>(Config::BLOCK_SIZE); ++i)
+      r(i) = 1.0f - static_cast<float>(i + 1) / Config::BLOCK_SIZE;
+    return r;
+  }();
+  return ramp;
+}
@@ -54,7 +54,9 @@ public:
     a1 /= a0;
     a2 /= a0;
 
-    coeffs_ << b0, b1, b2, a1, a2;
+    // Not the comma initializer: g++ 12.2 at -O3 -DNDEBUG keeps only its
+    // first value here (not with -fno-ipa-modref); see dc_gain_is_unity
+    coeffs_ = FilterCoeff(b0, b1, b2, a1, a2);
   }
 
   const FilterCoeff &getCoefficients() const { return coeffs_; }
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+
+// Lock-free latency histogram with HDR-style log-linear buckets.
+//
+// Values (nanoseconds) below 2^SUB_BITS get a bucket each; above that every
+// power of two is split into 2^SUB_BITS equal buckets, so any recorded value
+// is known to within 1 / 2^SUB_BITS (~3%) from 1 ns up to ~36 minutes.
+// record() is a handful of relaxed atomic adds into preallocated storage -
+// no locks, no allocation - so it can stay on in the audio path. Readers may
+// run concurrently; a snapshot taken mid-record can be off by the samples in
+// flight.
+class LatencyHistogram {
+public:
+  static constexpr int SUB_BITS = 5;
+  static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BITS;
+  static constexpr int MAX_MSB = 40; // values are clamped below 2^(MAX_MSB+1)
+  static constexpr size_t NUM_BUCKETS =
+      SUB_BUCKETS + (MAX_MSB - SUB_BITS + 1) * SUB_BUCKETS;
+  static constexpr uint64_t MAX_VALUE = (uint64_t{2} << MAX_MSB) - 1;
+
+  struct Summary {
+    uint64_t count = 0;
+    uint64_t minNs = 0;
+    uint64_t maxNs = 0;
+    double meanNs = 0.0;
+    uint64_t p50Ns = 0;
+    uint64_t p90Ns = 0;
+    uint64_t p99Ns = 0;
+    uint64_t p999Ns = 0;
+  };
+
+  void record(uint64_t ns) {
+    ns = std::min(ns, MAX_VALUE);
+    counts_[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (ns > seen &&
+           !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+    }
+    seen = min_.load(std::memory_order_relaxed);
+    while (ns < seen &&
+           !min_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  template <typename Rep, typename Period>
+  void record(std::chrono::duration<Rep, Period> d) {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    record(static_cast<uint64_t>(std::max<decltype(ns)>(ns, 0)));
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+  // Smallest bucket upper bound with at least fraction q of the samples at or
+  // below it (clamped to the recorded maximum); 0 if empty
+  uint64_t percentile(double q) const {
+    const uint64_t total = count();
+    if (total == 0)
+      return 0;
+    const uint64_t rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      seen += counts_[i].load(std::memory_order_relaxed);
+      if (seen >= rank)
+        return std::min(bucketUpperBound(i),
+                        max_.load(std::memory_order_relaxed));
+    }
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  Summary summary() const {
+    Summary s;
+    s.count = count();
+    if (s.count == 0)
+      return s;
+    s.minNs = min_.load(std::memory_order_relaxed);
+    s.maxNs = max_.load(std::memory_order_relaxed);
+    s.meanNs = static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+               static_cast<double>(s.count);
+    s.p50Ns = percentile(0.50);
+    s.p90Ns = percentile(0.90);
+    s.p99Ns = percentile(0.99);
+    s.p999Ns = percentile(0.999);
+    return s;
+  }
+
+  // {"count": .., "min_ns": .., ..., "p999_ns": ..}
+  void writeJson(std::ostream &os) const {
+    const Summary s = summary();
+    os << "{\"count\": " << s.count << ", \"min_ns\": " << s.minNs
+       << ", \"mean_ns\": " << static_cast<uint64_t>(s.meanNs)
+       << ", \"p50_ns\": " << s.p50Ns << ", \"p90_ns\": " << s.p90Ns
+       << ", \"p99_ns\": " << s.p99Ns << ", \"p999_ns\": " << s.p999Ns
+       << ", \"max_ns\": " << s.maxNs << "}";
+  }
+
+  void reset() {
+    for (auto &c : counts_)
+      c.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<uint64_t>::max(),
+               std::memory_order_relaxed);
+  }
+
+  static constexpr size_t bucketIndex(uint64_t v) {
+    if (v < SUB_BUCKETS)
+      return static_cast<size_t>(v);
+    const int msb = 63 - std::countl_zero(v);
+    const int shift = msb - SUB_BITS;
+    const uint64_t sub = (v >> shift) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>(SUB_BUCKETS + shift * SUB_BUCKETS + sub);
+  }
+
+  static constexpr uint64_t bucketUpperBound(size_t i) {
+    if (i < SUB_BUCKETS)
+      return i;
+    const int shift = static_cast<int>((i - SUB_BUCKETS) / SUB_BUCKETS);
+    const uint64_t sub = (i - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> counts_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+  std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+};
@@ -1,69 +1,95 @@
 #pragma once
 
-#include "RingBuffer.h"
+#include "DirectFir.h"
+#include "ImpulseResponseAnalysis.h"
+#include "KernelSlots.h"
 #include "dsp_config.h"
 #include <Eigen/Dense>
 
-template <int IR_SIZE> class LinearSystem {
+#include <algorithm>
+#include <array>
+
+// Direct-form FIR. The input history is a mirrored ring: every block is
+// written twice, N samples apart, so the last N samples are always one
+// contiguous run and the inner loop needs no wrap-around or index math. The
+// convolution itself is a runtime-dispatched SIMD kernel (DirectFir.h) over
+// the response's effective taps, which makes this the engine of choice for
+// short or mostly-zero paths.
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+class LinearSystem {
 public:
-  using Block = Eigen::Matrix<float, dsp::BLOCK_SIZE, 1>;
-  using IRBlock = Eigen::Matrix<float, IR_SIZE, 1>;
+  static constexpr int BLOCK_SIZE = static_cast<int>(Config::BLOCK_SIZE);
 
-    static constexpr int kNumBlocks =
-      (IR_SIZE + dsp::BLOCK_SIZE - 1) / dsp::BLOCK_SIZE + 1;
+  using Block = typename Config::Block;
+  using IRBlock = Eigen::Matrix<float, IR_SIZE, 1>;
 
-  using InputHistoryBuffer = RingBuffer<Block, kNumBlocks>;
+  // Ring length: a whole number of blocks holding the current block plus
+  // the IR_SIZE - 1 samples before it
+  static constexpr int HISTORY_SIZE =
+      (IR_SIZE + 2 * BLOCK_SIZE - 2) / BLOCK_SIZE * BLOCK_SIZE;
 
   LinearSystem() = default;
-  LinearSystem(const IRBlock &impulseResponse)
-      : impulseResponse_(impulseResponse) {}
+  LinearSystem(const IRBlock &impulseResponse) {
+    setImpulseResponse(impulseResponse);
+  }
 
+  // Not real-time safe and must not run concurrently with step()
   void setImpulseResponse(const IRBlock &impulseResponse) {
-    impulseResponse_ = impulseResponse;
+    setKernel_(kernels_.setupFront(), impulseResponse);
   }
 
-  const IRBlock &getImpulseResponse() const { return impulseResponse_; }
+  // Time-varying kernel, as FastLinearSystem::prepareImpulseResponse(): the
+  // next step() swaps it in and crossfades from the old kernel's output
+  void prepareImpulseResponse(const IRBlock &impulseResponse) {
+    setKernel_(kernels_.back(), impulseResponse);
+    kernels_.publish();
+  }
+
+  const IRBlock &getImpulseResponse() const { return kernels_.front().ir; }
+
+  // Taps up to the last nonzero one; only these are convolved
+  int effectiveLength() const { return kernels_.front().taps; }
 
   // Block-based FIR: output = sum_{k=0}^{IR_SIZE-1} h[k] * x[n-k]
-  // contiguous block processing with a history of past blocks.
   void step(const Block &input, Block &output) {
-    inputHistory_.push_back(input);
-    output.setZero();
-
-    // For each output sample within the block
-    for (int n = 0; n < dsp::BLOCK_SIZE; ++n) {
-      float y = 0.0f;
-
-      // Convolve with h[0..IR_SIZE-1]
-      for (int k = 0; k < IR_SIZE; ++k) {
-        const int x_index = n - k; // relative to current block start
-
-        if (x_index >= 0) {
-          // current block
-          y += impulseResponse_(k) * input(x_index);
-        } else {
-          // previous blocks
-          const int past = (-x_index - 1) / dsp::BLOCK_SIZE +
-                           1; // 1 => immediately previous block
-          const int idx_in_block =
-              x_index + past * dsp::BLOCK_SIZE; // bring into [0, BLOCK_SIZE)
-
-          if (past <= inputHistory_.size()) {
-            const Block *b = inputHistory_.from_back(past);
-            if (b) {
-              y += impulseResponse_(k) * (*b)(idx_in_block);
-            }
-          } else {
-            // this is older than history buffer, treat as zero
-          }
-        }
-      }
-
-      output(n) = y;
+    const bool fading = kernels_.acquire();
+
+    // Write the block at pos_ and at its mirror; afterwards it is the newest
+    // block of the contiguous window ending at pos_ + HISTORY_SIZE
+    float *mirror = history_.data() + pos_;
+    std::copy(input.data(), input.data() + BLOCK_SIZE, mirror);
+    std::copy(input.data(), input.data() + BLOCK_SIZE, mirror + HISTORY_SIZE);
+    const float *x = mirror + HISTORY_SIZE;
+    pos_ = (pos_ + BLOCK_SIZE) % HISTORY_SIZE;
+
+    convolve_(kernels_.front(), x, output);
+    if (fading) {
+      convolve_(kernels_.previous(), x, fade_);
+      output += crossfadeOutRamp<Config>().cwiseProduct(fade_ - output);
     }
   }
 
 private:
-  IRBlock impulseResponse_ = IRBlock::Zero();
-  InputHistoryBuffer inputHistory_;
+  struct Kernel {
+    IRBlock ir = IRBlock::Zero();
+    int taps = 0;
+  };
+
+  static void setKernel_(Kernel &kernel, const IRBlock &impulseResponse) {
+    kernel.ir = impulseResponse;
+    kernel.taps = ::effectiveLength(impulseResponse);
+  }
+
+  // output = kernel * input, where x is the newest block in the history;
+  // the zero tail of the response contributes nothing and is skipped
+  static void convolve_(const Kernel &kernel, const float *x, Block &output) {
+    simd::directFir(output.data(), x, kernel.ir.data(), kernel.taps,
+                    BLOCK_SIZE);
+  }
+
+  KernelSlots<Kernel> kernels_;
+  // Two copies of the ring, back to back (zero before the first block)
+  std::array<float, 2 * HISTORY_SIZE> history_{};
+  int pos_ = 0; // where the next block is written
+  Block fade_;
 };
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "ComplexMac.h"
+#include "KernelSlots.h"
+#include "MultiKernelLinearSystem.h"
+#include "PartitionedLinearSystem.h"
+#include "RealFFT.h"
+#include "dsp_config.h"
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <span>
+#include <vector>
+
+// Multiple-input multiple-output convolution: `inputs` signals, `outputs`
+// sums, and an impulse response per (output, input) pair,
+//
+//   y_m = sum_j h_mj * x_j
+//
+// with the same uniform partitioning as PartitionedLinearSystem. All inputs
+// go through one frequency-domain delay line in channel-interleaved layout
+// (bin b of input j at b * inputs + j, as BatchedLinearSystem), so a block
+// costs one BatchedRealFFT call for every input together, and output m is
+// one complexMac() over NUM_BINS * inputs flattened bins followed by a sum
+// across the inputs. Outputs are accumulated as spectra, like
+// MultiKernelLinearSystem's, so contributions from several systems reaching
+// the same output are inverted once with a SpectralSum.
+//
+// With a single input the MAC runs straight into the output spectrum, and
+// the result is bit-identical to a MultiKernelLinearSystem with one kernel
+// per output.
+//
+// The responses of an output (a row of the path matrix) change together:
+// prepareImpulseResponses() transforms a new row on the calling thread and
+// hands it over lock-free; push() swaps it in and the SpectralSum overload
+// of accumulate() crossfades from the old row to the new one across that
+// block.
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+class MimoLinearSystem {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using Block = typename Partitioning::Block;
+  using IRBlock = typename Partitioning::template IRVector<IR_SIZE>;
+  using Spectrum = typename Partitioning::Spectrum;
+  using SpectralSum = BasicSpectralSum<Config>;
+
+  static constexpr int BLOCK_SIZE = Partitioning::PARTITION_SIZE;
+  static constexpr int FFT_SIZE = Partitioning::FFT_SIZE;
+  static constexpr int NUM_BINS = Partitioning::NUM_BINS;
+  static constexpr int NUM_PARTITIONS = Partitioning::numPartitions(IR_SIZE);
+
+  MimoLinearSystem(int inputs, int outputs)
+      : inputs_(inputs), outputs_(outputs),
+        stride_(simd::splitStride(NUM_BINS * inputs)),
+        fft_(FFT_SIZE, inputs), rows_(outputs),
+        X_(static_cast<size_t>(NUM_PARTITIONS) * 2 * stride_, 0.0f),
+        window_(Eigen::MatrixXf::Zero(inputs, FFT_SIZE)),
+        lanes_(inputs > 1 ? static_cast<size_t>(NUM_BINS) * inputs : 0),
+        x_(NUM_PARTITIONS), h_(NUM_PARTITIONS) {
+    assert(inputs > 0 && outputs > 0);
+    padded_.setZero();
+    for (auto &row : rows_)
+      resize_(row.setupFront());
+  }
+
+  int inputs() const { return inputs_; }
+  int outputs() const { return outputs_; }
+
+  // Response from input j to output m; the rest of the row is kept. Not
+  // real-time safe and must not run concurrently with push().
+  void setImpulseResponse(int m, int j, const IRBlock &impulseResponse) {
+    assert(m >= 0 && m < outputs_ && j >= 0 && j < inputs_);
+    assert(impulseResponse.size() == IR_SIZE);
+    Row &row = rows_[m].setupFront();
+    setLane_(row, j, impulseResponse);
+    updateActive_(row);
+  }
+
+  // Real-time safe handoff of every response to output m (one per input),
+  // taking effect at the next push(). One preparing thread, not concurrently
+  // with setImpulseResponse().
+  void prepareImpulseResponses(int m, std::span<const IRBlock> irs) {
+    assert(m >= 0 && m < outputs_);
+    assert(static_cast<int>(irs.size()) == inputs_);
+    Row &row = rows_[m].back();
+    resize_(row);
+    for (int j = 0; j < inputs_; ++j)
+      setLane_(row, j, irs[j]);
+    updateActive_(row);
+    rows_[m].publish();
+  }
+
+  // Response in use by the audio thread
+  const IRBlock &getImpulseResponse(int m, int j) const {
+    return rows_[m].front().irs[j];
+  }
+
+  // Transform the next block of every input (`inputs` is BLOCK_SIZE x
+  // inputs(), one column per input) and pick up any prepared rows
+  template <typename Derived> void push(const Eigen::MatrixBase<Derived> &in) {
+    assert(in.rows() == BLOCK_SIZE && in.cols() == inputs_);
+    // Slide the window: [previous block | current block]
+    window_.leftCols(BLOCK_SIZE) = window_.rightCols(BLOCK_SIZE);
+    window_.rightCols(BLOCK_SIZE) = in.transpose();
+    head_ = (head_ + 1) % NUM_PARTITIONS;
+    fft_.fwd(input_(head_), stride_, window_.data());
+
+    for (auto &row : rows_)
+      row.acquire();
+  }
+
+  // True if the responses to output m were swapped by the last push()
+  bool kernelChanged(int m) const { return rows_[m].changed(); }
+
+  // acc += spectrum of sum_j h_mj * x_j for the most recently pushed block
+  void accumulate(int m, Spectrum &acc) {
+    mac_(rows_[m].front(), acc, false);
+  }
+
+  // As above, plus the old-minus-new correction that finish() fades out if
+  // row m was just swapped
+  void accumulate(int m, SpectralSum &sum) {
+    const auto &row = rows_[m];
+    mac_(row.front(), sum.spectrum(), false);
+    if (row.changed()) {
+      Spectrum &delta = sum.crossfadeSpectrum();
+      mac_(row.previous(), delta, false);
+      mac_(row.front(), delta, true);
+    }
+  }
+
+  void reset() {
+    window_.setZero();
+    std::fill(X_.begin(), X_.end(), 0.0f);
+    head_ = 0;
+  }
+
+private:
+  struct Row {
+    std::vector<IRBlock> irs;   // one per input
+    std::vector<float> spectra; // per partition: split, inputs interleaved
+    std::vector<char> nonzero;  // per partition and input
+    std::vector<int> active;    // partitions nonzero on any input
+
+    const float *partition(int p, int stride) const {
+      return spectra.data() + static_cast<size_t>(p) * 2 * stride;
+    }
+  };
+
+  void resize_(Row &row) const {
+    if (static_cast<int>(row.irs.size()) == inputs_)
+      return;
+    row.irs.assign(inputs_, IRBlock::Zero(IR_SIZE));
+    row.spectra.assign(static_cast<size_t>(NUM_PARTITIONS) * 2 * stride_,
+                       0.0f);
+    row.nonzero.assign(static_cast<size_t>(NUM_PARTITIONS) * inputs_, 0);
+    row.active.reserve(NUM_PARTITIONS);
+  }
+
+  // Transform lane j of `row`, partition by partition
+  void setLane_(Row &row, int j, const IRBlock &ir) {
+    row.irs[j] = ir;
+    for (int p = 0; p < NUM_PARTITIONS; ++p) {
+      const int offset = p * BLOCK_SIZE;
+      const int taps = std::min(BLOCK_SIZE, IR_SIZE - offset);
+      padded_.setZero();
+      padded_.head(taps) = ir.segment(offset, taps);
+      const bool nonzero = !(padded_.array() == 0.0f).all();
+      row.nonzero[static_cast<size_t>(p) * inputs_ + j] = nonzero;
+      if (nonzero)
+        single_.fwd(spectrum_.data(), padded_.data());
+      else
+        spectrum_.setZero();
+
+      float *re = row.spectra.data() + static_cast<size_t>(p) * 2 * stride_;
+      float *im = re + stride_;
+      for (int b = 0; b < NUM_BINS; ++b) {
+        re[b * inputs_ + j] = spectrum_(b).real();
+        im[b * inputs_ + j] = spectrum_(b).imag();
+      }
+    }
+  }
+
+  void updateActive_(Row &row) const {
+    row.active.clear();
+    for (int p = 0; p < NUM_PARTITIONS; ++p) {
+      const auto first = row.nonzero.begin() + static_cast<size_t>(p) * inputs_;
+      if (std::any_of(first, first + inputs_, [](char n) { return n; }))
+        row.active.push_back(p);
+    }
+  }
+
+  // acc += (or -=) sum_j sum_p X_{j,k-p} * H_{mj,p}, over the row's active
+  // partitions
+  void mac_(const Row &row, Spectrum &acc, bool subtract) {
+    const int parts = static_cast<int>(row.active.size());
+    for (int i = 0; i < parts; ++i) {
+      const int p = row.active[i];
+      x_[i] = input_((head_ + NUM_PARTITIONS - p) % NUM_PARTITIONS);
+      h_[i] = row.partition(p, stride_);
+    }
+    if (inputs_ == 1) {
+      simd::complexMac(acc.data(), x_.data(), h_.data(), parts, stride_,
+                       NUM_BINS, subtract);
+      return;
+    }
+    std::fill(lanes_.begin(), lanes_.end(), std::complex<float>(0.0f));
+    simd::complexMac(lanes_.data(), x_.data(), h_.data(), parts, stride_,
+                     NUM_BINS * inputs_, subtract);
+    for (int b = 0; b < NUM_BINS; ++b) {
+      const std::complex<float> *lane = lanes_.data() + b * inputs_;
+      std::complex<float> sum = lane[0];
+      for (int j = 1; j < inputs_; ++j)
+        sum += lane[j];
+      acc(b) += sum;
+    }
+  }
+
+  float *input_(int slot) {
+    return X_.data() + static_cast<size_t>(slot) * 2 * stride_;
+  }
+
+  int inputs_, outputs_;
+  int stride_; // split stride of one channel-interleaved spectrum
+  fft::BatchedRealFFT fft_;
+  std::vector<KernelSlots<Row>> rows_;
+
+  // Input spectra X_k .. X_{k-P+1}, a ring of split spectra
+  std::vector<float> X_;
+  Eigen::MatrixXf window_; // inputs x FFT_SIZE, channel-interleaved
+  int head_ = 0;
+
+  // MAC scratch: per-input products before the sum, and the partition lists
+  std::vector<std::complex<float>> lanes_;
+  std::vector<const float *> x_, h_;
+
+  // Single-input transform of kernel partitions (setup / preparing thread)
+  typename Partitioning::Window padded_;
+  Spectrum spectrum_;
+  fft::RealFFT single_ = Partitioning::makeFFT();
+};
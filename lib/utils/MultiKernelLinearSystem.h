@@ -0,0 +1,171 @@
+#pragma once
+
+#include "KernelSlots.h"
+#include "PartitionedLinearSystem.h"
+#include "dsp_config.h"
+#include <Eigen/Dense>
+
+#include <array>
+#include <cassert>
+
+// Frequency-domain sum of several convolution outputs, inverted once.
+//
+//   SpectralSum outside;
+//   outside.clear();
+//   noise.accumulate(kH, outside.spectrum());
+//   speaker.accumulate(kC, outside.spectrum());
+//   outside.finish(mb.outside);
+//
+// Contributions added to crossfadeSpectrum() (old kernel minus new kernel)
+// are inverted separately and faded out over the block.
+template <typename Config = dsp::DefaultConfig> class BasicSpectralSum {
+public:
+  using Block = typename BasicPartitioning<Config>::Block;
+  using Spectrum = typename BasicPartitioning<Config>::Spectrum;
+
+  void clear() {
+    acc_.setZero();
+    clearCrossfade_();
+  }
+  // Start from a partial sum accumulated elsewhere (e.g. on another thread)
+  void clear(const Spectrum &initial) {
+    acc_ = initial;
+    clearCrossfade_();
+  }
+  Spectrum &spectrum() { return acc_; }
+  const Spectrum &spectrum() const { return acc_; }
+
+  Spectrum &crossfadeSpectrum() {
+    fading_ = true;
+    return delta_;
+  }
+
+  void finish(Block &output) {
+    out_.inverse(acc_, output);
+    if (fading_) {
+      out_.inverse(delta_, fade_);
+      output += crossfadeOutRamp<Config>().cwiseProduct(fade_);
+    }
+  }
+
+private:
+  void clearCrossfade_() {
+    if (fading_) {
+      delta_.setZero();
+      fading_ = false;
+    }
+  }
+
+  Spectrum acc_ = Spectrum::Zero();
+  Spectrum delta_ = Spectrum::Zero();
+  bool fading_ = false;
+  Block fade_;
+  BasicOverlapSaveOutput<Config> out_;
+};
+
+using SpectralSum = BasicSpectralSum<>;
+
+// One input, NUM_KERNELS impulse responses, one forward FFT per block.
+//
+// All kernels share the input's frequency-domain delay line, so convolving
+// the same signal with K paths costs one forward transform instead of K.
+// Contributions are accumulated as spectra; outputs that end up summed (e.g.
+// several paths arriving at the same microphone) can be added in the
+// frequency domain with a SpectralSum and inverted once.
+//
+// Kernels may change while running: prepareImpulseResponse() transforms the
+// new response on the calling thread and hands it over lock-free; push()
+// swaps it in and the SpectralSum overload of accumulate() crossfades from
+// the old kernel to the new one across that block.
+template <int IR_SIZE, int NUM_KERNELS, typename Config = dsp::DefaultConfig>
+class MultiKernelLinearSystem {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using Block = typename Partitioning::Block;
+  using IRBlock = typename Partitioning::template IRVector<IR_SIZE>;
+  using Spectrum = typename Partitioning::Spectrum;
+  using SpectralSum = BasicSpectralSum<Config>;
+
+  static constexpr int NUM_PARTITIONS = Partitioning::numPartitions(IR_SIZE);
+
+  MultiKernelLinearSystem() {
+    for (auto &slots : kernels_)
+      slots.setupFront().ir.setZero(IR_SIZE);
+  }
+
+  // Not real-time safe and must not run concurrently with push()
+  void setImpulseResponse(int k, const IRBlock &impulseResponse) {
+    assert(k >= 0 && k < NUM_KERNELS);
+    assert(impulseResponse.size() == IR_SIZE);
+    setKernel_(kernels_[k].setupFront(), impulseResponse);
+  }
+
+  // Real-time safe handoff of a new kernel, taking effect at the next push().
+  // One preparing thread per kernel, not concurrently with
+  // setImpulseResponse(k).
+  void prepareImpulseResponse(int k, const IRBlock &impulseResponse) {
+    assert(k >= 0 && k < NUM_KERNELS);
+    assert(impulseResponse.size() == IR_SIZE);
+    setKernel_(kernels_[k].back(), impulseResponse);
+    kernels_[k].publish();
+  }
+
+  // Kernel currently in use by the audio thread
+  const IRBlock &getImpulseResponse(int k) const {
+    return kernels_[k].front().ir;
+  }
+
+  // Transform the next input block (the only forward FFT per block) and pick
+  // up any prepared kernels
+  void push(const Block &input) {
+    fdl_.push(input);
+    for (auto &slots : kernels_)
+      slots.acquire();
+  }
+
+  // True if kernel k was swapped by the last push()
+  bool kernelChanged(int k) const { return kernels_[k].changed(); }
+
+  // acc += spectrum of (input * h_k) for the most recently pushed block
+  void accumulate(int k, Spectrum &acc) const {
+    fdl_.accumulate(kernels_[k].front().spectra, acc);
+  }
+
+  // As above, plus the old-minus-new correction that finish() fades out if
+  // kernel k was just swapped
+  void accumulate(int k, SpectralSum &sum) const {
+    const auto &slots = kernels_[k];
+    fdl_.accumulate(slots.front().spectra, sum.spectrum());
+    if (slots.changed()) {
+      fdl_.accumulateDifference(slots.previous().spectra,
+                                slots.front().spectra,
+                                sum.crossfadeSpectrum());
+    }
+  }
+
+  // Convenience: separate time-domain outputs, one inverse FFT per kernel
+  void step(const Block &input, std::array<Block, NUM_KERNELS> &outputs) {
+    push(input);
+    for (int k = 0; k < NUM_KERNELS; ++k) {
+      sums_[k].clear();
+      accumulate(k, sums_[k]);
+      sums_[k].finish(outputs[k]);
+    }
+  }
+
+private:
+  struct Kernel {
+    IRBlock ir;
+    PartitionedKernel<NUM_PARTITIONS, Config> spectra;
+  };
+
+  static void setKernel_(Kernel &kernel, const IRBlock &impulseResponse) {
+    kernel.ir = impulseResponse;
+    kernel.spectra.set(kernel.ir);
+  }
+
+  std::array<KernelSlots<Kernel>, NUM_KERNELS> kernels_;
+  FrequencyDelayLine<NUM_PARTITIONS, Config> fdl_;
+
+  std::array<SpectralSum, NUM_KERNELS> sums_;
+};
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "PartitionedLinearSystem.h"
+#include "dsp_config.h"
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Zero-latency non-uniform partitioned convolution (Gardner, 1995)
+//
+// The first HEAD_SIZE taps are convolved in step() with block-sized
+// partitions, so the current input block contributes to the current output
+// block and no latency is added. The rest of the IR is covered by levels of
+// doubling partition size M = 2B, 4B, ... (capped at MAX_PARTITION_SIZE),
+// each starting at tap offset 2M:
+//
+//   taps:   [0, 4B)   [4B, 8B)   [8B, 16B)   [16B, 32B)  ...
+//   size:    B (head)  2B         4B          8B
+//
+// A level collects M input samples, hands the segment to a low-priority
+// worker thread, and its result is first needed M samples later. The worker
+// therefore has one full segment period of slack, and step() only pays for the
+// head plus copying finished tail segments into the output.
+template <int IR_SIZE, int MAX_PARTITION_SIZE = 16 * dsp::BLOCK_SIZE>
+class NonUniformLinearSystem {
+public:
+  using Block = Partitioning::Block;
+  using IRBlock = Partitioning::IRVector<IR_SIZE>;
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int BLOCK = dsp::BLOCK_SIZE;
+  static constexpr int HEAD_PARTITIONS =
+      std::min(4, Partitioning::numPartitions(IR_SIZE));
+  static constexpr int HEAD_SIZE = HEAD_PARTITIONS * BLOCK;
+
+  static_assert(MAX_PARTITION_SIZE >= 2 * BLOCK &&
+                    MAX_PARTITION_SIZE % BLOCK == 0,
+                "MAX_PARTITION_SIZE must be a multiple of BLOCK_SIZE and at "
+                "least 2 * BLOCK_SIZE");
+
+  // Worker instrumentation. Slack is the margin between a tail segment being
+  // finished by the worker and step() first needing it; a segment that is not
+  // ready in time is counted as late and step() waits for it.
+  struct WorkerStats {
+    uint64_t segments = 0;
+    uint64_t late = 0;
+    double minSlackUs = 0.0;
+    double meanSlackUs = 0.0;
+    double maxWaitUs = 0.0;
+  };
+
+  NonUniformLinearSystem() {
+    impulseResponse_.setZero(IR_SIZE);
+    headAcc_.setZero();
+    buildLevels_();
+    worker_ = std::jthread([this](std::stop_token st) { workerLoop_(st); });
+  }
+
+  NonUniformLinearSystem(const IRBlock &impulseResponse)
+      : NonUniformLinearSystem() {
+    setImpulseResponse(impulseResponse);
+  }
+
+  ~NonUniformLinearSystem() {
+    worker_.request_stop();
+    work_.fetch_add(1, std::memory_order_release);
+    work_.notify_one();
+  }
+
+  NonUniformLinearSystem(const NonUniformLinearSystem &) = delete;
+  NonUniformLinearSystem &operator=(const NonUniformLinearSystem &) = delete;
+
+  // Not real-time safe: waits for the worker to drain, then recomputes every
+  // partition spectrum. Must not run concurrently with step().
+  void setImpulseResponse(const IRBlock &impulseResponse) {
+    assert(impulseResponse.size() == IR_SIZE);
+    for (auto &lvl : levels_) {
+      waitCompleted_(*lvl, lvl->submitted.load(std::memory_order_relaxed));
+    }
+
+    impulseResponse_ = impulseResponse;
+    head_.set(impulseResponse_.head(std::min(HEAD_SIZE, IR_SIZE)));
+
+    // All-zero partitions are left out of the MAC (see processSegment_)
+    for (auto &lvl : levels_) {
+      Eigen::VectorXf padded = Eigen::VectorXf::Zero(2 * lvl->size);
+      lvl->active.clear();
+      for (int p = 0; p < lvl->partitions; ++p) {
+        const int offset = lvl->offset + p * lvl->size;
+        const int taps = std::min(lvl->size, IR_SIZE - offset);
+        padded.setZero();
+        padded.head(taps) = impulseResponse_.segment(offset, taps);
+        if ((padded.array() == 0.0f).all()) {
+          lvl->H[p].setZero();
+          continue;
+        }
+        lvl->fft.fwd(lvl->spectrum.data(), padded.data());
+        simd::toSplit(lvl->spectrum.data(), lvl->H[p].data(), lvl->stride,
+                      lvl->bins);
+        lvl->h[lvl->active.size()] = lvl->H[p].data();
+        lvl->active.push_back(p);
+      }
+    }
+  }
+
+  const IRBlock &getImpulseResponse() const { return impulseResponse_; }
+
+  void step(const Block &input, Block &output) {
+    // Head: uniformly partitioned, computed in the caller's thread
+    headFdl_.push(input);
+    headAcc_.setZero();
+    headFdl_.accumulate(head_, headAcc_);
+    headOut_.inverse(headAcc_, output);
+
+    bool submitted = false;
+    for (auto &lvl : levels_) {
+      Level &L = *lvl;
+      const int sub = static_cast<int>(block_ % L.blocksPerSegment);
+      const int64_t seg = static_cast<int64_t>(block_ / L.blocksPerSegment);
+
+      // Tail output: segment j is added to blocks [(j+2)r, (j+3)r). Syncing
+      // here also guarantees the worker is done with input slot j&1 before
+      // segment j+2 overwrites it below.
+      const int64_t j = seg - 2;
+      if (j >= 0) {
+        if (sub == 0) {
+          waitForSegment_(L, static_cast<uint64_t>(j));
+        }
+        output += L.output[j & 1].segment(sub * BLOCK, BLOCK);
+      }
+
+      // Tail input: fill segment `seg`, hand it off once complete
+      L.input[seg & 1].segment(sub * BLOCK, BLOCK) = input;
+      if (sub == L.blocksPerSegment - 1) {
+        L.submitted.store(static_cast<uint64_t>(seg) + 1,
+                          std::memory_order_release);
+        submitted = true;
+      }
+    }
+
+    if (submitted) {
+      work_.fetch_add(1, std::memory_order_release);
+      work_.notify_one();
+    }
+    ++block_;
+  }
+
+  WorkerStats workerStats() const {
+    WorkerStats s;
+    s.segments = segments_.load(std::memory_order_relaxed);
+    s.late = late_.load(std::memory_order_relaxed);
+    if (s.segments > 0) {
+      s.minSlackUs = minSlackNs_.load(std::memory_order_relaxed) * 1e-3;
+      s.meanSlackUs =
+          slackSumNs_.load(std::memory_order_relaxed) * 1e-3 / s.segments;
+    }
+    s.maxWaitUs = maxWaitNs_.load(std::memory_order_relaxed) * 1e-3;
+    return s;
+  }
+
+  // Partition layout, for inspection: {size, offset, partitions} per level
+  struct LevelInfo {
+    int size;
+    int offset;
+    int partitions;
+  };
+  std::vector<LevelInfo> levels() const {
+    std::vector<LevelInfo> out;
+    for (const auto &lvl : levels_)
+      out.push_back({lvl->size, lvl->offset, lvl->partitions});
+    return out;
+  }
+
+private:
+  // One uniformly partitioned tail section, run by the worker
+  struct Level {
+    int size = 0;       // partition size M (samples)
+    int offset = 0;     // first tap covered (always 2M)
+    int partitions = 0; // partitions of size M in this level
+    int blocksPerSegment = 0;
+    int bins = 0;   // half spectrum of 2M
+    int stride = 0; // split layout stride
+
+    std::vector<Eigen::VectorXf> H; // partition spectra (split)
+    std::vector<Eigen::VectorXf> X; // frequency-domain delay line (split)
+    std::vector<int> active;         // partitions with nonzero taps
+    std::vector<const float *> h, x; // MAC operands of the active partitions
+    int fdlHead = 0;
+    Eigen::VectorXf window; // [previous segment | current segment]
+    Eigen::VectorXcf spectrum; // interleaved FFT output
+    Eigen::VectorXcf acc;
+    Eigen::VectorXf y;
+
+    std::array<Eigen::VectorXf, 2> input;  // audio thread -> worker
+    std::array<Eigen::VectorXf, 2> output; // worker -> audio thread
+    std::array<Clock::time_point, 2> doneAt;
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> completed{0};
+
+    fft::RealFFT fft;
+  };
+
+  void buildLevels_() {
+    int offset = HEAD_SIZE;
+    int size = 2 * BLOCK;
+    while (offset < IR_SIZE) {
+      const bool last = size >= MAX_PARTITION_SIZE;
+      const int needed = (IR_SIZE - offset + size - 1) / size;
+      auto lvl = std::make_unique<Level>();
+      lvl->size = size;
+      lvl->offset = offset;
+      lvl->partitions = last ? needed : std::min(2, needed);
+      lvl->blocksPerSegment = size / BLOCK;
+
+      lvl->bins = size + 1;
+      lvl->stride = simd::splitStride(lvl->bins);
+      lvl->H.assign(lvl->partitions, Eigen::VectorXf::Zero(2 * lvl->stride));
+      lvl->X.assign(lvl->partitions, Eigen::VectorXf::Zero(2 * lvl->stride));
+      lvl->active.reserve(lvl->partitions);
+      lvl->h.resize(lvl->partitions);
+      lvl->x.resize(lvl->partitions);
+      lvl->window = Eigen::VectorXf::Zero(2 * size);
+      lvl->fft = fft::RealFFT(2 * size);
+      lvl->spectrum = Eigen::VectorXcf::Zero(lvl->bins);
+      lvl->acc = Eigen::VectorXcf::Zero(lvl->bins);
+      lvl->y = Eigen::VectorXf::Zero(2 * size);
+      for (int s = 0; s < 2; ++s) {
+        lvl->input[s] = Eigen::VectorXf::Zero(size);
+        lvl->output[s] = Eigen::VectorXf::Zero(size);
+      }
+
+      offset += lvl->partitions * size;
+      levels_.push_back(std::move(lvl));
+      if (!last)
+        size *= 2;
+    }
+  }
+
+  void waitCompleted_(Level &L, uint64_t count) {
+    uint64_t done = L.completed.load(std::memory_order_acquire);
+    while (done < count) {
+      L.completed.wait(done, std::memory_order_acquire);
+      done = L.completed.load(std::memory_order_acquire);
+    }
+  }
+
+  void waitForSegment_(Level &L, uint64_t j) {
+    const auto now = Clock::now();
+    if (L.completed.load(std::memory_order_acquire) > j) {
+      const int64_t slack =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              now - L.doneAt[j & 1])
+              .count();
+      slackSumNs_.fetch_add(slack, std::memory_order_relaxed);
+      if (slack < minSlackNs_.load(std::memory_order_relaxed))
+        minSlackNs_.store(slack, std::memory_order_relaxed);
+    } else {
+      waitCompleted_(L, j + 1);
+      const int64_t wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               Clock::now() - now)
+                               .count();
+      late_.fetch_add(1, std::memory_order_relaxed);
+      minSlackNs_.store(0, std::memory_order_relaxed);
+      if (wait > maxWaitNs_.load(std::memory_order_relaxed))
+        maxWaitNs_.store(wait, std::memory_order_relaxed);
+    }
+    segments_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Overlap-save UPOLS step of one level for segment j
+  void processSegment_(Level &L, uint64_t j) {
+    const int M = L.size;
+    L.window.head(M) = L.window.tail(M);
+    L.window.tail(M) = L.input[j & 1];
+
+    L.fdlHead = (L.fdlHead + 1) % L.partitions;
+    L.fft.fwd(L.spectrum.data(), L.window.data());
+    simd::toSplit(L.spectrum.data(), L.X[L.fdlHead].data(), L.stride, L.bins);
+
+    // A level whose partitions are all zero still keeps its delay line
+    // current, but has no output to compute
+    const int parts = static_cast<int>(L.active.size());
+    if (parts == 0) {
+      L.output[j & 1].setZero();
+    } else {
+      for (int i = 0; i < parts; ++i) {
+        const int p = L.active[i];
+        L.x[i] = L.X[(L.fdlHead + L.partitions - p) % L.partitions].data();
+      }
+      L.acc.setZero();
+      simd::complexMac(L.acc.data(), L.x.data(), L.h.data(), parts, L.stride,
+                       L.bins);
+      L.fft.inv(L.y.data(), L.acc.data());
+      L.output[j & 1] = L.y.tail(M);
+    }
+    L.doneAt[j & 1] = Clock::now();
+  }
+
+  void workerLoop_(std::stop_token st) {
+#if defined(__linux__)
+    // Best effort: the tail has a full segment of slack, so let the audio
+    // thread win any contention for the core.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 10);
+#endif
+    while (!st.stop_requested()) {
+      const uint32_t seen = work_.load(std::memory_order_acquire);
+
+      // Smallest partitions have the nearest deadlines: always serve the
+      // lowest level with pending work first.
+      bool did = false;
+      for (auto &lvl : levels_) {
+        Level &L = *lvl;
+        const uint64_t done = L.completed.load(std::memory_order_relaxed);
+        if (done < L.submitted.load(std::memory_order_acquire)) {
+          processSegment_(L, done);
+          L.completed.store(done + 1, std::memory_order_release);
+          L.completed.notify_all();
+          did = true;
+          break;
+        }
+      }
+
+      if (!did) {
+        work_.wait(seen, std::memory_order_acquire);
+      }
+    }
+  }
+
+  IRBlock impulseResponse_;
+
+  // Head (audio thread)
+  PartitionedKernel<HEAD_PARTITIONS> head_;
+  FrequencyDelayLine<HEAD_PARTITIONS> headFdl_;
+  OverlapSaveOutput headOut_;
+  Partitioning::Spectrum headAcc_;
+  uint64_t block_ = 0;
+
+  // Tail (worker)
+  std::vector<std::unique_ptr<Level>> levels_;
+  std::atomic<uint32_t> work_{0};
+
+  std::atomic<uint64_t> segments_{0};
+  std::atomic<uint64_t> late_{0};
+  std::atomic<int64_t> slackSumNs_{0};
+  std::atomic<int64_t> minSlackNs_{std::numeric_limits<int64_t>::max()};
+  std::atomic<int64_t> maxWaitNs_{0};
+
+  std::jthread worker_;
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "ComplexMac.h"
+#include "RealFFT.h"
+#include "dsp_config.h"
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <type_traits>
+#include <vector>
+
+// Building blocks for uniformly partitioned overlap-save (UPOLS) convolution.
+//
+// The impulse response is split into partitions of BLOCK_SIZE taps, each
+// zero-padded to FFT_SIZE = 2 * BLOCK_SIZE and transformed once. Every block
+// the newest 2 * BLOCK_SIZE input window is transformed once and pushed into a
+// frequency-domain delay line (FDL), and the output spectrum is
+//
+//   Y_k = sum_p X_{k-p} * H_p
+//
+// The last BLOCK_SIZE samples of IFFT(Y_k) are the linear convolution output.
+//
+// Partition and input spectra are stored split (see ComplexMac.h) so the
+// MAC runs on the widest SIMD kernel the CPU has; only the accumulator and
+// the FFT in/outputs are interleaved.
+//
+// Every piece takes the dsp::Config it runs at (default: dsp::DefaultConfig);
+// the partition and FFT sizes follow from its block size.
+template <typename Config = dsp::DefaultConfig> struct BasicPartitioning {
+  static constexpr int PARTITION_SIZE = static_cast<int>(Config::BLOCK_SIZE);
+  static constexpr int FFT_SIZE = 2 * PARTITION_SIZE;
+  static constexpr int NUM_BINS = FFT_SIZE / 2 + 1; // half spectrum
+
+  using Block = typename Config::Block;
+  using Spectrum = Eigen::Matrix<std::complex<float>, NUM_BINS, 1>;
+  using Window = Eigen::Matrix<float, FFT_SIZE, 1>;
+
+  // Split spectrum: SPLIT_STRIDE real parts, then SPLIT_STRIDE imaginary parts
+  static constexpr int SPLIT_STRIDE = simd::splitStride(NUM_BINS);
+  using SplitSpectrum = Eigen::Matrix<float, 2 * SPLIT_STRIDE, 1>;
+
+  // Eigen rejects fixed-size objects above EIGEN_STACK_ALLOCATION_LIMIT, so
+  // room-length responses are held in a heap vector of N taps instead.
+  template <int N>
+  using IRVector =
+      std::conditional_t<(N * sizeof(float) <= EIGEN_STACK_ALLOCATION_LIMIT),
+                         Eigen::Matrix<float, N, 1>, Eigen::VectorXf>;
+
+  static constexpr int numPartitions(int irSize) {
+    return (irSize + PARTITION_SIZE - 1) / PARTITION_SIZE;
+  }
+
+  static fft::RealFFT makeFFT() { return fft::RealFFT(FFT_SIZE); }
+};
+
+using Partitioning = BasicPartitioning<>;
+
+// Partition spectra H_0 .. H_{P-1} of one impulse response
+template <int NUM_PARTITIONS, typename Config = dsp::DefaultConfig>
+class PartitionedKernel {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using Spectrum = typename Partitioning::Spectrum;
+  using SplitSpectrum = typename Partitioning::SplitSpectrum;
+  using Window = typename Partitioning::Window;
+
+  PartitionedKernel() : H_(NUM_PARTITIONS, SplitSpectrum::Zero()) {
+    padded_.setZero();
+  }
+
+  // Transform `ir` (at most NUM_PARTITIONS * PARTITION_SIZE taps).
+  // Partitions that are all zero are noted and left out of the MAC.
+  template <typename Derived> void set(const Eigen::MatrixBase<Derived> &ir) {
+    assert(ir.size() <= NUM_PARTITIONS * Partitioning::PARTITION_SIZE);
+    const int irSize = static_cast<int>(ir.size());
+    numActive_ = 0;
+    for (int p = 0; p < NUM_PARTITIONS; ++p) {
+      const int offset = p * Partitioning::PARTITION_SIZE;
+      const int taps =
+          std::max(0, std::min(Partitioning::PARTITION_SIZE, irSize - offset));
+      padded_.setZero();
+      if (taps > 0) {
+        padded_.head(taps) = ir.segment(offset, taps);
+      }
+      if ((padded_.array() == 0.0f).all()) {
+        H_[p].setZero();
+        continue;
+      }
+      active_[numActive_++] = p;
+      fft_.fwd(spectrum_.data(), padded_.data());
+      simd::toSplit(spectrum_.data(), H_[p].data(), Partitioning::SPLIT_STRIDE,
+                    Partitioning::NUM_BINS);
+    }
+  }
+
+  // Split spectrum of partition p
+  const float *partition(int p) const { return H_[p].data(); }
+
+  // Partitions with any nonzero tap, in increasing order
+  int numActive() const { return numActive_; }
+  int active(int i) const { return active_[i]; }
+
+private:
+  // Heap storage: a 64k-tap kernel is 256 partitions of ~2 KB each
+  std::vector<SplitSpectrum> H_;
+  std::array<int, NUM_PARTITIONS> active_{};
+  int numActive_ = 0;
+  Window padded_;
+  Spectrum spectrum_;
+  fft::RealFFT fft_ = Partitioning::makeFFT();
+};
+
+// Input spectra X_k .. X_{k-P+1}, one forward FFT per pushed block
+template <int NUM_PARTITIONS, typename Config = dsp::DefaultConfig>
+class FrequencyDelayLine {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using Block = typename Partitioning::Block;
+  using Spectrum = typename Partitioning::Spectrum;
+  using SplitSpectrum = typename Partitioning::SplitSpectrum;
+  using Window = typename Partitioning::Window;
+  using Kernel = PartitionedKernel<NUM_PARTITIONS, Config>;
+
+  FrequencyDelayLine() : X_(NUM_PARTITIONS, SplitSpectrum::Zero()) {
+    window_.setZero();
+  }
+
+  void push(const Block &input) {
+    // Slide the window: [previous block | current block]
+    window_.template head<Partitioning::PARTITION_SIZE>() =
+        window_.template tail<Partitioning::PARTITION_SIZE>();
+    window_.template tail<Partitioning::PARTITION_SIZE>() = input;
+
+    head_ = (head_ + 1) % NUM_PARTITIONS;
+    fft_.fwd(spectrum_.data(), window_.data());
+    simd::toSplit(spectrum_.data(), X_[head_].data(),
+                  Partitioning::SPLIT_STRIDE, Partitioning::NUM_BINS);
+  }
+
+  // Split spectrum of the input `age` blocks back (0 = newest block,
+  // NUM_PARTITIONS-1 = oldest)
+  const float *spectrum(int age) const {
+    return X_[(head_ + NUM_PARTITIONS - age) % NUM_PARTITIONS].data();
+  }
+
+  // acc += sum_p X_{k-p} * H_p
+  void accumulate(const Kernel &kernel, Spectrum &acc) const {
+    mac_(kernel, acc, false);
+  }
+
+  // acc += sum_p X_{k-p} * (A_p - B_p), as the sum with A minus the sum
+  // with B so both run on the MAC kernel
+  void accumulateDifference(const Kernel &a, const Kernel &b,
+                            Spectrum &acc) const {
+    mac_(a, acc, false);
+    mac_(b, acc, true);
+  }
+
+  void reset() {
+    window_.setZero();
+    for (auto &x : X_)
+      x.setZero();
+    head_ = 0;
+  }
+
+private:
+  // Zero partitions add nothing, so only the kernel's active ones are summed
+  void mac_(const Kernel &kernel, Spectrum &acc, bool subtract) const {
+    std::array<const float *, NUM_PARTITIONS> x, h;
+    const int parts = kernel.numActive();
+    for (int i = 0; i < parts; ++i) {
+      const int p = kernel.active(i);
+      x[i] = spectrum(p);
+      h[i] = kernel.partition(p);
+    }
+    simd::complexMac(acc.data(), x.data(), h.data(), parts,
+                     Partitioning::SPLIT_STRIDE, Partitioning::NUM_BINS,
+                     subtract);
+  }
+
+  std::vector<SplitSpectrum> X_;
+  Window window_;
+  Spectrum spectrum_;
+  int head_ = 0;
+  fft::RealFFT fft_ = Partitioning::makeFFT();
+};
+
+// Overlap-save tail of IFFT(Y): the last BLOCK_SIZE samples are valid output
+template <typename Config = dsp::DefaultConfig> class BasicOverlapSaveOutput {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using Block = typename Partitioning::Block;
+  using Spectrum = typename Partitioning::Spectrum;
+  using Window = typename Partitioning::Window;
+
+  BasicOverlapSaveOutput() { y_.setZero(); }
+
+  void inverse(const Spectrum &Y, Block &output) {
+    fft_.inv(y_.data(), Y.data());
+    output = y_.template tail<Partitioning::PARTITION_SIZE>();
+  }
+
+private:
+  Window y_;
+  fft::RealFFT fft_ = Partitioning::makeFFT();
+};
+
+using OverlapSaveOutput = BasicOverlapSaveOutput<>;
+
+// Uniformly partitioned overlap-save convolution for long impulse responses.
+// Same interface as FastLinearSystem / LinearSystem, but the per-block cost is
+// one FFT_SIZE = 2 * BLOCK_SIZE transform pair plus NUM_PARTITIONS complex
+// MACs, instead of a transform sized to the whole IR.
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+class PartitionedLinearSystem {
+public:
+  using Partitioning = BasicPartitioning<Config>;
+  using Block = typename Partitioning::Block;
+  using IRBlock = typename Partitioning::template IRVector<IR_SIZE>;
+
+  static constexpr int NUM_PARTITIONS = Partitioning::numPartitions(IR_SIZE);
+  static constexpr int FFT_SIZE = Partitioning::FFT_SIZE;
+
+  using Spectrum = typename Partitioning::Spectrum;
+
+  PartitionedLinearSystem() {
+    impulseResponse_.setZero(IR_SIZE);
+    acc_.setZero();
+  }
+
+  PartitionedLinearSystem(const IRBlock &impulseResponse)
+      : PartitionedLinearSystem() {
+    setImpulseResponse(impulseResponse);
+  }
+
+  void setImpulseResponse(const IRBlock &impulseResponse) {
+    assert(impulseResponse.size() == IR_SIZE);
+    impulseResponse_ = impulseResponse;
+    kernel_.set(impulseResponse_);
+  }
+
+  const IRBlock &getImpulseResponse() const { return impulseResponse_; }
+
+  void step(const Block &input, Block &output) {
+    fdl_.push(input);
+
+    acc_.setZero();
+    fdl_.accumulate(kernel_, acc_);
+
+    out_.inverse(acc_, output);
+  }
+
+private:
+  IRBlock impulseResponse_;
+  PartitionedKernel<NUM_PARTITIONS, Config> kernel_;
+  FrequencyDelayLine<NUM_PARTITIONS, Config> fdl_;
+  BasicOverlapSaveOutput<Config> out_;
+  Spectrum acc_;
+};
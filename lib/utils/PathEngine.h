@@ -0,0 +1,140 @@
+#pragma once
+
+#include "FastLinearSystem.h"
+#include "LinearSystem.h"
+#include "MultiKernelLinearSystem.h"
+#include "dsp_config.h"
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Convolution strategies for one signal path, all with the same interface:
+//
+//   Direct       LinearSystem: time-domain FIR over the effective taps.
+//                Cheapest for short or mostly-zero responses and tiny blocks.
+//   SingleFFT    FastLinearSystem: one overlap-save transform spanning block
+//                plus response.
+//   Partitioned  Uniformly partitioned overlap-save (MultiKernelLinearSystem).
+//
+// Which one is fastest depends on block size, response length and the CPU, so
+// it is measured rather than chosen by hand (see convolution_planner.h).
+enum class ConvolutionStrategy { Direct, SingleFFT, Partitioned };
+
+inline constexpr std::array<ConvolutionStrategy, 3> kConvolutionStrategies = {
+    ConvolutionStrategy::Direct, ConvolutionStrategy::SingleFFT,
+    ConvolutionStrategy::Partitioned};
+
+inline const char *strategyName(ConvolutionStrategy strategy) {
+  switch (strategy) {
+  case ConvolutionStrategy::Direct:
+    return "direct";
+  case ConvolutionStrategy::SingleFFT:
+    return "fft";
+  case ConvolutionStrategy::Partitioned:
+    return "partitioned";
+  }
+  return "?";
+}
+
+// Throws std::invalid_argument for an unknown name
+inline ConvolutionStrategy parseStrategy(std::string_view name) {
+  for (ConvolutionStrategy s : kConvolutionStrategies) {
+    if (name == strategyName(s))
+      return s;
+  }
+  throw std::invalid_argument("unknown convolution strategy '" +
+                              std::string(name) + "'");
+}
+
+// One path behind a runtime-chosen strategy
+template <int IR_SIZE, typename Config = dsp::DefaultConfig> class PathEngine {
+public:
+  using Block = typename Config::Block;
+  using IRBlock =
+      typename BasicPartitioning<Config>::template IRVector<IR_SIZE>;
+
+  virtual ~PathEngine() = default;
+
+  virtual ConvolutionStrategy strategy() const = 0;
+
+  // Not real-time safe and must not run concurrently with step()
+  virtual void setImpulseResponse(const IRBlock &impulseResponse) = 0;
+
+  // New kernel from one background thread, crossfaded in by the next step()
+  virtual void prepareImpulseResponse(const IRBlock &impulseResponse) = 0;
+
+  virtual void step(const Block &input, Block &output) = 0;
+};
+
+namespace detail {
+
+// Direct and SingleFFT: the engine already has the PathEngine interface
+template <typename System, ConvolutionStrategy S, int IR_SIZE, typename Config>
+class SystemPathEngine final : public PathEngine<IR_SIZE, Config> {
+public:
+  using typename PathEngine<IR_SIZE, Config>::Block;
+  using typename PathEngine<IR_SIZE, Config>::IRBlock;
+
+  ConvolutionStrategy strategy() const override { return S; }
+  void setImpulseResponse(const IRBlock &ir) override {
+    system_.setImpulseResponse(ir);
+  }
+  void prepareImpulseResponse(const IRBlock &ir) override {
+    system_.prepareImpulseResponse(ir);
+  }
+  void step(const Block &input, Block &output) override {
+    system_.step(input, output);
+  }
+
+private:
+  System system_;
+};
+
+// Partitioned: a single-kernel MultiKernelLinearSystem
+template <int IR_SIZE, typename Config>
+class PartitionedPathEngine final : public PathEngine<IR_SIZE, Config> {
+public:
+  using typename PathEngine<IR_SIZE, Config>::Block;
+  using typename PathEngine<IR_SIZE, Config>::IRBlock;
+
+  ConvolutionStrategy strategy() const override {
+    return ConvolutionStrategy::Partitioned;
+  }
+  void setImpulseResponse(const IRBlock &ir) override {
+    system_.setImpulseResponse(0, ir);
+  }
+  void prepareImpulseResponse(const IRBlock &ir) override {
+    system_.prepareImpulseResponse(0, ir);
+  }
+  void step(const Block &input, Block &output) override {
+    system_.step(input, out_);
+    output = out_[0];
+  }
+
+private:
+  MultiKernelLinearSystem<IR_SIZE, 1, Config> system_;
+  std::array<Block, 1> out_;
+};
+
+} // namespace detail
+
+template <int IR_SIZE, typename Config = dsp::DefaultConfig>
+std::unique_ptr<PathEngine<IR_SIZE, Config>>
+makePathEngine(ConvolutionStrategy strategy) {
+  switch (strategy) {
+  case ConvolutionStrategy::Direct:
+    return std::make_unique<detail::SystemPathEngine<
+        LinearSystem<IR_SIZE, Config>, ConvolutionStrategy::Direct, IR_SIZE,
+        Config>>();
+  case ConvolutionStrategy::SingleFFT:
+    return std::make_unique<detail::SystemPathEngine<
+        FastLinearSystem<IR_SIZE, true, Config>,
+        ConvolutionStrategy::SingleFFT, IR_SIZE, Config>>();
+  case ConvolutionStrategy::Partitioned:
+    return std::make_unique<detail::PartitionedPathEngine<IR_SIZE, Config>>();
+  }
+  return nullptr;
+}
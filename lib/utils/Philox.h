@@ -0,0 +1,172 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numbers>
+#include <type_traits>
+
+// Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC'11).
+//
+// Output i of a stream is a pure function of (seed, stream, i): a 128-bit
+// counter {position, stream} is encrypted under the 64-bit seed, giving four
+// 32-bit words per counter. There is no state to advance sample by sample, so
+// independent streams need no coordination, seek() is free, and whole blocks
+// are generated by running many counters side by side. The fills below work
+// on LANES counters at a time in structure-of-arrays form, which the compiler
+// turns into packed integer multiplies, and do the Gaussian transform with
+// Eigen's vectorized log/sin/cos.
+//
+// Every fill consumes ceil(n / 4) counters, so the position after a fill
+// depends only on how many values were drawn. Not thread-safe; give each
+// thread its own stream.
+class Philox4x32 {
+public:
+  using Counter = std::array<uint32_t, 4>;
+  using Key = std::array<uint32_t, 2>;
+
+  static constexpr int ROUNDS = 10;
+  static constexpr int LANES = 16; // counters per batch
+
+  explicit Philox4x32(uint64_t seed = 0, uint64_t stream = 0)
+      : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+        stream_(stream) {}
+
+  // The raw bijection: 10 rounds of Philox on one counter
+  static Counter encrypt(Counter ctr, Key key) {
+    for (int r = 0; r < ROUNDS; ++r) {
+      if (r > 0) {
+        key[0] += W0;
+        key[1] += W1;
+      }
+      const uint64_t p0 = uint64_t{M0} * ctr[0];
+      const uint64_t p1 = uint64_t{M1} * ctr[2];
+      ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+             static_cast<uint32_t>(p1),
+             static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+             static_cast<uint32_t>(p0)};
+    }
+    return ctr;
+  }
+
+  // Counter index of the next draw
+  uint64_t position() const { return position_; }
+  void seek(uint64_t position) { position_ = position; }
+  uint64_t stream() const { return stream_; }
+
+  // Four raw words for the next counter
+  Counter next() {
+    const Counter ctr{static_cast<uint32_t>(position_),
+                      static_cast<uint32_t>(position_ >> 32),
+                      static_cast<uint32_t>(stream_),
+                      static_cast<uint32_t>(stream_ >> 32)};
+    ++position_;
+    return encrypt(ctr, key_);
+  }
+
+  // Uniform floats in [lo, hi)
+  template <typename Derived>
+  void fillUniform(Eigen::DenseBase<Derived> &out, float lo = 0.0f,
+                   float hi = 1.0f) {
+    const float scale = (hi - lo) * 0x1p-24f;
+    fill_(out, [&](const Batch &b, float *dst, int n) {
+      for (int i = 0; i < n; ++i)
+        dst[i] = lo + static_cast<float>(b.words[i] >> 8) * scale;
+    });
+  }
+
+  // Gaussian floats N(mean, stddev^2) by the Box-Muller transform; each
+  // counter's four words give two pairs, i.e. four normals
+  template <typename Derived>
+  void fillNormal(Eigen::DenseBase<Derived> &out, float mean = 0.0f,
+                  float stddev = 1.0f) {
+    fill_(out, [&](const Batch &b, float *dst, int n) {
+      using Half = Eigen::Array<float, 2 * LANES, 1>;
+      Half u1, u2;
+      for (int p = 0; p < 2 * LANES; ++p) {
+        // u1 in (0, 1] so the log is finite
+        u1(p) = static_cast<float>((b.words[2 * p] >> 8) + 1) * 0x1p-24f;
+        u2(p) = static_cast<float>(b.words[2 * p + 1] >> 8) * 0x1p-24f;
+      }
+      const Half radius = stddev * (-2.0f * u1.log()).sqrt();
+      const Half theta = (2.0f * std::numbers::pi_v<float>) * u2;
+      const Half c = mean + radius * theta.cos();
+      const Half s = mean + radius * theta.sin();
+      for (int i = 0; i < n; ++i)
+        dst[i] = (i & 1) ? s(i >> 1) : c(i >> 1);
+    });
+  }
+
+private:
+  static constexpr uint32_t M0 = 0xD2511F53;
+  static constexpr uint32_t M1 = 0xCD9E8D57;
+  static constexpr uint32_t W0 = 0x9E3779B9; // golden ratio
+  static constexpr uint32_t W1 = 0xBB67AE85; // sqrt(3) - 1
+
+  // LANES counters' output, interleaved so words[4j + k] is word k of lane j
+  struct Batch {
+    alignas(64) uint32_t words[4 * LANES];
+  };
+
+  // Philox on LANES consecutive counters, one round at a time across all
+  // lanes so every step is a straight-line loop over arrays
+  void generate_(Batch &b) const {
+    alignas(64) uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+    for (int j = 0; j < LANES; ++j) {
+      const uint64_t pos = position_ + static_cast<uint64_t>(j);
+      c0[j] = static_cast<uint32_t>(pos);
+      c1[j] = static_cast<uint32_t>(pos >> 32);
+      c2[j] = static_cast<uint32_t>(stream_);
+      c3[j] = static_cast<uint32_t>(stream_ >> 32);
+    }
+    uint32_t k0 = key_[0], k1 = key_[1];
+    for (int r = 0; r < ROUNDS; ++r) {
+      if (r > 0) {
+        k0 += W0;
+        k1 += W1;
+      }
+      for (int j = 0; j < LANES; ++j) {
+        const uint64_t p0 = uint64_t{M0} * c0[j];
+        const uint64_t p1 = uint64_t{M1} * c2[j];
+        const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[j] ^ k0;
+        const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[j] ^ k1;
+        c1[j] = static_cast<uint32_t>(p1);
+        c3[j] = static_cast<uint32_t>(p0);
+        c0[j] = n0;
+        c2[j] = n2;
+      }
+    }
+    for (int j = 0; j < LANES; ++j) {
+      b.words[4 * j + 0] = c0[j];
+      b.words[4 * j + 1] = c1[j];
+      b.words[4 * j + 2] = c2[j];
+      b.words[4 * j + 3] = c3[j];
+    }
+  }
+
+  // Run `convert(batch, dst, n)` over `out` a batch at a time, advancing the
+  // position by the counters actually used
+  template <typename Derived, typename Convert>
+  void fill_(Eigen::DenseBase<Derived> &out, Convert &&convert) {
+    static_assert(std::is_same_v<typename Derived::Scalar, float>,
+                  "Philox4x32 fills float blocks");
+    constexpr int PER_BATCH = 4 * LANES;
+    const int total = static_cast<int>(out.size());
+    Batch b;
+    alignas(64) float tmp[PER_BATCH];
+    for (int done = 0; done < total; done += PER_BATCH) {
+      const int n = std::min(PER_BATCH, total - done);
+      generate_(b);
+      convert(b, tmp, n);
+      for (int i = 0; i < n; ++i)
+        out.derived().coeffRef(done + i) = tmp[i];
+      position_ += static_cast<uint64_t>((n + 3) / 4);
+    }
+  }
+
+  Key key_;
+  uint64_t stream_;
+  uint64_t position_ = 0;
+};
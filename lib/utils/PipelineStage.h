@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <semaphore>
+#include <thread>
+
+// One pipeline stage on a persistent worker thread, running one job ahead of
+// its consumer.
+//
+// The producer submit()s job k+1 while the consumer is still working on
+// result k; the worker computes it in the meantime, and the consumer's next
+// wait() usually finds it already done. Jobs run strictly in submission
+// order on the one worker, so a stage whose function carries state (e.g. a
+// convolution's delay line) gives exactly the result it would give if run
+// inline.
+//
+// Job and result slots are preallocated (two of each) and the handoffs are
+// semaphores: nothing allocates per job. Every submitted job must be
+// consumed by a wait() / release() pair, in order. Single producer, single
+// consumer (may be the same thread).
+//
+// The worker starts on the first submit(), so a stage that is never used
+// costs no thread.
+template <typename Job, typename Result> class PipelineStage {
+public:
+  using Fn = std::function<void(const Job &, Result &)>;
+
+  explicit PipelineStage(Fn fn) : fn_(std::move(fn)) {}
+
+  ~PipelineStage() {
+    if (!started())
+      return;
+    worker_.request_stop();
+    queued_.release();
+  }
+
+  PipelineStage(const PipelineStage &) = delete;
+  PipelineStage &operator=(const PipelineStage &) = delete;
+
+  // --- producer ---
+  // Queue `job` for the worker. Waits only if both slots are taken, i.e. the
+  // producer is two jobs ahead of the consumer.
+  void submit(const Job &job) {
+    if (!started())
+      worker_ = std::jthread([this](std::stop_token st) { run_(st); });
+    free_.acquire();
+    jobs_[submitted_ & 1] = job;
+    ++submitted_;
+    queued_.release();
+  }
+
+  // --- consumer ---
+  // Result of the oldest unreleased job, waiting for it if necessary. Stays
+  // valid until release().
+  const Result &wait() {
+    if (!done_.try_acquire()) {
+      stalls_.fetch_add(1, std::memory_order_relaxed);
+      done_.acquire();
+    }
+    return results_[taken_ & 1];
+  }
+
+  // Hand the slot of the result returned by wait() back to the producer
+  void release() {
+    ++taken_;
+    free_.release();
+  }
+
+  // wait() calls that found the result not ready yet
+  uint64_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+  // Whether the worker thread is running (producer side)
+  bool started() const { return worker_.joinable(); }
+
+private:
+  void run_(std::stop_token st) {
+    uint64_t completed = 0;
+    while (true) {
+      queued_.acquire();
+      if (st.stop_requested())
+        return;
+      fn_(jobs_[completed & 1], results_[completed & 1]);
+      ++completed;
+      done_.release();
+    }
+  }
+
+  Fn fn_;
+  Job jobs_[2]{};
+  Result results_[2]{};
+  uint64_t submitted_ = 0; // producer
+  uint64_t taken_ = 0;     // consumer
+
+  std::counting_semaphore<2> free_{2};
+  std::counting_semaphore<3> queued_{0}; // two jobs plus the stop wake-up
+  std::counting_semaphore<2> done_{0};
+  std::atomic<uint64_t> stalls_{0};
+
+  std::jthread worker_;
+};
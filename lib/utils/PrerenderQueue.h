@@ -0,0 +1,110 @@
+#pragma once
+
+#include "SPSCQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// Background producer that renders a sequence of blocks ahead of its
+// consumer.
+//
+// For data that does not depend on anything the consumer computes (e.g.
+// simulated noise), the render work can move off the consumer's critical
+// path entirely: a dedicated thread keeps up to Ahead blocks ready in a
+// wait-free SPSC ring, and pop() is a copy out of it. The producer sleeps
+// while the ring is more than half full, so it wakes once per Ahead / 2
+// blocks rather than once per block.
+//
+// Blocks come out in render order, so a deterministic render function gives
+// the same sequence no matter how the two threads are scheduled. pop() never
+// waits: if the consumer outruns the producer it counts an underrun and
+// returns false, and the caller substitutes something (e.g. silence) for
+// that block. Without start() there is no producer thread and pop() renders
+// on the calling thread, which is what a single-threaded (offline) consumer
+// wants. Single consumer thread.
+template <typename T, size_t Ahead> class PrerenderQueue {
+public:
+  using RenderFn = std::function<void(T &)>;
+
+  explicit PrerenderQueue(RenderFn render) : render_(std::move(render)) {}
+  ~PrerenderQueue() { stop(); }
+
+  PrerenderQueue(const PrerenderQueue &) = delete;
+  PrerenderQueue &operator=(const PrerenderQueue &) = delete;
+
+  // Start rendering. Separate from construction so the owner can finish
+  // setting up whatever the render function reads. Call before the first
+  // pop().
+  void start() {
+    started_ = true;
+    producer_ = std::jthread([this](std::stop_token st) { produce_(st); });
+  }
+
+  // Stop and join the producer. Blocks already rendered stay poppable.
+  void stop() {
+    if (!producer_.joinable())
+      return;
+    producer_.request_stop();
+    producer_.join();
+  }
+
+  // --- consumer ---
+  // Next block in render order into `out`. Never waits: returns false (and
+  // leaves `out` alone) if the producer has not rendered it yet. Renders in
+  // place if the producer was never started.
+  bool pop(T &out) {
+    if (!started_) {
+      render_(out);
+      return true;
+    }
+    if (!queue_.tryPop(out)) {
+      underruns_.fetch_add(1, std::memory_order_relaxed);
+      requestRefill_();
+      return false;
+    }
+    if (queue_.size() <= Ahead / 2)
+      requestRefill_();
+    return true;
+  }
+
+  // Blocks rendered and not yet popped
+  size_t ready() const { return queue_.size(); }
+  static constexpr size_t ahead() { return Ahead; }
+
+  // pop() calls that found nothing ready and returned false
+  uint64_t underruns() const {
+    return underruns_.load(std::memory_order_relaxed);
+  }
+
+private:
+  void requestRefill_() {
+    refill_.fetch_add(1, std::memory_order_release);
+    refill_.notify_one();
+  }
+
+  void produce_(std::stop_token st) {
+    std::stop_callback wake(st, [this] { requestRefill_(); });
+
+    T block{};
+    while (!st.stop_requested()) {
+      // Read before filling: a refill request made while we fill makes the
+      // wait below return at once instead of being lost
+      const uint32_t seen = refill_.load(std::memory_order_acquire);
+      while (queue_.size() < Ahead && !st.stop_requested()) {
+        render_(block);
+        queue_.push(block);
+      }
+      refill_.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  RenderFn render_;
+  SPSCQueue<T, Ahead> queue_;
+  std::atomic<uint32_t> refill_{0};
+  std::atomic<uint64_t> underruns_{0};
+  bool started_ = false; // set before the consumer starts popping
+  std::jthread producer_;
+};
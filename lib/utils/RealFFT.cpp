@@ -0,0 +1,391 @@
+// Backends for RealFFT (see RealFFT.h).
+//
+// The Split backend computes an n-point real transform with one n/2-point
+// complex transform: the even samples go to the real parts and the odd ones
+// to the imaginary parts, and a final pass untangles the two spectra. The
+// complex transform is an iterative radix-2 decimation in time on separate
+// re[] / im[] arrays; the packing step writes straight into bit-reversed
+// order, the first two stages are fused, and every later stage is a
+// contiguous butterfly loop over one twiddle table, which vectorizes.
+#include "RealFFT.h"
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+
+#ifndef DSP_FFT_BACKEND
+#define DSP_FFT_BACKEND "split"
+#endif
+
+namespace fft {
+
+struct SplitPlan {
+  int n = 0; // real size
+  int m = 0; // complex size n/2
+  std::vector<int> bitrev;
+  // Stage with half size h uses entries [h, 2h): e^{-i pi j / h}, j < h
+  std::vector<float> twr, twi;
+  // Untangling twiddles e^{-2 pi i k / n}, k < m
+  std::vector<float> wr, wi;
+};
+
+namespace {
+
+std::atomic<Backend> g_default{parseBackend(DSP_FFT_BACKEND)};
+
+std::shared_ptr<const SplitPlan> makePlan(int n) {
+  auto plan = std::make_shared<SplitPlan>();
+  const int m = n / 2;
+  plan->n = n;
+  plan->m = m;
+
+  plan->bitrev.resize(m);
+  const int bits = std::countr_zero(static_cast<unsigned>(m));
+  for (int i = 0; i < m; ++i) {
+    int r = 0;
+    for (int b = 0; b < bits; ++b)
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    plan->bitrev[i] = r;
+  }
+
+  plan->twr.assign(m, 0.0f);
+  plan->twi.assign(m, 0.0f);
+  for (int h = 1; h < m; h *= 2) {
+    for (int j = 0; j < h; ++j) {
+      const double a = -std::numbers::pi * j / h;
+      plan->twr[h + j] = static_cast<float>(std::cos(a));
+      plan->twi[h + j] = static_cast<float>(std::sin(a));
+    }
+  }
+
+  plan->wr.resize(m);
+  plan->wi.resize(m);
+  for (int k = 0; k < m; ++k) {
+    const double a = -2.0 * std::numbers::pi * k / n;
+    plan->wr[k] = static_cast<float>(std::cos(a));
+    plan->wi[k] = static_cast<float>(std::sin(a));
+  }
+  return plan;
+}
+
+// In-place forward complex FFT of p.m points held in bit-reversed order
+void complexForward(const SplitPlan &p, float *re, float *im) {
+  const int m = p.m;
+
+  // Stages h = 1 and h = 2 as one radix-4 pass (twiddles 1 and -i)
+  for (int s = 0; s < m; s += 4) {
+    const float b0r = re[s] + re[s + 1], b0i = im[s] + im[s + 1];
+    const float b1r = re[s] - re[s + 1], b1i = im[s] - im[s + 1];
+    const float b2r = re[s + 2] + re[s + 3], b2i = im[s + 2] + im[s + 3];
+    const float b3r = re[s + 2] - re[s + 3], b3i = im[s + 2] - im[s + 3];
+    re[s] = b0r + b2r;
+    im[s] = b0i + b2i;
+    re[s + 2] = b0r - b2r;
+    im[s + 2] = b0i - b2i;
+    re[s + 1] = b1r + b3i; // b1 + (-i) b3
+    im[s + 1] = b1i - b3r;
+    re[s + 3] = b1r - b3i;
+    im[s + 3] = b1i + b3r;
+  }
+
+  for (int h = 4; h < m; h *= 2) {
+    const float *__restrict wr = p.twr.data() + h;
+    const float *__restrict wi = p.twi.data() + h;
+    for (int s = 0; s < m; s += 2 * h) {
+      float *__restrict ar = re + s;
+      float *__restrict ai = im + s;
+      float *__restrict br = re + s + h;
+      float *__restrict bi = im + s + h;
+      for (int j = 0; j < h; ++j) {
+        const float tr = br[j] * wr[j] - bi[j] * wi[j];
+        const float ti = br[j] * wi[j] + bi[j] * wr[j];
+        br[j] = ar[j] - tr;
+        bi[j] = ai[j] - ti;
+        ar[j] = ar[j] + tr;
+        ai[j] = ai[j] + ti;
+      }
+    }
+  }
+}
+
+void splitForward(const SplitPlan &p, float *re, float *im,
+                  std::complex<float> *dst, const float *src) {
+  const int m = p.m;
+  for (int j = 0; j < m; ++j) {
+    re[p.bitrev[j]] = src[2 * j];
+    im[p.bitrev[j]] = src[2 * j + 1];
+  }
+  complexForward(p, re, im);
+
+  // X[k] = E[k] + W^k O[k], with E = (Z[k] + conj Z[m-k]) / 2 and
+  // O = (Z[k] - conj Z[m-k]) / 2i
+  dst[0] = {re[0] + im[0], 0.0f};
+  dst[m] = {re[0] - im[0], 0.0f};
+  for (int k = 1; k < m; ++k) {
+    const float zr = re[k], zi = im[k];
+    const float cr = re[m - k], ci = -im[m - k];
+    const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+    const float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+    dst[k] = {er + p.wr[k] * or_ - p.wi[k] * oi,
+              ei + p.wr[k] * oi + p.wi[k] * or_};
+  }
+}
+
+void splitInverse(const SplitPlan &p, float *re, float *im, float *dst,
+                  const std::complex<float> *src) {
+  const int m = p.m;
+  // Z[k] = E[k] + i O[k] with E = X[k] + conj X[m-k] and
+  // O = (X[k] - conj X[m-k]) conj(W^k) (both doubled; folded into the
+  // final 1/n). The inverse runs as a forward transform with re and im
+  // swapped, so Z is stored swapped.
+  for (int k = 0; k < m; ++k) {
+    const std::complex<float> x = src[k];
+    const std::complex<float> c = std::conj(src[m - k]);
+    const float er = x.real() + c.real(), ei = x.imag() + c.imag();
+    const float dr = x.real() - c.real(), di = x.imag() - c.imag();
+    const float or_ = dr * p.wr[k] + di * p.wi[k];
+    const float oi = di * p.wr[k] - dr * p.wi[k];
+    const int r = p.bitrev[k];
+    im[r] = er - oi; // Re Z
+    re[r] = ei + or_; // Im Z
+  }
+  complexForward(p, re, im);
+
+  const float scale = 1.0f / static_cast<float>(p.n);
+  for (int j = 0; j < m; ++j) {
+    dst[2 * j] = im[j] * scale;
+    dst[2 * j + 1] = re[j] * scale;
+  }
+}
+
+// complexForward() on `L` lanes: element i of lane l at [i * L + l]
+void complexForwardBatch(const SplitPlan &p, int L, float *re, float *im) {
+  const int m = p.m;
+
+  for (int s = 0; s < m; s += 4) {
+    float *__restrict r0 = re + s * L, *__restrict i0 = im + s * L;
+    float *__restrict r1 = r0 + L, *__restrict i1 = i0 + L;
+    float *__restrict r2 = r1 + L, *__restrict i2 = i1 + L;
+    float *__restrict r3 = r2 + L, *__restrict i3 = i2 + L;
+    for (int l = 0; l < L; ++l) {
+      const float b0r = r0[l] + r1[l], b0i = i0[l] + i1[l];
+      const float b1r = r0[l] - r1[l], b1i = i0[l] - i1[l];
+      const float b2r = r2[l] + r3[l], b2i = i2[l] + i3[l];
+      const float b3r = r2[l] - r3[l], b3i = i2[l] - i3[l];
+      r0[l] = b0r + b2r;
+      i0[l] = b0i + b2i;
+      r2[l] = b0r - b2r;
+      i2[l] = b0i - b2i;
+      r1[l] = b1r + b3i;
+      i1[l] = b1i - b3r;
+      r3[l] = b1r - b3i;
+      i3[l] = b1i + b3r;
+    }
+  }
+
+  for (int h = 4; h < m; h *= 2) {
+    for (int s = 0; s < m; s += 2 * h) {
+      for (int j = 0; j < h; ++j) {
+        const float wr = p.twr[h + j], wi = p.twi[h + j];
+        float *__restrict ar = re + (s + j) * L;
+        float *__restrict ai = im + (s + j) * L;
+        float *__restrict br = re + (s + j + h) * L;
+        float *__restrict bi = im + (s + j + h) * L;
+        for (int l = 0; l < L; ++l) {
+          const float tr = br[l] * wr - bi[l] * wi;
+          const float ti = br[l] * wi + bi[l] * wr;
+          br[l] = ar[l] - tr;
+          bi[l] = ai[l] - ti;
+          ar[l] = ar[l] + tr;
+          ai[l] = ai[l] + ti;
+        }
+      }
+    }
+  }
+}
+
+// splitForward() on `L` lanes, with a split output
+void batchForward(const SplitPlan &p, int L, float *re, float *im,
+                  float *dst, int stride, const float *src) {
+  const int m = p.m;
+  for (int j = 0; j < m; ++j) {
+    const int r = p.bitrev[j] * L;
+    for (int l = 0; l < L; ++l) {
+      re[r + l] = src[2 * j * L + l];
+      im[r + l] = src[(2 * j + 1) * L + l];
+    }
+  }
+  complexForwardBatch(p, L, re, im);
+
+  float *__restrict dr = dst;
+  float *__restrict di = dst + stride;
+  for (int l = 0; l < L; ++l) {
+    dr[l] = re[l] + im[l];
+    di[l] = 0.0f;
+    dr[m * L + l] = re[l] - im[l];
+    di[m * L + l] = 0.0f;
+  }
+  for (int k = 1; k < m; ++k) {
+    const float wr = p.wr[k], wi = p.wi[k];
+    const float *z_r = re + k * L, *z_i = im + k * L;
+    const float *c_r = re + (m - k) * L, *c_i = im + (m - k) * L;
+    for (int l = 0; l < L; ++l) {
+      const float zr = z_r[l], zi = z_i[l];
+      const float cr = c_r[l], ci = -c_i[l];
+      const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+      const float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+      dr[k * L + l] = er + wr * or_ - wi * oi;
+      di[k * L + l] = ei + wr * oi + wi * or_;
+    }
+  }
+}
+
+// splitInverse() on `L` lanes
+void batchInverse(const SplitPlan &p, int L, float *re, float *im,
+                  float *dst, const std::complex<float> *src) {
+  const int m = p.m;
+  for (int k = 0; k < m; ++k) {
+    const float wr = p.wr[k], wi = p.wi[k];
+    const float *x = reinterpret_cast<const float *>(src + k * L);
+    const float *c = reinterpret_cast<const float *>(src + (m - k) * L);
+    float *__restrict zi = im + p.bitrev[k] * L;
+    float *__restrict zr = re + p.bitrev[k] * L;
+    for (int l = 0; l < L; ++l) {
+      const float xr = x[2 * l], xi = x[2 * l + 1];
+      const float cr = c[2 * l], ci = -c[2 * l + 1];
+      const float er = xr + cr, ei = xi + ci;
+      const float dr = xr - cr, di = xi - ci;
+      const float or_ = dr * wr + di * wi;
+      const float oi = di * wr - dr * wi;
+      zi[l] = er - oi;
+      zr[l] = ei + or_;
+    }
+  }
+  complexForwardBatch(p, L, re, im);
+
+  const float scale = 1.0f / static_cast<float>(p.n);
+  for (int j = 0; j < m; ++j) {
+    for (int l = 0; l < L; ++l) {
+      dst[2 * j * L + l] = im[j * L + l] * scale;
+      dst[(2 * j + 1) * L + l] = re[j * L + l] * scale;
+    }
+  }
+}
+
+} // namespace
+
+const char *backendName(Backend backend) {
+  switch (backend) {
+  case Backend::Kiss:
+    return "kiss";
+  case Backend::Split:
+    return "split";
+  }
+  return "?";
+}
+
+Backend parseBackend(std::string_view name) {
+  if (name == "kiss")
+    return Backend::Kiss;
+  if (name == "split")
+    return Backend::Split;
+  throw std::invalid_argument("unknown FFT backend '" + std::string(name) +
+                              "' (supported: kiss, split)");
+}
+
+Backend defaultBackend() { return g_default.load(std::memory_order_relaxed); }
+
+void setDefaultBackend(Backend backend) {
+  g_default.store(backend, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const SplitPlan> splitPlan(int n) {
+  assert(n >= 8 && std::has_single_bit(static_cast<unsigned>(n)));
+  static std::mutex mutex;
+  static std::map<int, std::shared_ptr<const SplitPlan>> plans;
+  std::lock_guard lock(mutex);
+  auto &plan = plans[n];
+  if (!plan)
+    plan = makePlan(n);
+  return plan;
+}
+
+RealFFT::RealFFT(int n, Backend backend) : n_(n) {
+  if (backend == Backend::Split && n >= 8 &&
+      std::has_single_bit(static_cast<unsigned>(n))) {
+    plan_ = splitPlan(n);
+    re_.assign(n / 2, 0.0f);
+    im_.assign(n / 2, 0.0f);
+  } else {
+    kiss_.SetFlag(Eigen::FFT<float>::HalfSpectrum);
+  }
+}
+
+void RealFFT::fwd(std::complex<float> *dst, const float *src) {
+  if (plan_)
+    splitForward(*plan_, re_.data(), im_.data(), dst, src);
+  else
+    kiss_.fwd(dst, src, n_);
+}
+
+void RealFFT::inv(float *dst, const std::complex<float> *src) {
+  if (plan_)
+    splitInverse(*plan_, re_.data(), im_.data(), dst, src);
+  else
+    kiss_.inv(dst, src, n_);
+}
+
+BatchedRealFFT::BatchedRealFFT(int n, int lanes, Backend backend)
+    : n_(n), lanes_(lanes) {
+  const int m = n / 2;
+  if (backend == Backend::Split && lanes >= kMinBatchLanes && n >= 8 &&
+      std::has_single_bit(static_cast<unsigned>(n))) {
+    plan_ = splitPlan(n);
+    re_.assign(static_cast<size_t>(m) * lanes, 0.0f);
+    im_.assign(static_cast<size_t>(m) * lanes, 0.0f);
+  } else {
+    single_ = RealFFT(n, backend);
+    lane_.assign(n, 0.0f);
+    bins_.assign(m + 1, 0.0f);
+  }
+}
+
+void BatchedRealFFT::fwd(float *dst, int stride, const float *src) {
+  if (plan_) {
+    batchForward(*plan_, lanes_, re_.data(), im_.data(), dst, stride, src);
+    return;
+  }
+  const int L = lanes_;
+  for (int l = 0; l < L; ++l) {
+    for (int t = 0; t < n_; ++t)
+      lane_[t] = src[t * L + l];
+    single_.fwd(bins_.data(), lane_.data());
+    for (int k = 0; k < bins(); ++k) {
+      dst[k * L + l] = bins_[k].real();
+      dst[stride + k * L + l] = bins_[k].imag();
+    }
+  }
+}
+
+void BatchedRealFFT::inv(float *dst, const std::complex<float> *src) {
+  if (plan_) {
+    batchInverse(*plan_, lanes_, re_.data(), im_.data(), dst, src);
+    return;
+  }
+  const int L = lanes_;
+  for (int l = 0; l < L; ++l) {
+    for (int k = 0; k < bins(); ++k)
+      bins_[k] = src[k * L + l];
+    single_.inv(lane_.data(), bins_.data());
+    for (int t = 0; t < n_; ++t)
+      dst[t * L + l] = lane_[t];
+  }
+}
+
+} // namespace fft
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <unsupported/Eigen/FFT>
+
+// Real-input FFT with a selectable backend, used by every convolution engine.
+//
+// RealFFT(n) transforms n real samples to the n/2+1 bin half spectrum and
+// back, with Eigen::FFT's HalfSpectrum conventions (forward unscaled, inverse
+// scaled by 1/n), so the backends are interchangeable. They round
+// differently, so their outputs agree within float rounding, not bit for bit:
+//
+//   Kiss   Eigen::FFT (kissfft). Any n. Plans live inside each instance,
+//          because kissfft transforms write to plan-owned scratch.
+//   Split  In-tree radix-2 transform on split (re[] / im[]) arrays, which
+//          the compiler vectorizes. Power-of-two n >= 8; other sizes fall
+//          back to Kiss. Its plan (twiddles and bit-reversal table) is
+//          immutable and shared by every instance of the same size in the
+//          process; instances only own their scratch.
+//
+// The backend is fixed when a RealFFT is constructed. The default comes from
+// the DSP_FFT_BACKEND build option and can be changed at run time with
+// setDefaultBackend() before the engines are built.
+namespace fft {
+
+enum class Backend { Kiss, Split };
+
+const char *backendName(Backend backend);
+
+// "kiss" or "split"; throws std::invalid_argument for anything else
+Backend parseBackend(std::string_view name);
+
+Backend defaultBackend();
+void setDefaultBackend(Backend backend);
+
+// Twiddles and permutation for one Split transform size
+struct SplitPlan;
+
+// Process-wide plan for real size n (created on first request; thread-safe,
+// not real-time safe)
+std::shared_ptr<const SplitPlan> splitPlan(int n);
+
+class RealFFT {
+public:
+  // Empty transform; assign a sized one before use
+  RealFFT() = default;
+
+  explicit RealFFT(int n, Backend backend = defaultBackend());
+
+  int size() const { return n_; }
+  int bins() const { return n_ / 2 + 1; }
+
+  // Backend actually in use (Kiss for sizes Split cannot do)
+  Backend backend() const { return plan_ ? Backend::Split : Backend::Kiss; }
+
+  // Shared plan of a Split transform (nullptr for Kiss), for inspection
+  const SplitPlan *plan() const { return plan_.get(); }
+
+  // n real samples -> n/2+1 bins
+  void fwd(std::complex<float> *dst, const float *src);
+
+  // n/2+1 bins -> n real samples, scaled by 1/n
+  void inv(float *dst, const std::complex<float> *src);
+
+private:
+  int n_ = 0;
+  std::shared_ptr<const SplitPlan> plan_;
+  std::vector<float> re_, im_; // Split scratch
+  Eigen::FFT<float> kiss_;
+};
+
+// RealFFT of `lanes` signals at once, in channel-interleaved (SoA) layout:
+// sample t of lane l is src[t * lanes + l], and bin k of lane l is element
+// k * lanes + l of the spectrum. With the Split backend every butterfly
+// becomes a loop over the lanes, which vectorizes across channels however
+// short the transform, using the same plans and the same arithmetic per lane
+// as RealFFT. Below kMinBatchLanes lanes, where those loops are too short to
+// fill a vector, and for sizes or backends Split does not cover, each lane
+// is gathered and run through a RealFFT of its own instead.
+class BatchedRealFFT {
+public:
+  static constexpr int kMinBatchLanes = 4;
+
+  BatchedRealFFT() = default;
+  BatchedRealFFT(int n, int lanes, Backend backend = defaultBackend());
+
+  int size() const { return n_; }
+  int bins() const { return n_ / 2 + 1; }
+  int lanes() const { return lanes_; }
+
+  // True if the lanes are transformed together (otherwise one by one)
+  bool batched() const { return plan_ != nullptr; }
+
+  // n x lanes real samples -> bins x lanes spectrum, written split: real
+  // parts at dst[0 ..], imaginary parts at dst[stride ..] (as ComplexMac.h)
+  void fwd(float *dst, int stride, const float *src);
+
+  // bins x lanes interleaved complex spectrum -> n x lanes samples, scaled
+  // by 1/n
+  void inv(float *dst, const std::complex<float> *src);
+
+private:
+  int n_ = 0;
+  int lanes_ = 0;
+  std::shared_ptr<const SplitPlan> plan_;
+  std::vector<float> re_, im_; // (n/2) x lanes scratch
+  RealFFT single_;             // lane by lane otherwise
+  std::vector<float> lane_;
+  std::vector<std::complex<float>> bins_;
+};
+
+} // namespace fft
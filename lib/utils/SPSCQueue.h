@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Wait-free single-producer / single-consumer FIFO.
+//
+// Unlike RingBuffer, a full queue never overwrites: the new element is
+// dropped and counted as an overrun, so the consumer only ever sees whole,
+// in-order elements and the producer can tell that data was lost. Head and
+// tail live on separate cache lines, and each side keeps a cached copy of the
+// other's index so the shared line is only touched when the cached view runs
+// out.
+//
+// The consumer can block in waitFor() until something is pushed. On Linux the
+// wake-up is a futex; the producer only issues it when the consumer has
+// announced it is about to sleep, so a push to an awake consumer costs no
+// system call.
+template <typename T, size_t Capacity> class SPSCQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "SPSCQueue capacity must be a power of two");
+
+public:
+  static constexpr size_t MASK = Capacity - 1;
+
+  // --- producer ---
+  bool push(const T &v) { return push_(v); }
+  bool push(T &&v) { return push_(std::move(v)); }
+
+  // --- consumer ---
+  // Oldest element, or nullptr if empty
+  const T *front() {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == tailCache_) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (head == tailCache_)
+        return nullptr;
+    }
+    return &buffer_[head & MASK];
+  }
+
+  // Release the element returned by front()
+  void pop() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  // Moves the element out, so the slot does not keep anything it owns (e.g.
+  // a pool handle) alive until it is overwritten
+  bool tryPop(T &out) {
+    if (!front())
+      return false;
+    out = std::move(buffer_[head_.load(std::memory_order_relaxed) & MASK]);
+    pop();
+    return true;
+  }
+
+  // Block until the queue is non-empty, wake() is called or `timeout`
+  // passes. Returns false if the queue is still empty.
+  bool waitFor(std::chrono::nanoseconds timeout) {
+    const uint32_t key = signal_.load(std::memory_order_acquire);
+    sleeping_.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in wakeConsumer_(): either we see the new tail
+    // here, or the producer sees that we are going to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (empty_())
+      sleep_(key, timeout);
+    sleeping_.store(false, std::memory_order_relaxed);
+    return !empty_();
+  }
+
+  // Wake a consumer blocked in waitFor() (e.g. for shutdown). Any thread.
+  void wake() {
+    signal_.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&signal_),
+            FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+  }
+
+  // --- either side ---
+  size_t size() const {
+    return static_cast<size_t>(tail_.load(std::memory_order_acquire) -
+                               head_.load(std::memory_order_acquire));
+  }
+  static constexpr size_t capacity() { return Capacity; }
+
+  // Elements dropped because the queue was full
+  uint64_t overruns() const {
+    return overruns_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+  template <typename U> bool push_(U &&v) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - headCache_ == Capacity) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail - headCache_ == Capacity) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    buffer_[tail & MASK] = std::forward<U>(v);
+    tail_.store(tail + 1, std::memory_order_release);
+    wakeConsumer_();
+    return true;
+  }
+
+  bool empty_() const {
+    return tail_.load(std::memory_order_acquire) ==
+           head_.load(std::memory_order_relaxed);
+  }
+
+  void wakeConsumer_() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed))
+      wake();
+  }
+
+  void sleep_(uint32_t key, std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+    const auto s = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts{static_cast<time_t>(s.count()),
+                static_cast<long>((timeout - s).count())};
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&signal_),
+            FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+#else
+    // Portable fallback: short sleeps until woken or timed out
+    const auto until = std::chrono::steady_clock::now() + timeout;
+    while (signal_.load(std::memory_order_acquire) == key && empty_() &&
+           std::chrono::steady_clock::now() < until)
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+  }
+
+  std::array<T, Capacity> buffer_;
+
+  // Producer line
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  uint64_t headCache_ = 0;
+  std::atomic<uint64_t> overruns_{0};
+
+  // Consumer line
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t tailCache_ = 0;
+
+  // Wake-up line, touched by the producer on every push
+  alignas(64) std::atomic<bool> sleeping_{false};
+  std::atomic<uint32_t> signal_{0};
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Latest-value channel between one writer and one reader (triple buffer).
+//
+// Three slots: the writer owns one (back), the reader owns one (front), and
+// the third (middle) holds the most recently published value. Publishing
+// swaps back and middle; reading a new value swaps middle and front. Each
+// swap is a single atomic exchange, so neither side ever waits or retries,
+// and since nobody touches a slot the other side owns, a read can never see
+// a half-written value. Unlike a seqlock, the reader gets the value without
+// a speculative copy, so T may own resources (e.g. refcounted handles).
+//
+// Drop-in for DoubleBufferSPSC. The reader may also use the value in place
+// through acquire(); it stays valid until the reader's next read.
+template <typename T> class TripleBuffer {
+public:
+  TripleBuffer() = default;
+
+  // --- writer ---
+  void publish(const T &value) {
+    beginWrite() = value;
+    commit();
+  }
+  void publish(T &&value) {
+    beginWrite() = std::move(value);
+    commit();
+  }
+
+  // Slot to fill in place; nothing is visible until commit()
+  T &beginWrite() { return slots_[back_].value; }
+
+  void commit() {
+    slots_[back_].seq = ++written_;
+    const uint32_t old =
+        middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+    back_ = old & kIndex;
+    seq_.store(written_, std::memory_order_release);
+  }
+
+  // --- reader ---
+  // Latest value if one was published since the last read, in place
+  const T *acquire() {
+    if (!takeFresh_())
+      return nullptr;
+    return &slots_[front_].value;
+  }
+
+  bool tryRead(T &out) {
+    const T *v = acquire();
+    if (!v)
+      return false;
+    out = *v;
+    return true;
+  }
+
+  // Latest value, new or not (default-constructed T before any publish)
+  void readLatest(T &out) {
+    takeFresh_();
+    out = slots_[front_].value;
+  }
+
+  bool hasNew() const {
+    return (middle_.load(std::memory_order_acquire) & kFresh) != 0;
+  }
+
+  // --- either side ---
+  // Number of values published so far
+  uint64_t sequence() const { return seq_.load(std::memory_order_acquire); }
+
+  // Sequence number of the value the reader holds (0: none yet). Reader only.
+  uint64_t readSequence() const { return slots_[front_].seq; }
+
+private:
+  static constexpr uint32_t kIndex = 0x3;
+  static constexpr uint32_t kFresh = 0x4;
+
+  bool takeFresh_() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0)
+      return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    return true;
+  }
+
+  struct alignas(64) Slot {
+    T value{};
+    uint64_t seq = 0;
+  };
+  Slot slots_[3];
+
+  // Writer line
+  alignas(64) uint32_t back_ = 0;
+  uint64_t written_ = 0;
+
+  // Reader line
+  alignas(64) uint32_t front_ = 1;
+
+  // Shared line
+  alignas(64) std::atomic<uint32_t> middle_{2};
+  std::atomic<uint64_t> seq_{0};
+};
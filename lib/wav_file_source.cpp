@@ -4,11 +4,17 @@
 #include <iostream>
 #include <stdexcept>
 
-WavFileSource::WavFileSource(const Config &config) : config_(config) {}
+template <typename DspConfig>
+BasicWavFileSource<DspConfig>::BasicWavFileSource(const Config &config)
+    : config_(config) {}
 
-WavFileSource::~WavFileSource() { close(); }
+template <typename DspConfig>
+BasicWavFileSource<DspConfig>::~BasicWavFileSource() {
+  close();
+}
 
-void WavFileSource::open(AudioCallback callback) {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::open(AudioCallback callback) {
   callback_ = std::move(callback);
 
   // Read and buffer entire WAV file
@@ -40,23 +46,27 @@ void WavFileSource::open(AudioCallback callback) {
             << std::endl;
 }
 
-void WavFileSource::start() {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::start() {
   if (running_.load())
     return;
 
   running_.store(true);
   currentSample_ = 0;
-  processThread_ = std::thread(&WavFileSource::processThread, this);
+  primed_ = false;
+  processThread_ = std::thread(&BasicWavFileSource::processThread, this);
 }
 
-void WavFileSource::stop() {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::stop() {
   running_.store(false);
   if (processThread_.joinable()) {
     processThread_.join();
   }
 }
 
-void WavFileSource::close() {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::close() {
   stop();
 
   if (outputFile_.is_open()) {
@@ -69,41 +79,19 @@ void WavFileSource::close() {
   audioBuffer_.shrink_to_fit();
 }
 
-void WavFileSource::processThread() {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::processThread() {
   const auto blockDuration =
-      std::chrono::microseconds((dsp::BLOCK_SIZE * 1000000) / sampleRate_);
-
-  Block inputBlock;
-  Block outputBlock;
+      std::chrono::microseconds((DspConfig::BLOCK_SIZE * 1000000) /
+                                sampleRate_);
 
   while (running_.load()) {
     auto startTime = std::chrono::steady_clock::now();
 
-    // Read a block from pre-buffered audio
-    if (!readBlock(inputBlock)) {
-      if (config_.loop) {
-        // Loop back to start
-        currentSample_ = 0;
-        if (!readBlock(inputBlock)) {
-          running_.store(false);
-          break;
-        }
-      } else {
-        // End of file
-        running_.store(false);
-        break;
-      }
-    }
-
-    // Process through callback
-    outputBlock.setZero();
-    if (callback_) {
-      callback_(inputBlock, outputBlock);
-    }
-
-    // Write output if configured
-    if (outputFile_.is_open()) {
-      writeBlock(outputBlock);
+    if (!processBlock()) {
+      // End of file
+      running_.store(false);
+      break;
     }
 
     // Simulate real-time by sleeping
@@ -115,7 +103,61 @@ void WavFileSource::processThread() {
   }
 }
 
-bool WavFileSource::readWavFile() {
+template <typename DspConfig>
+bool BasicWavFileSource<DspConfig>::setLookahead(LookaheadCallback lookahead) {
+  lookahead_ = std::move(lookahead);
+  primed_ = false;
+  return true;
+}
+
+template <typename DspConfig>
+bool BasicWavFileSource<DspConfig>::readNextBlock(Block &block) {
+  if (readBlock(block))
+    return true;
+  if (!config_.loop)
+    return false;
+  // Loop back to start
+  currentSample_ = 0;
+  return readBlock(block);
+}
+
+template <typename DspConfig>
+bool BasicWavFileSource<DspConfig>::processBlock() {
+  // Read a block from pre-buffered audio
+  if (lookahead_) {
+    // The whole file is in memory, so the next block can be announced
+    // before this one is processed
+    if (!primed_) {
+      haveNext_ = readNextBlock(nextBlock_);
+      if (haveNext_)
+        lookahead_(nextBlock_);
+      primed_ = true;
+    }
+    if (!haveNext_)
+      return false;
+    inputBlock_ = nextBlock_;
+    haveNext_ = readNextBlock(nextBlock_);
+    if (haveNext_)
+      lookahead_(nextBlock_);
+  } else if (!readNextBlock(inputBlock_)) {
+    return false;
+  }
+
+  // Process through callback
+  outputBlock_.setZero();
+  if (callback_) {
+    callback_(inputBlock_, outputBlock_);
+  }
+
+  // Write output if configured
+  if (outputFile_.is_open()) {
+    writeBlock(outputBlock_);
+  }
+  return true;
+}
+
+template <typename DspConfig>
+bool BasicWavFileSource<DspConfig>::readWavFile() {
   std::ifstream file(config_.inputPath, std::ios::binary);
   if (!file.is_open()) {
     std::cerr << "Failed to open WAV file: " << config_.inputPath << std::endl;
@@ -231,13 +273,14 @@ bool WavFileSource::readWavFile() {
   return true;
 }
 
-bool WavFileSource::readBlock(Block &block) {
+template <typename DspConfig>
+bool BasicWavFileSource<DspConfig>::readBlock(Block &block) {
   block.setZero();
 
   if (audioBuffer_.empty() || currentSample_ >= audioBuffer_.size())
     return false;
 
-  for (int i = 0; i < dsp::BLOCK_SIZE; ++i) {
+  for (int i = 0; i < static_cast<int>(DspConfig::BLOCK_SIZE); ++i) {
     if (currentSample_ < audioBuffer_.size()) {
       block(i) = audioBuffer_[currentSample_++];
     } else {
@@ -248,7 +291,8 @@ bool WavFileSource::readBlock(Block &block) {
   return true;
 }
 
-void WavFileSource::writeWavHeader() {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::writeWavHeader() {
   // Write placeholder header - will be updated in finalizeWavOutput
   char header[44] = {0};
 
@@ -265,7 +309,7 @@ void WavFileSource::writeWavHeader() {
   std::memcpy(header + 20, &audioFormat, 2);
   uint16_t channels = 1;
   std::memcpy(header + 22, &channels, 2);
-  uint32_t sampleRate = dsp::SAMPLE_RATE;
+  uint32_t sampleRate = DspConfig::SAMPLE_RATE;
   std::memcpy(header + 24, &sampleRate, 4);
   uint32_t byteRate = sampleRate * channels * sizeof(float);
   std::memcpy(header + 28, &byteRate, 4);
@@ -281,19 +325,21 @@ void WavFileSource::writeWavHeader() {
   outputFile_.write(header, 44);
 }
 
-void WavFileSource::writeBlock(const Block &block) {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::writeBlock(const Block &block) {
   float maxVal = block.cwiseAbs().maxCoeff();
   if (samplesWritten_ == 0) {
     std::cout << "  First block max amplitude: " << maxVal << std::endl;
   }
-  for (int i = 0; i < dsp::BLOCK_SIZE; ++i) {
+  for (int i = 0; i < static_cast<int>(DspConfig::BLOCK_SIZE); ++i) {
     float sample = block(i);
     outputFile_.write(reinterpret_cast<const char *>(&sample), sizeof(float));
   }
-  samplesWritten_ += dsp::BLOCK_SIZE;
+  samplesWritten_ += DspConfig::BLOCK_SIZE;
 }
 
-void WavFileSource::finalizeWavOutput() {
+template <typename DspConfig>
+void BasicWavFileSource<DspConfig>::finalizeWavOutput() {
   if (!outputFile_.is_open())
     return;
 
@@ -311,6 +357,9 @@ void WavFileSource::finalizeWavOutput() {
   std::cout << "WAV output written: " << config_.outputPath << std::endl;
   std::cout << "  Samples: " << samplesWritten_ << std::endl;
   std::cout << "  Duration: "
-            << (samplesWritten_ / static_cast<float>(dsp::SAMPLE_RATE))
+            << (samplesWritten_ / static_cast<float>(DspConfig::SAMPLE_RATE))
             << " seconds" << std::endl;
 }
+
+#define INSTANTIATE_WAV_FILE_SOURCE(C) template class BasicWavFileSource<C>;
+DSP_FOR_EACH_CONFIG(INSTANTIATE_WAV_FILE_SOURCE)
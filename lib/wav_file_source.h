@@ -9,22 +9,32 @@
 
 /**
  * @brief WAV file audio source - pre-buffers entire file in heap memory
+ *
+ * Instantiated for the configurations in dsp::dispatchBlockSize().
  */
-class WavFileSource : public AudioSource {
+template <typename DspConfig = dsp::DefaultConfig>
+class BasicWavFileSource : public BasicAudioSource<DspConfig> {
 public:
+  using Block = typename DspConfig::Block;
+  using AudioCallback = typename BasicAudioSource<DspConfig>::AudioCallback;
+  using LookaheadCallback =
+      typename BasicAudioSource<DspConfig>::LookaheadCallback;
+
   struct Config {
     std::string inputPath;
     std::string outputPath; // Empty = no output
     bool loop = false;
   };
 
-  explicit WavFileSource(const Config &config);
-  ~WavFileSource() override;
+  explicit BasicWavFileSource(const Config &config);
+  ~BasicWavFileSource() override;
 
   void open(AudioCallback callback) override;
   void start() override;
   void stop() override;
   void close() override;
+  bool setLookahead(LookaheadCallback lookahead) override;
+  bool processBlock() override;
   bool isRunning() const override { return running_.load(); }
   int getSampleRate() const override { return sampleRate_; }
 
@@ -32,6 +42,7 @@ private:
   void processThread();
   bool readWavFile();
   bool readBlock(Block &block);
+  bool readNextBlock(Block &block); // readBlock, wrapping around if looping
   void writeWavHeader();
   void writeBlock(const Block &block);
   void finalizeWavOutput();
@@ -45,7 +56,7 @@ private:
   std::thread processThread_;
 
   // WAV format info
-  int sampleRate_ = dsp::SAMPLE_RATE;
+  int sampleRate_ = DspConfig::SAMPLE_RATE;
   int numChannels_ = 1;
   int bitsPerSample_ = 16;
   size_t totalSamples_ = 0;
@@ -54,6 +65,19 @@ private:
   std::vector<float> audioBuffer_;
   size_t currentSample_ = 0;
 
+  // Block buffers handed to the callback
+  Block inputBlock_;
+  Block outputBlock_;
+
+  // Lookahead: input is read one block early and announced before the
+  // callback for the current block
+  LookaheadCallback lookahead_;
+  Block nextBlock_;
+  bool haveNext_ = false;
+  bool primed_ = false;
+
   // Output tracking
   size_t samplesWritten_ = 0;
 };
+
+using WavFileSource = BasicWavFileSource<>;
@@ -67,11 +67,12 @@ void WavWriter::writeHeader() {
   file_.write(header, 44);
 }
 
-void WavWriter::writeBlock(const Block &block) {
-  writeSamples(block.data(), dsp::BLOCK_SIZE);
-}
-
 void WavWriter::writeSamples(const float *samples, size_t count) {
+  if (count % static_cast<size_t>(config_.numChannels) != 0)
+    throw std::invalid_argument("WavWriter: " + std::to_string(count) +
+                                " samples is not a whole number of " +
+                                std::to_string(config_.numChannels) +
+                                "-channel frames");
   if (!file_.is_open())
     return;
 
@@ -93,7 +94,7 @@ void WavWriter::writeSamples(const float *samples, size_t count) {
     }
   }
 
-  samplesWritten_ += count;
+  samplesWritten_ += count / config_.numChannels;
 }
 
 void WavWriter::writeSamples(const std::vector<float> &samples) {
@@ -3,6 +3,7 @@
 #include "dsp_config.h"
 #include <Eigen/Dense>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -43,12 +44,28 @@ public:
   bool open();
 
   /**
-   * @brief Write a single block of samples
+   * @brief Write a block with one column per channel (interleaved on disk;
+   * a mono Block is one column); throws std::invalid_argument unless it has
+   * Config::numChannels columns
    */
-  void writeBlock(const Block &block);
+  template <typename Derived>
+  void writeBlock(const Eigen::MatrixBase<Derived> &block) {
+    if (block.cols() != config_.numChannels)
+      throw std::invalid_argument("WavWriter: block has " +
+                                  std::to_string(block.cols()) +
+                                  " channels, file has " +
+                                  std::to_string(config_.numChannels));
+    interleaved_.resize(static_cast<size_t>(block.size()));
+    Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic,
+                             Eigen::RowMajor>>(interleaved_.data(),
+                                               block.rows(), block.cols()) =
+        block;
+    writeSamples(interleaved_.data(), interleaved_.size());
+  }
 
   /**
-   * @brief Write arbitrary float samples
+   * @brief Write arbitrary float samples (interleaved if multi-channel);
+   * throws std::invalid_argument unless count is whole frames
    */
   void writeSamples(const float *samples, size_t count);
 
@@ -68,7 +85,7 @@ public:
   bool isOpen() const { return file_.is_open(); }
 
   /**
-   * @brief Get number of samples written
+   * @brief Get number of samples written (per channel)
    */
   size_t getSamplesWritten() const { return samplesWritten_; }
 
@@ -88,4 +105,5 @@ private:
   std::ofstream file_;
   size_t samplesWritten_ = 0;
   size_t dataChunkPos_ = 0;
+  std::vector<float> interleaved_; // writeBlock() scratch
 };
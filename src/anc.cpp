@@ -1,6 +1,14 @@
 #include "anc.h"
-void anc::step(const MicBlock &micBlock, Block &control) {
+template <typename Config>
+void anc::step(const BasicMicBlock<Config> &micBlock,
+               BasicControl<Config> &control) {
     // Simple feedforward ANC: use in-ear mic to estimate noise and invert it for control. This will work work due to acoustic noise propigation
     // The control signal is delayed by systemLatencyBlocks * block size samples to account for the time it takes for the control signal to propagate through the system and for the next mic block to be read in. 
-    control = -micBlock.inear;
-}
\ No newline at end of file
+    // Each speaker inverts the in-ear mic of its side (speaker l drives error mic l, wrapping if there are fewer error mics).
+    for (Eigen::Index l = 0; l < control.cols(); ++l)
+        control.col(l) = -micBlock.inear.col(l % micBlock.inear.cols());
+}
+
+#define INSTANTIATE_STEP(C)                                                    \
+    template void anc::step<C>(const BasicMicBlock<C> &, BasicControl<C> &);
+DSP_FOR_EACH_CONFIG(INSTANTIATE_STEP)
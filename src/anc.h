@@ -3,5 +3,9 @@
 namespace anc {
 
 constexpr int systemLatencyBlocks = 4;
-void step(const MicBlock &micBlock, Block &control);
-} // namespace anc
\ No newline at end of file
+// Instantiated for every configuration in dsp::dispatchBlockSize()
+// `control` arrives zeroed with a column per speaker
+template <typename Config>
+void step(const BasicMicBlock<Config> &micBlock,
+          BasicControl<Config> &control);
+} // namespace anc
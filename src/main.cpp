@@ -1,164 +1,352 @@
 #include "dsp_interface.h"
 #include "wav_writer.h"
 #include "anc.h"
+#include "utils/RealFFT.h"
 #include <iostream>
 #include <chrono>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <print>
-int main(int argc, char *argv[]) {
-    try {
-        // Help message
-        if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
-            std::cout << "Usage: " << argv[0] << " [input.wav] [output_prefix]" << std::endl;
-            std::cout << "  input.wav      : Input WAV file (default: input.wav)" << std::endl;
-            std::cout << "  output_prefix  : Prefix for output files (default: output)" << std::endl;
-            std::cout << "Output files: <prefix>_outside_mic.wav, <prefix>_inear_mic.wav" << std::endl;
-            return 0;
-        }
+static const char *const kDefaultWisdomFile = "convolution.wisdom";
 
-        // Parse command-line arguments
-        std::string inputWavFile = "input.wav";  // Default input file
-        std::string outputPrefix = "output";     // Default output prefix
+struct Options {
+    std::string inputWavFile = "input.wav";  // Default input file
+    std::string outputPrefix = "output";     // Default output prefix
+    bool offline = false;
+    std::optional<uint64_t> seed;
+    std::string telemetryFile;  // empty = no telemetry dump
+    size_t blockSize = dsp::BLOCK_SIZE;
+    // Wisdom is opt-in, so the default render does not depend on whatever
+    // file is in the working directory. Empty = none; tuning without
+    // --wisdom uses kDefaultWisdomFile.
+    std::string wisdomFile;
+    bool tune = false;         // --tune: measure unknown paths at startup
+    bool tuneCommand = false;  // "tune": measure every path, save, exit
+    float irToleranceDb = kExactTolerance;  // --ir-tolerance
+    Topology topology;         // --topology
+};
 
-        if (argc > 1) {
-            inputWavFile = argv[1];
-        }
-        if (argc > 2) {
-            outputPrefix = argv[2];
-        }
+// "R,E,L": reference mics, error mics, speakers
+static Topology parseTopology(const std::string &text) {
+    Topology t;
+    char c1 = 0, c2 = 0;
+    std::istringstream in(text);
+    if (!(in >> t.referenceMics >> c1 >> t.errorMics >> c2 >> t.speakers) || c1 != ',' || c2 != ',')
+        throw std::invalid_argument("--topology expects R,E,L (e.g. 4,2,2)");
+    return t;
+}
 
-        std::cout << "Using input WAV file: " << inputWavFile << std::endl;
-        std::cout << "Output file prefix: " << outputPrefix << std::endl;
-
-        // Initialize DSP parameters
-        Params params;
-
-        // Set input WAV file path
-        params.audioConfig.inputWavPath = inputWavFile;
-        // Set reasonable impulse response parameters
-        // H: noise -> outside mic (realistic microphone coupling)
-        {
-            auto &H = params.paths.H;
-            H(0) = 1.0f;      // Direct path
-            H(1) = 0.5f;      // Early reflection
-            H(2) = 0.25f;     // Second reflection
-            H(3) = 0.15f;     // Decay
-            // Exponential decay of remaining samples
-            for (size_t i = 4; i < dsp::IR_SIZE; ++i) {
-                H(i) = 0.15f * std::exp(-0.01f * (i - 3));
-            }
+// A copy of `ir` arriving `delay` samples later and scaled by `gain`: stands
+// in for the paths of the extra mics and speakers, which sit further away
+template <typename IRBlock>
+static IRBlock displaced(const IRBlock &ir, int delay, float gain) {
+    IRBlock out = IRBlock::Zero();
+    const int n = static_cast<int>(ir.size());
+    if (delay < n)
+        out.tail(n - delay) = gain * ir.head(n - delay);
+    return out;
+}
+
+static const char *const kPathNames[kNumPlantPaths] = {"H", "P", "C", "S"};
+
+static void printPlan(const PathPlan &plan) {
+    std::cout << "Convolution:";
+    for (int p = 0; p < kNumPlantPaths; ++p)
+        std::cout << " " << kPathNames[p] << "=" << strategyName(plan[p]);
+    std::cout << std::endl;
+}
+
+// Simulation parameters at one compile-time configuration
+template <typename Config>
+BasicParams<Config> makeParams(const Options &opts) {
+    // Initialize DSP parameters
+    BasicParams<Config> params;
+    params.mode = opts.offline ? RunMode::Offline : RunMode::RealTime;
+    params.seed = opts.seed;
+    params.convolution.wisdomFile = opts.wisdomFile;
+    params.convolution.tune = opts.tune;
+    params.convolution.irToleranceDb = opts.irToleranceDb;
+
+    // Set input WAV file path
+    params.audioConfig.inputWavPath = opts.inputWavFile;
+    params.setTopology(opts.topology);
+    // Set reasonable impulse response parameters (for the first mic and
+    // speaker; the others are derived below)
+    // H: noise -> outside mic (realistic microphone coupling)
+    {
+        auto &H = params.paths.H(0, 0);
+        H(0) = 1.0f;      // Direct path
+        H(1) = 0.5f;      // Early reflection
+        H(2) = 0.25f;     // Second reflection
+        H(3) = 0.15f;     // Decay
+        // Exponential decay of remaining samples
+        for (size_t i = 4; i < Config::IR_SIZE; ++i) {
+            H(i) = 0.15f * std::exp(-0.01f * (i - 3));
         }
-        
-        // P: noise -> in-ear mic (closer to source, slightly different path)
-        {
-            auto &P = params.paths.P;
-            P(0) = 0.9f;      // Slightly less direct than H
-            P(1) = 0.4f;      // Weaker early reflections
-            P(2) = 0.2f;
-            P(3) = 0.1f;
-            // Exponential decay
-            for (size_t i = 4; i < dsp::IR_SIZE; ++i) {
-                P(i) = 0.1f * std::exp(-0.012f * (i - 3));
-            }
+    }
+    
+    // P: noise -> in-ear mic (closer to source, slightly different path)
+    {
+        auto &P = params.paths.P(0, 0);
+        P(0) = 0.9f;      // Slightly less direct than H
+        P(1) = 0.4f;      // Weaker early reflections
+        P(2) = 0.2f;
+        P(3) = 0.1f;
+        // Exponential decay
+        for (size_t i = 4; i < Config::IR_SIZE; ++i) {
+            P(i) = 0.1f * std::exp(-0.012f * (i - 3));
         }
-        
-        // C: speaker -> outside mic (feedback path, secondary path)
-        {
-            auto &C = params.paths.C;
-            C(0) = 0.7f;      // Direct speaker coupling
-            C(1) = 0.35f;
-            C(2) = 0.15f;
-            C(3) = 0.08f;
-            // Exponential decay with longer tail
-            for (size_t i = 4; i < dsp::IR_SIZE; ++i) {
-                C(i) = 0.08f * std::exp(-0.008f * (i - 3));
-            }
+    }
+    
+    // C: speaker -> outside mic (feedback path, secondary path)
+    {
+        auto &C = params.paths.C(0, 0);
+        C(0) = 0.7f;      // Direct speaker coupling
+        C(1) = 0.35f;
+        C(2) = 0.15f;
+        C(3) = 0.08f;
+        // Exponential decay with longer tail
+        for (size_t i = 4; i < Config::IR_SIZE; ++i) {
+            C(i) = 0.08f * std::exp(-0.008f * (i - 3));
         }
-        
-        // Speaker: non-flat speaker response
-        {
-            auto &speaker = params.paths.speaker;
-            speaker(0) = 0.95f;  // Slightly attenuated direct response
-            speaker(1) = 0.1f;   // Some decay
-            speaker(2) = 0.05f;
-            // Quick decay after initial transient
-            for (size_t i = 3; i < dsp::IR_SIZE; ++i) {
-                speaker(i) = 0.05f * std::exp(-0.02f * (i - 2));
-            }
+    }
+    
+    // Speaker: non-flat speaker response
+    {
+        auto &speaker = params.paths.speaker[0];
+        speaker(0) = 0.95f;  // Slightly attenuated direct response
+        speaker(1) = 0.1f;   // Some decay
+        speaker(2) = 0.05f;
+        // Quick decay after initial transient
+        for (size_t i = 3; i < Config::IR_SIZE; ++i) {
+            speaker(i) = 0.05f * std::exp(-0.02f * (i - 2));
         }
-        
-        // Set reasonable noise and dynamics parameters
-        params.noise.outside_mic_stddev = 0.001f;  // Small ambient noise
-        params.noise.inear_mic_stddev = 0.5f;   // Even less in-ear noise
-        params.dynamics.noise_gain = 0.001f;
-        
-        // Create DSP interface with n block of system latency
-        DSPInterface dspInterface(params, anc::systemLatencyBlocks);
-        
+    }
+    
+    // Extra mics are a couple of samples further from the noise, and from
+    // every speaker but their own; extra speakers match the first
+    {
+        auto &paths = params.paths;
+        const Topology &t = opts.topology;
+        for (int r = 1; r < t.referenceMics; ++r)
+            paths.H(r, 0) = displaced(paths.H(0, 0), 2 * r, 0.9f);
+        for (int e = 1; e < t.errorMics; ++e)
+            paths.P(e, 0) = displaced(paths.P(0, 0), 2 * e, 0.9f);
+        for (int r = 0; r < t.referenceMics; ++r)
+            for (int l = 0; l < t.speakers; ++l)
+                if (r > 0 || l > 0)
+                    paths.C(r, l) = displaced(paths.C(0, 0), 2 * (r + l), r == l ? 1.0f : 0.5f);
+        for (int l = 1; l < t.speakers; ++l)
+            paths.speaker[l] = paths.speaker[0];
+    }
+
+    // Set reasonable noise and dynamics parameters
+    params.noise.outside_mic_stddev = 0.001f;  // Small ambient noise
+    params.noise.inear_mic_stddev = 0.5f;   // Even less in-ear noise
+    params.dynamics.noise_gain = 0.001f;
+    return params;
+}
+
+// "tune": time every strategy for every plant path and save the winners
+template <typename Config>
+int tune(const Options &opts) {
+    const BasicParams<Config> params = makeParams<Config>(opts);
+    ConvolutionWisdom wisdom;
+    if (!wisdom.load(opts.wisdomFile))
+        std::cerr << "Replacing malformed wisdom file " << opts.wisdomFile << std::endl;
+    std::cout << "Tuning on " << wisdom.cpu() << std::endl;
+    printPlan(BasicDSPInterface<Config>::planPaths(params, wisdom, TuneMode::Always));
+    if (!wisdom.save(opts.wisdomFile)) {
+        std::cerr << "Failed to write " << opts.wisdomFile << std::endl;
+        return 1;
+    }
+    std::cout << "Wisdom written: " << opts.wisdomFile << " (" << wisdom.size() << " entries)" << std::endl;
+    return 0;
+}
+
+// Runs the simulation at one compile-time configuration
+template <typename Config>
+int run(const Options &opts) {
+    if (opts.tuneCommand)
+        return tune<Config>(opts);
 
-        // Create WAV writers for outside and in-ear microphones
-        std::string outsideFile = outputPrefix + "_outside_mic.wav";
-        std::string inearFile = outputPrefix + "_inear_mic.wav";
-        WavWriter wavWriterOutside(outsideFile);
-        WavWriter wavWriterInear(inearFile);
+    BasicParams<Config> params = makeParams<Config>(opts);
 
-        // Open WAV files
-        if (!wavWriterOutside.open() || !wavWriterInear.open()) {
-            std::cerr << "Failed to open WAV files for writing" << std::endl;
-            return 1;
+    // Create DSP interface with n block of system latency
+    BasicDSPInterface<Config> dspInterface(params, anc::systemLatencyBlocks);
+    printPlan(dspInterface.getPathPlan());
+
+    // Dump telemetry however main exits from here on
+    struct TelemetryDump {
+        const BasicDSPInterface<Config> &dsp;
+        const std::string &path;
+        ~TelemetryDump() {
+            if (path.empty())
+                return;
+            std::ofstream out(path);
+            dsp.writeTelemetryJson(out);
+            std::cout << "Telemetry written: " << path << std::endl;
         }
+    } telemetryDump{dspInterface, opts.telemetryFile};
+    
+
+    // Create WAV writers for outside and in-ear microphones
+    std::string outsideFile = opts.outputPrefix + "_outside_mic.wav";
+    std::string inearFile = opts.outputPrefix + "_inear_mic.wav";
+    const Topology &topology = dspInterface.getTopology();
+    WavWriter wavWriterOutside(outsideFile, {.numChannels = topology.referenceMics});
+    WavWriter wavWriterInear(inearFile, {.numChannels = topology.errorMics});
+
+    // Open WAV files
+    if (!wavWriterOutside.open() || !wavWriterInear.open()) {
+        std::cerr << "Failed to open WAV files for writing" << std::endl;
+        return 1;
+    }
+    
+    // Set up the microphone processing function
+    dspInterface.setProcessMics([&](const BasicMicBlock<Config> &micBlock, BasicControl<Config> &control) {
+        // Fill control with zeros (no active control signal)
+        anc::step(micBlock, control);
         
-        // Set up the microphone processing function
-        dspInterface.setProcessMics([&](const MicBlock &micBlock, Block &control) {
-            // Fill control with zeros (no active control signal)
-            anc::step(micBlock, control);
-            
-            // Write both outside and in-ear microphone samples to respective WAV files
-            wavWriterOutside.writeBlock(micBlock.outside);
-            wavWriterInear.writeBlock(micBlock.inear);
-        });
-        
-        // Process microphone data until the WAV file is complete
-        int blockCount = 0;
+        // Write both outside and in-ear microphone samples to respective WAV files
+        wavWriterOutside.writeBlock(micBlock.outside);
+        wavWriterInear.writeBlock(micBlock.inear);
+    });
+    
+    if (opts.offline) {
         auto startTime = std::chrono::steady_clock::now();
-        auto lastReportTime = startTime;
-        
-        std::cout << "Starting audio processing..." << std::endl;
+        const size_t blocks = dspInterface.runOffline();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        const double audioSecs = static_cast<double>(blocks * Config::BLOCK_SIZE) / Config::SAMPLE_RATE;
+        std::cout << "Offline render complete. " << blocks << " blocks (" << audioSecs << " s of audio) in "
+                  << elapsed << " s (" << (elapsed > 0 ? audioSecs / elapsed : 0.0) << "x real time)" << std::endl;
+        return 0;
+    }
+
+    // Process microphone data until the WAV file is complete
+    int blockCount = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastReportTime = startTime;
+    
+    std::cout << "Starting audio processing..." << std::endl;
+    
+    // Continue processing while audio source is running or we still have buffered data
+    while (dspInterface.isAudioSourceRunning() || blockCount < 10) {
+        // Get the next block of microphone data (in place, no copy)
+        auto micBlock = dspInterface.getMicHandle();
         
-        // Continue processing while audio source is running or we still have buffered data
-        while (dspInterface.isAudioSourceRunning() || blockCount < 10) {
-            // Get the next block of microphone data
-            auto micBlock = dspInterface.getMics();
+        if (micBlock) {
+            blockCount++;
+            
+            // Report progress based on actual elapsed time
+            auto now = std::chrono::steady_clock::now();
+            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastReportTime).count();
             
-            if (micBlock) {
-                blockCount++;
-                
-                // Report progress based on actual elapsed time
-                auto now = std::chrono::steady_clock::now();
-                auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastReportTime).count();
-                
-                // Report every ~1000ms of actual elapsed time
-                if (elapsedMs >= 1000) {
-                    auto totalElapsedSecs = std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count();
-                    std::cout << "Processed " << totalElapsedSecs << " second(s) - " << blockCount << " blocks" << std::endl;
-                    lastReportTime = now;
-                }
+            // Report every ~1000ms of actual elapsed time
+            if (elapsedMs >= 1000) {
+                auto totalElapsedSecs = std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count();
+                std::cout << "Processed " << totalElapsedSecs << " second(s) - " << blockCount << " blocks" << std::endl;
+                lastReportTime = now;
+            }
+        } else {
+            // No data available yet, wait a bit and try again
+            if (dspInterface.isAudioSourceRunning()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));  // Very short sleep to avoid blocking
             } else {
-                // No data available yet, wait a bit and try again
-                if (dspInterface.isAudioSourceRunning()) {
-                    std::this_thread::sleep_for(std::chrono::microseconds(10));  // Very short sleep to avoid blocking
-                } else {
-                    // Audio source finished but we might have buffered data
-                    break;
-                }
+                // Audio source finished but we might have buffered data
+                break;
             }
         }
-        
-        auto endTime = std::chrono::steady_clock::now();
-        auto totalElapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-        std::cout << "Audio processing complete. Total blocks processed: " << blockCount 
-                  << " in " << totalElapsedMs << "ms" << std::endl;
-        
+    }
+    
+    auto endTime = std::chrono::steady_clock::now();
+    auto totalElapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    std::cout << "Audio processing complete. Total blocks processed: " << blockCount 
+              << " in " << totalElapsedMs << "ms" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        // Parse command-line arguments
+        Options opts;
+
+        std::vector<std::string> positional;
+        bool wisdomGiven = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help") {
+                std::cout << "Usage: " << argv[0] << " [--offline] [--seed N] [--telemetry FILE] [--block-size N] [--fft kiss|split] [--wisdom FILE] [--tune] [--ir-tolerance DB] [--topology R,E,L] [input.wav] [output_prefix]" << std::endl;
+                std::cout << "       " << argv[0] << " tune [--block-size N] [--fft kiss|split] [--wisdom FILE] [--ir-tolerance DB]" << std::endl;
+                std::cout << "  input.wav      : Input WAV file (default: input.wav)" << std::endl;
+                std::cout << "  output_prefix  : Prefix for output files (default: output)" << std::endl;
+                std::cout << "  --offline      : Render as fast as possible on one thread, deterministically" << std::endl;
+                std::cout << "  --seed N       : Seed for all simulated noise (offline default: 0)" << std::endl;
+                std::cout << "  --telemetry F  : Write latency histograms and miss counters to F as JSON at exit" << std::endl;
+                std::cout << "  --block-size N : Samples per block: 32, 64, 256 or 1024 (default: " << dsp::BLOCK_SIZE << ")" << std::endl;
+                std::cout << "  --fft B        : FFT backend: kiss or split (default: " << fft::backendName(fft::defaultBackend()) << ")" << std::endl;
+                std::cout << "  --wisdom F     : Use the convolution engine choices measured by tune in F (default: none, every path partitioned;" << std::endl;
+                std::cout << "                   with --tune or tune: " << kDefaultWisdomFile << ")" << std::endl;
+                std::cout << "  --tune         : Measure plant paths missing from the wisdom at startup and save them" << std::endl;
+                std::cout << "  --ir-tolerance D: Let the plant kernels drop up to D dB of their energy (e.g. -100) to skip quiet partitions and tails (default: exact)" << std::endl;
+                std::cout << "  --topology R,E,L: Reference mics (<= " << MAX_REFERENCE_MICS << "), error mics (<= " << MAX_ERROR_MICS << ") and speakers (<= " << MAX_SPEAKERS << ") (default: 1,1,1)" << std::endl;
+                std::cout << "  tune           : Measure every plant path at this block size, save the fastest engines and exit" << std::endl;
+                std::cout << "Output files: <prefix>_outside_mic.wav, <prefix>_inear_mic.wav (a channel per mic)" << std::endl;
+                return 0;
+            } else if (arg == "--offline") {
+                opts.offline = true;
+            } else if (arg == "--seed" && i + 1 < argc) {
+                opts.seed = std::stoull(argv[++i]);
+            } else if (arg == "--telemetry" && i + 1 < argc) {
+                opts.telemetryFile = argv[++i];
+            } else if (arg == "--block-size" && i + 1 < argc) {
+                opts.blockSize = std::stoul(argv[++i]);
+            } else if (arg == "--wisdom" && i + 1 < argc) {
+                opts.wisdomFile = argv[++i];
+                wisdomGiven = true;
+            } else if (arg == "--tune") {
+                opts.tune = true;
+            } else if (arg == "tune" && i == 1) {
+                opts.tuneCommand = true;
+            } else if (arg == "--ir-tolerance" && i + 1 < argc) {
+                opts.irToleranceDb = std::stof(argv[++i]);
+                checkToleranceDb(opts.irToleranceDb);
+            } else if (arg == "--topology" && i + 1 < argc) {
+                opts.topology = parseTopology(argv[++i]);
+            } else if (arg == "--fft" && i + 1 < argc) {
+                fft::setDefaultBackend(fft::parseBackend(argv[++i]));
+            } else {
+                positional.push_back(arg);
+            }
+        }
+
+        if ((opts.tune || opts.tuneCommand) && !wisdomGiven)
+            opts.wisdomFile = kDefaultWisdomFile;
+
+        if (positional.size() > 0) {
+            opts.inputWavFile = positional[0];
+        }
+        if (positional.size() > 1) {
+            opts.outputPrefix = positional[1];
+        }
+
+        std::cout << "Using input WAV file: " << opts.inputWavFile << std::endl;
+        std::cout << "Output file prefix: " << opts.outputPrefix << std::endl;
+        std::cout << "Block size: " << opts.blockSize << std::endl;
+        if (opts.irToleranceDb > kExactTolerance)
+            std::cout << "IR tolerance: " << opts.irToleranceDb << " dB" << std::endl;
+        std::cout << "FFT backend: " << fft::backendName(fft::defaultBackend()) << std::endl;
+        if (opts.topology != Topology{})
+            std::cout << "Topology: " << opts.topology.referenceMics << " reference, " << opts.topology.errorMics
+                      << " error mics, " << opts.topology.speakers << " speakers" << std::endl;
+
+        return dsp::dispatchBlockSize(opts.blockSize, [&](auto config) {
+            return run<decltype(config)>(opts);
+        });
     } catch (const std::exception &e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
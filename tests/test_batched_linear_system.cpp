@@ -0,0 +1,144 @@
+// Tests for BatchedLinearSystem (multi-channel partitioned convolution) and
+// the BatchedRealFFT it runs on
+#include "test_harness.h"
+#include "utils/BatchedLinearSystem.h"
+#include "utils/MultiKernelLinearSystem.h"
+#include "utils/RealFFT.h"
+
+#include <complex>
+#include <tuple>
+#include <vector>
+
+using Config = dsp::LowLatency64Config;
+constexpr int B = static_cast<int>(Config::BLOCK_SIZE);
+constexpr int IR = 300; // not a whole number of partitions
+using Batched = BatchedLinearSystem<IR, Config>;
+using Reference = MultiKernelLinearSystem<IR, 2, Config>;
+
+TEST(batched_fft_matches_per_lane_fft) {
+  // Lane by lane below kMinBatchLanes and on Kiss, batched otherwise: the
+  // full size/lane grid on Split, plus the batching threshold and Kiss
+  std::vector<std::tuple<int, int, fft::Backend>> cases;
+  for (int n : {8, 64, 512})
+    for (int lanes : {1, 3, 16})
+      cases.emplace_back(n, lanes, fft::Backend::Split);
+  cases.emplace_back(64, fft::BatchedRealFFT::kMinBatchLanes,
+                     fft::Backend::Split);
+  cases.emplace_back(512, 16, fft::Backend::Kiss);
+  for (auto [n, lanes, backend] : cases) {
+    const Eigen::MatrixXf x = Eigen::MatrixXf::Random(lanes, n);
+    fft::BatchedRealFFT batched(n, lanes, backend);
+    ASSERT_EQ(batched.batched(),
+              backend == fft::Backend::Split &&
+                  lanes >= fft::BatchedRealFFT::kMinBatchLanes);
+    const int bins = n / 2 + 1;
+    const int stride = simd::splitStride(bins * lanes);
+    std::vector<float> split(2 * stride);
+    batched.fwd(split.data(), stride, x.data());
+
+    fft::RealFFT single(n, backend);
+    std::vector<std::complex<float>> interleaved(bins * lanes);
+    for (int l = 0; l < lanes; ++l) {
+      const Eigen::VectorXf lane = x.row(l).transpose();
+      std::vector<std::complex<float>> X(bins);
+      single.fwd(X.data(), lane.data());
+      for (int k = 0; k < bins; ++k) {
+        ASSERT_NEAR(split[k * lanes + l], X[k].real(), 1e-4);
+        ASSERT_NEAR(split[stride + k * lanes + l], X[k].imag(), 1e-4);
+        interleaved[k * lanes + l] = X[k];
+      }
+    }
+
+    Eigen::MatrixXf back(lanes, n);
+    batched.inv(back.data(), interleaved.data());
+    ASSERT_TRUE((back - x).cwiseAbs().maxCoeff() < 1e-5f);
+  }
+}
+
+// Every (channel, kernel) pair against its own single-channel engine
+TEST(matches_independent_engines) {
+  for (int channels : {1, 3, 17}) {
+    Batched batched(channels, 2);
+    std::vector<Reference> refs(channels);
+    for (int c = 0; c < channels; ++c) {
+      for (int k = 0; k < 2; ++k) {
+        Reference::IRBlock h = Reference::IRBlock::Random(IR);
+        h *= 0.1f;
+        if (c % 2 == 1)
+          h.segment(B, B).setZero(); // a partition zero on some channels
+        batched.setImpulseResponse(c, k, h);
+        refs[c].setImpulseResponse(k, h);
+      }
+    }
+
+    std::vector<Batched::Frame> outputs(2);
+    std::array<Config::Block, 2> expected;
+    float maxErr = 0.0f;
+    for (int block = 0; block < 12; ++block) {
+      const Batched::Frame x = Batched::Frame::Random(channels, B);
+      batched.step(x, outputs);
+      for (int c = 0; c < channels; ++c) {
+        refs[c].step(x.row(c).transpose(), expected);
+        for (int k = 0; k < 2; ++k)
+          maxErr = std::max(
+              maxErr, (outputs[k].row(c).transpose() - expected[k])
+                          .cwiseAbs()
+                          .maxCoeff());
+      }
+    }
+    ASSERT_TRUE(maxErr < 1e-4f);
+  }
+}
+
+TEST(unset_kernels_give_zero) {
+  Batched batched(5, 3);
+  Batched::IRBlock h = Batched::IRBlock::Zero(IR);
+  h(7) = 1.0f;
+  batched.setImpulseResponse(2, 1, h); // a delay on one channel only
+
+  std::vector<Batched::Frame> outputs(3);
+  Batched::Frame x = Batched::Frame::Random(5, B);
+  for (int block = 0; block < 3; ++block) {
+    const Batched::Frame previous = x;
+    x = Batched::Frame::Random(5, B);
+    batched.step(x, outputs);
+    if (block == 0)
+      continue;
+    ASSERT_EQ(outputs[0].cwiseAbs().maxCoeff(), 0.0f);
+    ASSERT_EQ(outputs[2].cwiseAbs().maxCoeff(), 0.0f);
+    for (int c = 0; c < 5; ++c) {
+      for (int i = 0; i < B; ++i) {
+        const float delayed = i >= 7 ? x(c, i - 7) : previous(c, B - 7 + i);
+        ASSERT_NEAR(outputs[1](c, i), c == 2 ? delayed : 0.0f, 1e-5);
+      }
+    }
+  }
+}
+
+TEST(reset_clears_history) {
+  Batched batched(2, 1);
+  Batched::IRBlock h = Batched::IRBlock::Random(IR);
+  batched.setImpulseResponse(0, 0, h);
+  batched.setImpulseResponse(1, 0, h);
+
+  std::vector<Batched::Frame> first(1), second(1);
+  const Batched::Frame x = Batched::Frame::Random(2, B);
+  batched.step(Batched::Frame::Random(2, B), first);
+  batched.reset();
+  batched.step(x, first);
+
+  Batched fresh(2, 1);
+  fresh.setImpulseResponse(0, 0, h);
+  fresh.setImpulseResponse(1, 0, h);
+  fresh.step(x, second);
+  ASSERT_TRUE((first[0] - second[0]).cwiseAbs().maxCoeff() < 1e-6f);
+}
+
+int main() {
+  RUN_TEST(batched_fft_matches_per_lane_fft);
+  RUN_TEST(matches_independent_engines);
+  RUN_TEST(unset_kernels_give_zero);
+  RUN_TEST(reset_clears_history);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// Tests for BlockPool (preallocated slots with refcounted handles)
+#include "test_harness.h"
+#include "utils/BlockPool.h"
+#include "utils/SPSCQueue.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+using Pool = BlockPool<int, 4>;
+
+TEST(acquire_hands_out_distinct_slots_until_exhausted) {
+  Pool pool;
+  std::vector<Pool::Handle> held;
+  std::set<int *> seen;
+  for (size_t i = 0; i < Pool::capacity(); ++i) {
+    held.push_back(pool.acquire());
+    ASSERT_TRUE(static_cast<bool>(held.back()));
+    seen.insert(held.back().get());
+  }
+  ASSERT_EQ(seen.size(), Pool::capacity());
+  ASSERT_TRUE(!pool.acquire());
+  ASSERT_EQ(pool.exhausted(), 1u);
+
+  held.pop_back(); // last handle gone: slot is free again
+  ASSERT_TRUE(static_cast<bool>(pool.acquire()));
+}
+
+TEST(slot_is_shared_until_last_handle_drops) {
+  Pool pool;
+  Pool::Handle a = pool.acquire();
+  *a = 42;
+  ASSERT_EQ(a.useCount(), 1u);
+  {
+    Pool::Handle b = a;
+    ASSERT_EQ(a.useCount(), 2u);
+    ASSERT_EQ(b.get(), a.get());
+    ASSERT_EQ(*b, 42);
+    Pool::Handle c = std::move(b);
+    ASSERT_TRUE(!b);
+    ASSERT_EQ(a.useCount(), 2u);
+  }
+  ASSERT_EQ(a.useCount(), 1u);
+
+  // Three other slots can be taken while `a` is alive, but not a fourth
+  std::vector<Pool::Handle> others;
+  for (int i = 0; i < 3; ++i)
+    others.push_back(pool.acquire());
+  ASSERT_TRUE(!pool.acquire());
+  for (auto &h : others)
+    ASSERT_TRUE(h.get() != a.get());
+}
+
+TEST(assignment_releases_previous_slot) {
+  Pool pool;
+  Pool::Handle a = pool.acquire();
+  Pool::Handle b = pool.acquire();
+  int *old = a.get();
+  a = b; // a's old slot is free now
+  ASSERT_EQ(b.useCount(), 2u);
+  std::vector<Pool::Handle> rest; // every slot but b's
+  for (int i = 0; i < 3; ++i)
+    rest.push_back(pool.acquire());
+  ASSERT_TRUE(!pool.acquire());
+  bool reused = false;
+  for (auto &h : rest)
+    reused |= h.get() == old;
+  ASSERT_TRUE(reused);
+}
+
+TEST(queue_move_out_returns_slot) {
+  Pool pool;
+  SPSCQueue<Pool::Handle, 4> q;
+  q.push(pool.acquire());
+  Pool::Handle h;
+  ASSERT_TRUE(q.tryPop(h));
+  ASSERT_EQ(h.useCount(), 1u); // the queue slot kept nothing
+}
+
+TEST(cross_thread_release_stress) {
+  // Producer fills slots with a sequence number; the consumer drops the
+  // handles on another thread. A slot handed out twice would be seen with a
+  // foreign value.
+  using BigPool = BlockPool<uint64_t, 16>;
+  BigPool pool;
+  SPSCQueue<BigPool::Handle, 8> q;
+  constexpr uint64_t N = 50000;
+  std::atomic<bool> bad{false};
+
+  std::jthread consumer([&] {
+    BigPool::Handle h;
+    uint64_t expect = 0;
+    while (expect < N) {
+      if (!q.tryPop(h)) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (*h != expect)
+        bad = true;
+      ++expect;
+      h.reset();
+    }
+  });
+
+  for (uint64_t i = 0; i < N;) {
+    BigPool::Handle h = pool.acquire();
+    if (h) {
+      *h = i;
+      if (q.push(std::move(h))) {
+        ++i;
+        continue;
+      }
+    }
+    std::this_thread::yield(); // queue full or consumer holds every slot
+  }
+  consumer.join();
+  ASSERT_TRUE(!bad.load());
+}
+
+int main() {
+  RUN_TEST(acquire_hands_out_distinct_slots_until_exhausted);
+  RUN_TEST(slot_is_shared_until_last_handle_drops);
+  RUN_TEST(assignment_releases_previous_slot);
+  RUN_TEST(queue_move_out_returns_slot);
+  RUN_TEST(cross_thread_release_stress);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
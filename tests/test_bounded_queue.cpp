@@ -0,0 +1,194 @@
+// Tests for BoundedQueue (lock-free MPMC)
+#include "test_harness.h"
+#include "utils/BoundedQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(capacity_rounds_up_to_power_of_two) {
+  ASSERT_EQ(BoundedQueue<int>(5).capacity(), 8u);
+  ASSERT_EQ(BoundedQueue<int>(16).capacity(), 16u);
+  ASSERT_EQ(BoundedQueue<int>(0).capacity(), 2u);
+}
+
+TEST(fifo_until_full_then_empty) {
+  BoundedQueue<int> q(4);
+  for (int i = 0; i < 4; ++i)
+    ASSERT_TRUE(q.tryPush(i));
+  ASSERT_TRUE(!q.tryPush(99));
+  ASSERT_EQ(q.sizeApprox(), 4u);
+  int v;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(q.tryPop(v));
+    ASSERT_EQ(v, i);
+  }
+  ASSERT_TRUE(!q.tryPop(v));
+}
+
+TEST(wraps_around_many_times) {
+  BoundedQueue<int> q(2);
+  int v;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(q.tryPush(i));
+    ASSERT_TRUE(q.tryPop(v));
+    ASSERT_EQ(v, i);
+  }
+}
+
+TEST(pop_moves_out) {
+  BoundedQueue<std::vector<int>> q(2);
+  q.tryPush(std::vector<int>(100, 1));
+  std::vector<int> out;
+  ASSERT_TRUE(q.tryPop(out));
+  ASSERT_EQ(out.size(), 100u);
+}
+
+TEST(blocking_pop_wakes_on_push) {
+  BoundedQueue<int> q(4);
+  std::atomic<int> got{-1};
+  std::jthread consumer([&] {
+    int v;
+    if (q.pop(v))
+      got = v;
+  });
+  std::this_thread::sleep_for(5ms);
+  ASSERT_EQ(got.load(), -1);
+  q.push(7);
+  consumer.join();
+  ASSERT_EQ(got.load(), 7);
+}
+
+TEST(blocking_push_waits_for_space) {
+  BoundedQueue<int> q(2);
+  q.push(1);
+  q.push(2);
+  std::atomic<bool> pushed{false};
+  std::jthread producer([&] {
+    q.push(3);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(5ms);
+  ASSERT_TRUE(!pushed.load());
+  int v;
+  ASSERT_TRUE(q.pop(v));
+  producer.join();
+  ASSERT_TRUE(pushed.load());
+}
+
+TEST(close_releases_blocked_threads) {
+  BoundedQueue<int> q(2);
+  q.push(1);
+  std::atomic<int> popped{0};
+  std::vector<std::jthread> consumers;
+  for (int i = 0; i < 3; ++i)
+    consumers.emplace_back([&] {
+      int v;
+      while (q.pop(v))
+        popped.fetch_add(1);
+    });
+  std::this_thread::sleep_for(5ms);
+  q.close();
+  consumers.clear();
+  ASSERT_EQ(popped.load(), 1); // drained, then every pop returned false
+  ASSERT_TRUE(!q.push(2));
+}
+
+// A pop() that loses the race for an item to a tryPop() consumer goes back
+// to sleep; the next push must still wake it
+TEST(blocking_pop_wakes_after_losing_to_try_pop) {
+  BoundedQueue<int> q(8);
+  std::atomic<int> popped{0}, stolen{0};
+  std::jthread blocking([&] {
+    int v;
+    while (q.pop(v))
+      popped.fetch_add(1);
+  });
+
+  int pushed = 0;
+  bool stuck = false;
+  for (int round = 0; round < 200 && !stuck; ++round) {
+    {
+      std::jthread stealer([&](std::stop_token st) {
+        int v;
+        while (!st.stop_requested())
+          if (q.tryPop(v))
+            stolen.fetch_add(1);
+      });
+      for (int i = 0; i < 20; ++i) {
+        q.push(i);
+        ++pushed;
+        std::this_thread::yield();
+      }
+    }
+    // Only the blocking consumer is left
+    q.push(-1);
+    ++pushed;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (popped.load() + stolen.load() < pushed &&
+           std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(50us);
+    stuck = popped.load() + stolen.load() < pushed;
+  }
+  q.close(); // lets the blocking consumer exit even if it was stuck
+  ASSERT_TRUE(!stuck);
+}
+
+TEST(mpmc_stress_delivers_everything_once_in_producer_order) {
+  constexpr int P = 4, C = 4, N = 20000;
+  BoundedQueue<uint64_t> q(64);
+  std::vector<std::atomic<int>> seen(P * N);
+  std::atomic<bool> outOfOrder{false};
+
+  std::vector<std::jthread> consumers;
+  for (int c = 0; c < C; ++c)
+    consumers.emplace_back([&] {
+      std::vector<int> last(P, -1);
+      uint64_t v;
+      while (q.pop(v)) {
+        const int p = static_cast<int>(v >> 32);
+        const int i = static_cast<int>(v & 0xffffffff);
+        seen[p * N + i].fetch_add(1);
+        if (i <= last[p])
+          outOfOrder = true; // one producer's items reach a consumer in order
+        last[p] = i;
+      }
+    });
+
+  {
+    std::vector<std::jthread> producers;
+    for (int p = 0; p < P; ++p)
+      producers.emplace_back([&, p] {
+        for (int i = 0; i < N; ++i)
+          q.push((static_cast<uint64_t>(p) << 32) | static_cast<uint32_t>(i));
+      });
+  }
+  q.close();
+  consumers.clear();
+
+  int missing = 0, duplicated = 0;
+  for (auto &s : seen) {
+    missing += s.load() == 0;
+    duplicated += s.load() > 1;
+  }
+  ASSERT_EQ(missing, 0);
+  ASSERT_EQ(duplicated, 0);
+  ASSERT_TRUE(!outOfOrder.load());
+}
+
+int main() {
+  RUN_TEST(capacity_rounds_up_to_power_of_two);
+  RUN_TEST(fifo_until_full_then_empty);
+  RUN_TEST(wraps_around_many_times);
+  RUN_TEST(pop_moves_out);
+  RUN_TEST(blocking_pop_wakes_on_push);
+  RUN_TEST(blocking_push_waits_for_space);
+  RUN_TEST(close_releases_blocked_threads);
+  RUN_TEST(blocking_pop_wakes_after_losing_to_try_pop);
+  RUN_TEST(mpmc_stress_delivers_everything_once_in_producer_order);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+// Tests for the runtime-dispatched split-complex MAC kernels
+#include "test_harness.h"
+#include "utils/ComplexMac.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using cf = std::complex<float>;
+
+// Random operands for `parts` partitions of `bins` complex values
+struct Operands {
+  int bins, parts, stride;
+  std::vector<std::vector<cf>> x, h;          // interleaved
+  std::vector<std::vector<float>> xs, hs;     // split
+  std::vector<const float *> xp, hp;
+  std::vector<cf> acc0;
+
+  Operands(int bins, int parts, unsigned seed)
+      : bins(bins), parts(parts), stride(simd::splitStride(bins)) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    auto spectrum = [&] {
+      std::vector<cf> s(bins);
+      for (auto &v : s)
+        v = cf(u(rng), u(rng));
+      return s;
+    };
+    for (int p = 0; p < parts; ++p) {
+      x.push_back(spectrum());
+      h.push_back(spectrum());
+      xs.emplace_back(2 * stride, 1.0f); // padding must be overwritten
+      hs.emplace_back(2 * stride, 1.0f);
+      simd::toSplit(x[p].data(), xs[p].data(), stride, bins);
+      simd::toSplit(h[p].data(), hs[p].data(), stride, bins);
+    }
+    for (int p = 0; p < parts; ++p) {
+      xp.push_back(xs[p].data());
+      hp.push_back(hs[p].data());
+    }
+    acc0 = spectrum();
+  }
+
+  std::vector<cf> run(simd::Isa isa, bool subtract) const {
+    std::vector<cf> acc = acc0;
+    simd::complexMacKernel(isa)(acc.data(), xp.data(), hp.data(), parts,
+                                stride, bins, subtract);
+    return acc;
+  }
+};
+
+static const simd::Isa kAllIsas[] = {simd::Isa::Scalar, simd::Isa::SSE2,
+                                     simd::Isa::AVX2, simd::Isa::AVX512};
+
+TEST(split_stride_pads_to_16) {
+  ASSERT_EQ(simd::splitStride(1), 16);
+  ASSERT_EQ(simd::splitStride(16), 16);
+  ASSERT_EQ(simd::splitStride(129), 144);
+  ASSERT_EQ(simd::splitStride(513), 528);
+}
+
+TEST(to_split_layout) {
+  const cf in[3] = {{1, 2}, {3, 4}, {5, 6}};
+  std::vector<float> split(32, -1.0f);
+  simd::toSplit(in, split.data(), 16, 3);
+  ASSERT_EQ(split[0], 1.0f);
+  ASSERT_EQ(split[2], 5.0f);
+  ASSERT_EQ(split[16], 2.0f);
+  ASSERT_EQ(split[18], 6.0f);
+  ASSERT_EQ(split[3], 0.0f);
+  ASSERT_EQ(split[31], 0.0f);
+}
+
+TEST(detected_isa_has_kernel) {
+  ASSERT_TRUE(simd::complexMacKernel(simd::detectedIsa()) != nullptr);
+  ASSERT_TRUE(simd::complexMacKernel(simd::Isa::Scalar) != nullptr);
+  std::printf("  detected: %s\n", simd::isaName(simd::detectedIsa()));
+}
+
+TEST(scalar_matches_complex_reference) {
+  const Operands ops(129, 4, 1);
+  for (bool subtract : {false, true}) {
+    const std::vector<cf> acc = ops.run(simd::Isa::Scalar, subtract);
+    for (int k = 0; k < ops.bins; ++k) {
+      cf sum = 0.0f;
+      for (int p = 0; p < ops.parts; ++p)
+        sum += ops.x[p][k] * ops.h[p][k];
+      const cf expected = subtract ? ops.acc0[k] - sum : ops.acc0[k] + sum;
+      ASSERT_NEAR(acc[k].real(), expected.real(), 1e-5f);
+      ASSERT_NEAR(acc[k].imag(), expected.imag(), 1e-5f);
+    }
+  }
+}
+
+// Every kernel the CPU can run rounds exactly like the scalar one, for bin
+// counts that exercise the vector body and the scalar tail of each width
+TEST(every_isa_bit_identical_to_scalar) {
+  const int binCounts[] = {1, 3, 4, 7, 8, 15, 16, 17, 33, 129, 257, 513};
+  const int partCounts[] = {1, 2, 5, 16};
+  int checked = 0;
+  for (int bins : binCounts) {
+    for (int parts : partCounts) {
+      const Operands ops(bins, parts, bins * 31 + parts);
+      for (bool subtract : {false, true}) {
+        const std::vector<cf> ref = ops.run(simd::Isa::Scalar, subtract);
+        for (simd::Isa isa : kAllIsas) {
+          if (!simd::complexMacKernel(isa))
+            continue;
+          const std::vector<cf> acc = ops.run(isa, subtract);
+          ASSERT_TRUE(std::memcmp(acc.data(), ref.data(),
+                                  ref.size() * sizeof(cf)) == 0);
+          ++checked;
+        }
+      }
+    }
+  }
+  ASSERT_TRUE(checked > 0);
+}
+
+TEST(zero_parts_leaves_acc) {
+  const Operands ops(33, 1, 7);
+  std::vector<cf> acc = ops.acc0;
+  simd::complexMac(acc.data(), ops.xp.data(), ops.hp.data(), 0, ops.stride,
+                   ops.bins);
+  ASSERT_TRUE(acc == ops.acc0);
+}
+
+int main() {
+  RUN_TEST(split_stride_pads_to_16);
+  RUN_TEST(to_split_layout);
+  RUN_TEST(detected_isa_has_kernel);
+  RUN_TEST(scalar_matches_complex_reference);
+  RUN_TEST(every_isa_bit_identical_to_scalar);
+  RUN_TEST(zero_parts_leaves_acc);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+// Tests for the convolution strategies (PathEngine) and the wisdom planner
+#include "test_harness.h"
+#include "convolution_planner.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using Block = dsp::DefaultConfig::Block;
+constexpr int kIR = 1024;
+using Engine = PathEngine<kIR>;
+using IR = Engine::IRBlock;
+
+static const char *kWisdomPath = "/tmp/test_convolution_planner.wisdom";
+
+// Max |engine - direct reference| over `blocks` blocks, with a kernel change
+// prepared before block 3
+static float maxErrorVsReference(ConvolutionStrategy strategy,
+                                 const IR &h1, const IR &h2, int blocks) {
+  LinearSystem<kIR> ref(h1);
+  auto engine = makePathEngine<kIR>(strategy);
+  engine->setImpulseResponse(h1);
+  float maxErr = 0.0f;
+  for (int b = 0; b < blocks; ++b) {
+    if (b == 3) {
+      ref.prepareImpulseResponse(h2);
+      engine->prepareImpulseResponse(h2);
+    }
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    engine->step(x, y);
+    maxErr = std::max(maxErr, (y - yRef).cwiseAbs().maxCoeff());
+  }
+  return maxErr;
+}
+
+TEST(strategy_names_round_trip) {
+  for (ConvolutionStrategy s : kConvolutionStrategies)
+    ASSERT_TRUE(parseStrategy(strategyName(s)) == s);
+  bool threw = false;
+  try {
+    parseStrategy("winograd");
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT_TRUE(threw);
+}
+
+TEST(effective_length_skips_zero_tail) {
+  IR h = IR::Zero();
+  ASSERT_EQ(effectiveLength(h), 0);
+  h(0) = 1.0f;
+  h(99) = -0.5f;
+  ASSERT_EQ(effectiveLength(h), 100);
+  LinearSystem<kIR> sys(h);
+  ASSERT_EQ(sys.effectiveLength(), 100);
+}
+
+TEST(every_strategy_matches_direct_form) {
+  const IR h1 = IR::Random() * 0.1f;
+  const IR h2 = IR::Random() * 0.1f;
+  for (ConvolutionStrategy s : kConvolutionStrategies) {
+    auto engine = makePathEngine<kIR>(s);
+    ASSERT_TRUE(engine->strategy() == s);
+    ASSERT_NEAR(maxErrorVsReference(s, h1, h2, 8), 0.0f, 1e-4f);
+  }
+}
+
+TEST(benchmark_picks_the_fastest) {
+  IR h = IR::Zero();
+  h(0) = 1.0f;
+  const auto entry = benchmarkPath<kIR>(h);
+  double fastest = entry.nsPerBlock[0];
+  for (double ns : entry.nsPerBlock) {
+    ASSERT_TRUE(ns > 0.0);
+    fastest = std::min(fastest, ns);
+  }
+  const size_t chosen = static_cast<size_t>(entry.strategy);
+  ASSERT_TRUE(entry.nsPerBlock[chosen] == fastest);
+  // One tap: the direct form does next to nothing
+  ASSERT_TRUE(entry.strategy == ConvolutionStrategy::Direct);
+}
+
+TEST(wisdom_key_rounds_taps_to_blocks) {
+  IR h = IR::Zero();
+  h(300) = 1.0f;
+  const auto key = wisdomKey<kIR>(h);
+  ASSERT_EQ(key.blockSize, static_cast<int>(dsp::BLOCK_SIZE));
+  ASSERT_EQ(key.irSize, kIR);
+  ASSERT_EQ(key.taps, 512);
+}
+
+TEST(plan_path_modes) {
+  const IR h = IR::Random();
+  ConvolutionWisdom wisdom;
+  ASSERT_TRUE(planPath<kIR>(h, wisdom, TuneMode::Never) ==
+              ConvolutionStrategy::Partitioned);
+  ASSERT_EQ(wisdom.size(), size_t(0));
+
+  const ConvolutionStrategy measured =
+      planPath<kIR>(h, wisdom, TuneMode::Missing);
+  ASSERT_EQ(wisdom.size(), size_t(1));
+  ASSERT_TRUE(wisdom.lookup(wisdomKey<kIR>(h))->strategy == measured);
+
+  // Known paths are not re-measured unless asked
+  ConvolutionWisdom::Entry forced;
+  forced.strategy = ConvolutionStrategy::SingleFFT;
+  wisdom.record(wisdomKey<kIR>(h), forced);
+  ASSERT_TRUE(planPath<kIR>(h, wisdom, TuneMode::Never) ==
+              ConvolutionStrategy::SingleFFT);
+  ASSERT_TRUE(planPath<kIR>(h, wisdom, TuneMode::Missing) ==
+              ConvolutionStrategy::SingleFFT);
+  planPath<kIR>(h, wisdom, TuneMode::Always);
+  ASSERT_TRUE(wisdom.lookup(wisdomKey<kIR>(h))->nsPerBlock[0] > 0.0);
+}
+
+TEST(wisdom_save_load_round_trip) {
+  ConvolutionWisdom a;
+  ConvolutionWisdom::Key key{256, 1024, 512, "split"};
+  ConvolutionWisdom::Entry entry;
+  entry.strategy = ConvolutionStrategy::Direct;
+  entry.nsPerBlock = {100.0, 200.0, 300.0};
+  a.record(key, entry);
+  ASSERT_TRUE(a.save(kWisdomPath));
+
+  ConvolutionWisdom b;
+  ASSERT_TRUE(b.load(kWisdomPath));
+  ASSERT_EQ(b.size(), size_t(1));
+  const auto got = b.lookup(key);
+  ASSERT_TRUE(got.has_value());
+  ASSERT_TRUE(got->strategy == ConvolutionStrategy::Direct);
+  ASSERT_NEAR(got->nsPerBlock[2], 300.0, 1e-6);
+  ASSERT_TRUE(!b.lookup({256, 1024, 512, "kiss"}).has_value());
+}
+
+TEST(wisdom_from_another_cpu_is_ignored) {
+  {
+    std::ofstream out(kWisdomPath);
+    out << "cpu Some Other Processor\n";
+    out << "256 1024 256 split direct 1 2 3\n";
+  }
+  ConvolutionWisdom w;
+  ASSERT_TRUE(w.load(kWisdomPath));
+  ASSERT_EQ(w.size(), size_t(0));
+}
+
+TEST(saving_keeps_other_cpus_wisdom) {
+  {
+    std::ofstream out(kWisdomPath);
+    out << "cpu Some Other Processor\n";
+    out << "256 1024 256 split direct 1 2 3\n";
+  }
+  ConvolutionWisdom w;
+  ASSERT_TRUE(w.load(kWisdomPath));
+  ConvolutionWisdom::Entry entry;
+  entry.strategy = ConvolutionStrategy::SingleFFT;
+  w.record({256, 1024, 512, "split"}, entry);
+  ASSERT_TRUE(w.save(kWisdomPath));
+
+  std::ifstream in(kWisdomPath);
+  std::string line;
+  bool otherCpu = false, otherEntry = false;
+  while (std::getline(in, line)) {
+    otherCpu |= line == "cpu Some Other Processor";
+    otherEntry |= otherCpu && line == "256 1024 256 split direct 1 2 3";
+  }
+  ASSERT_TRUE(otherEntry);
+
+  ConvolutionWisdom reloaded;
+  ASSERT_TRUE(reloaded.load(kWisdomPath));
+  ASSERT_EQ(reloaded.size(), size_t(1));
+}
+
+TEST(missing_and_malformed_wisdom) {
+  ConvolutionWisdom w;
+  std::remove(kWisdomPath);
+  ASSERT_TRUE(w.load(kWisdomPath));
+  {
+    std::ofstream out(kWisdomPath);
+    out << "cpu " << w.cpu() << "\n";
+    out << "256 1024 256 split direct 1 2 3\n"; // valid, but in a bad file
+    out << "256 1024 256 split quantum 1 2 3\n";
+  }
+  ASSERT_TRUE(!w.load(kWisdomPath));
+  ASSERT_EQ(w.size(), size_t(0));
+  std::remove(kWisdomPath);
+}
+
+int main() {
+  RUN_TEST(strategy_names_round_trip);
+  RUN_TEST(effective_length_skips_zero_tail);
+  RUN_TEST(every_strategy_matches_direct_form);
+  RUN_TEST(benchmark_picks_the_fastest);
+  RUN_TEST(wisdom_key_rounds_taps_to_blocks);
+  RUN_TEST(plan_path_modes);
+  RUN_TEST(wisdom_save_load_round_trip);
+  RUN_TEST(wisdom_from_another_cpu_is_ignored);
+  RUN_TEST(saving_keeps_other_cpus_wisdom);
+  RUN_TEST(missing_and_malformed_wisdom);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+// Tests for DeadlineWorker<Job, Result> (persistent worker with deadlines)
+#include "test_harness.h"
+#include "utils/DeadlineWorker.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+using Worker = DeadlineWorker<int, int>;
+
+TEST(on_time_result_is_delivered) {
+  Worker w([](const int &x, int &y) { y = 2 * x; });
+  for (int i = 0; i < 100; ++i) {
+    int out = -1;
+    ASSERT_TRUE(w.submit(i));
+    ASSERT_TRUE(w.waitFor(1s, out));
+    ASSERT_EQ(out, 2 * i);
+  }
+  auto s = w.stats();
+  ASSERT_EQ(s.completed, 100u);
+  ASSERT_EQ(s.missed, 0u);
+  ASSERT_EQ(s.late, 0u);
+}
+
+TEST(missed_deadline_returns_without_blocking) {
+  Worker w([](const int &, int &y) {
+    std::this_thread::sleep_for(100ms);
+    y = 1;
+  });
+  int out = -1;
+  ASSERT_TRUE(w.submit(0));
+  const auto t0 = Worker::Clock::now();
+  ASSERT_TRUE(!w.waitFor(1ms, out));
+  ASSERT_TRUE(Worker::Clock::now() - t0 < 50ms);
+  ASSERT_EQ(out, -1);
+  ASSERT_EQ(w.stats().missed, 1u);
+}
+
+TEST(late_job_is_counted_and_blocks_new_submissions) {
+  std::atomic<bool> release{false};
+  Worker w([&](const int &x, int &y) {
+    while (!release.load())
+      std::this_thread::sleep_for(1ms);
+    y = x;
+  });
+  int out = -1;
+  ASSERT_TRUE(w.submit(1));
+  ASSERT_TRUE(!w.waitFor(1ms, out));
+
+  // Still running: the next block is skipped, not queued
+  ASSERT_TRUE(!w.submit(2));
+  ASSERT_TRUE(!w.waitFor(1ms, out));
+  ASSERT_EQ(w.stats().skipped, 1u);
+  ASSERT_EQ(w.stats().missed, 2u);
+
+  release = true;
+  while (w.stats().late == 0)
+    std::this_thread::sleep_for(1ms);
+
+  // Worker is free again and the stale result never leaks out
+  ASSERT_TRUE(w.submit(3));
+  ASSERT_TRUE(w.waitFor(1s, out));
+  ASSERT_EQ(out, 3);
+  ASSERT_EQ(w.stats().late, 1u);
+  ASSERT_EQ(w.stats().completed, 1u);
+}
+
+TEST(destructs_with_abandoned_job) {
+  {
+    Worker w([](const int &, int &) { std::this_thread::sleep_for(20ms); });
+    int out;
+    w.submit(0);
+    w.waitFor(1ms, out);
+  }
+  ASSERT_TRUE(true);
+}
+
+TEST(deadline_in_the_past_still_collects_finished_job) {
+  Worker w([](const int &x, int &y) { y = x + 1; });
+  int out = -1;
+  ASSERT_TRUE(w.submit(41));
+  std::this_thread::sleep_for(20ms); // job long finished
+  ASSERT_TRUE(w.waitUntil(Worker::Clock::now() - 1s, out));
+  ASSERT_EQ(out, 42);
+}
+
+int main() {
+  RUN_TEST(on_time_result_is_delivered);
+  RUN_TEST(missed_deadline_returns_without_blocking);
+  RUN_TEST(late_job_is_counted_and_blocks_new_submissions);
+  RUN_TEST(destructs_with_abandoned_job);
+  RUN_TEST(deadline_in_the_past_still_collects_finished_job);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// Tests for the compile-time DSP configurations (dsp_config.h) and the
+// engines specialized on them
+#include "test_harness.h"
+#include "dsp_config.h"
+#include "utils/FastLinearSystem.h"
+#include "utils/IIRFilter.h"
+#include "utils/LPButterworthCoeff.h"
+#include "utils/LinearSystem.h"
+#include "utils/MultiKernelLinearSystem.h"
+
+#include <stdexcept>
+
+TEST(fft_size_is_derived_from_block_and_ir) {
+  ASSERT_EQ(dsp::DefaultConfig::FFT_SIZE, size_t(2048)); // 256 + 1024 - 1
+  ASSERT_EQ(dsp::LowLatency32Config::FFT_SIZE, size_t(2048));
+  ASSERT_EQ(dsp::Offline1024Config::FFT_SIZE, size_t(2048)); // 2047
+  ASSERT_EQ((dsp::Config<1024, 2048>::FFT_SIZE), size_t(4096));
+  ASSERT_EQ((dsp::Config<64, 64>::FFT_SIZE), size_t(128));
+  ASSERT_EQ((FastLinearSystem<64, true, dsp::LowLatency32Config>::FFT_SIZE),
+            128);
+  ASSERT_EQ((FastLinearSystem<2048, true, dsp::Offline1024Config>::FFT_SIZE),
+            4096);
+}
+
+TEST(default_config_keeps_the_legacy_names) {
+  ASSERT_EQ(dsp::BLOCK_SIZE, dsp::DefaultConfig::BLOCK_SIZE);
+  ASSERT_EQ(dsp::IR_SIZE, dsp::DefaultConfig::IR_SIZE);
+  ASSERT_EQ(dsp::CONTEXT_BLOCKS, size_t(4));
+  ASSERT_EQ(dsp::LowLatency32Config::CONTEXT_BLOCKS, size_t(32));
+  ASSERT_EQ(dsp::Offline1024Config::CONTEXT_BLOCKS, size_t(1));
+}
+
+TEST(dispatch_selects_the_matching_config) {
+  for (size_t n : {32, 64, 256, 1024}) {
+    const size_t got = dsp::dispatchBlockSize(
+        n, [](auto config) { return decltype(config)::BLOCK_SIZE; });
+    ASSERT_EQ(got, n);
+  }
+}
+
+TEST(dispatch_rejects_unsupported_sizes) {
+  bool threw = false;
+  try {
+    dsp::dispatchBlockSize(100, [](auto) { return 0; });
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT_TRUE(threw);
+}
+
+// FFT overlap-add against the direct form, at Config's block size
+template <typename Config, int IR> static float fastVsDirect(int blocks) {
+  using Fast = FastLinearSystem<IR, true, Config>;
+  using Direct = LinearSystem<IR, Config>;
+  typename Fast::IRBlock h = Fast::IRBlock::Random() * 0.1f;
+  Fast fast(h);
+  Direct direct(h);
+  float maxErr = 0.0f;
+  for (int b = 0; b < blocks; ++b) {
+    typename Config::Block x = Config::Block::Random(), y, yRef;
+    fast.step(x, y);
+    direct.step(x, yRef);
+    maxErr = std::max(maxErr, (y - yRef).cwiseAbs().maxCoeff());
+  }
+  return maxErr;
+}
+
+TEST(fast_linear_system_matches_direct_at_every_block_size) {
+  ASSERT_NEAR((fastVsDirect<dsp::LowLatency32Config, 1024>(40)), 0.0f, 1e-4f);
+  ASSERT_NEAR((fastVsDirect<dsp::LowLatency64Config, 1024>(20)), 0.0f, 1e-4f);
+  ASSERT_NEAR((fastVsDirect<dsp::DefaultConfig, 1024>(8)), 0.0f, 1e-4f);
+  ASSERT_NEAR((fastVsDirect<dsp::Offline1024Config, 1024>(3)), 0.0f, 1e-4f);
+  // IR shorter than the block
+  ASSERT_NEAR((fastVsDirect<dsp::Offline1024Config, 64>(3)), 0.0f, 1e-4f);
+}
+
+// The partitioned engine (what DSPInterface runs) against the direct form
+template <typename Config> static float partitionedVsDirect(int blocks) {
+  constexpr int IR = static_cast<int>(Config::IR_SIZE);
+  MultiKernelLinearSystem<IR, 1, Config> sys;
+  LinearSystem<IR, Config> direct;
+  typename Config::IRBlock h = Config::IRBlock::Random() * 0.1f;
+  sys.setImpulseResponse(0, h);
+  direct.setImpulseResponse(h);
+  std::array<typename Config::Block, 1> y;
+  float maxErr = 0.0f;
+  for (int b = 0; b < blocks; ++b) {
+    typename Config::Block x = Config::Block::Random(), yRef;
+    sys.step(x, y);
+    direct.step(x, yRef);
+    maxErr = std::max(maxErr, (y[0] - yRef).cwiseAbs().maxCoeff());
+  }
+  return maxErr;
+}
+
+TEST(partitioned_engine_matches_direct_at_every_block_size) {
+  ASSERT_NEAR(partitionedVsDirect<dsp::LowLatency32Config>(40), 0.0f, 1e-4f);
+  ASSERT_NEAR(partitionedVsDirect<dsp::DefaultConfig>(8), 0.0f, 1e-4f);
+  ASSERT_NEAR(partitionedVsDirect<dsp::Offline1024Config>(3), 0.0f, 1e-4f);
+}
+
+TEST(iir_filter_blocks_match_samples_at_any_block_size) {
+  LPButterworthCoeff lp(1000.0f, 48000.0f);
+  BasicIIRFilter<dsp::LowLatency32Config> blockwise(lp.getCoefficients());
+  IIRFilter samplewise(lp.getCoefficients());
+  for (int b = 0; b < 8; ++b) {
+    const dsp::LowLatency32Config::Block x =
+        dsp::LowLatency32Config::Block::Random();
+    const auto &y = blockwise.filterBlock(x);
+    for (int i = 0; i < 32; ++i)
+      ASSERT_NEAR(y(i), samplewise.filterSample(x(i)), 1e-7f);
+  }
+}
+
+int main() {
+  RUN_TEST(fft_size_is_derived_from_block_and_ir);
+  RUN_TEST(default_config_keeps_the_legacy_names);
+  RUN_TEST(dispatch_selects_the_matching_config);
+  RUN_TEST(dispatch_rejects_unsupported_sizes);
+  RUN_TEST(fast_linear_system_matches_direct_at_every_block_size);
+  RUN_TEST(partitioned_engine_matches_direct_at_every_block_size);
+  RUN_TEST(iir_filter_blocks_match_samples_at_any_block_size);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
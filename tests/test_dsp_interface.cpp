@@ -1,19 +1,24 @@
 // Tests for DSPInterface — plant propagation, callback flow, getMics/sendControl
 #include "test_harness.h"
 #include "dsp_interface.h"
+#include "utils/RealFFT.h"
+#include "wav_writer.h"
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <fstream>
+#include <stdexcept>
 #include <thread>
+#include <utility>
 
 // Helper: create params with simple delta impulse responses
 static Params makeTestParams() {
   Params p;
-  p.paths.H(0) = 1.0f;       // noise -> outside (passthrough)
-  p.paths.P(0) = 0.5f;       // noise -> in-ear (half gain)
-  p.paths.C(0) = 0.1f;       // speaker -> outside (leakage)
-  p.paths.speaker(0) = 1.0f; // flat speaker
-  p.state.S(0) = 0.8f;       // speaker -> in-ear
+  p.paths.H(0, 0)(0) = 1.0f;    // noise -> outside (passthrough)
+  p.paths.P(0, 0)(0) = 0.5f;    // noise -> in-ear (half gain)
+  p.paths.C(0, 0)(0) = 0.1f;    // speaker -> outside (leakage)
+  p.paths.speaker[0](0) = 1.0f; // flat speaker
+  p.state.S(0, 0)(0) = 0.8f;    // speaker -> in-ear
   p.state.S_true = p.state.S;
 
   // Use WAV file (will need to provide paths)
@@ -129,6 +134,326 @@ TEST(mic_block_has_sequence) {
   ASSERT_TRUE(lastSeq.load() > 0);
 }
 
+// Short deterministic input for the offline tests
+static std::string writeOfflineInput() {
+  const std::string path = "/tmp/test_dsp_interface_offline.wav";
+  WavWriter w(path);
+  w.open();
+  for (int b = 0; b < 64; ++b) {
+    Block x;
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i)
+      x(i) = 0.25f * std::sin(0.013f * (b * dsp::BLOCK_SIZE + i));
+    w.writeBlock(x);
+  }
+  w.close();
+  return path;
+}
+
+static std::vector<Block> renderOffline(uint64_t seed,
+                                        bool lookahead = true,
+                                        const std::string &wisdom = "") {
+  Params p = makeTestParams();
+  p.convolution.wisdomFile = wisdom;
+  p.audioConfig.inputWavPath = writeOfflineInput();
+  p.mode = RunMode::Offline;
+  p.seed = seed;
+  p.plant_lookahead = lookahead;
+  p.dynamics.noise_gain = 0.01f; // exercise the S drift too
+
+  DSPInterface dsp(p, 2);
+  std::vector<Block> inear;
+  dsp.setProcessMics([&](const MicBlock &mb, Block &control) {
+    inear.push_back(mb.inear);
+    control = -0.5f * mb.outside;
+  });
+  dsp.runOffline();
+  return inear;
+}
+
+TEST(offline_render_is_bit_reproducible) {
+  const auto a = renderOffline(1234);
+  const auto b = renderOffline(1234);
+  ASSERT_EQ(a.size(), size_t(64));
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t k = 0; k < a.size(); ++k)
+    ASSERT_TRUE(a[k] == b[k]);
+
+  const auto c = renderOffline(99);
+  bool differs = false;
+  for (size_t k = 0; k < a.size(); ++k)
+    differs |= !(a[k] == c[k]);
+  ASSERT_TRUE(differs);
+}
+
+TEST(plant_lookahead_is_bit_identical_to_serial) {
+  const auto pipelined = renderOffline(7, true);
+  const auto serial = renderOffline(7, false);
+  ASSERT_EQ(pipelined.size(), size_t(64));
+  ASSERT_EQ(pipelined.size(), serial.size());
+  for (size_t k = 0; k < serial.size(); ++k)
+    ASSERT_TRUE(pipelined[k] == serial[k]);
+}
+
+TEST(offline_controls_are_always_fresh) {
+  Params p = makeTestParams();
+  p.audioConfig.inputWavPath = writeOfflineInput();
+  p.mode = RunMode::Offline;
+  DSPInterface dsp(p, 3);
+  dsp.setProcessMics([](const MicBlock &mb, Block &control) {
+    control = -mb.outside;
+  });
+  ASSERT_EQ(dsp.runOffline(10), size_t(10));
+  ASSERT_EQ(dsp.runOffline(), size_t(54));
+  const auto stats = dsp.getControlStats();
+  ASSERT_EQ(stats.fresh, uint64_t(64 - 3));
+  ASSERT_EQ(stats.zero + stats.stale, uint64_t(0));
+  // Offline noise is rendered in place, never missed
+  const auto noise = dsp.getNoiseStats();
+  ASSERT_EQ(noise.micUnderruns + noise.driftUnderruns, uint64_t(0));
+}
+
+// Same plant at every compiled-in block size: with no control and next to
+// no noise, the in-ear mic is P * input = 0.5 * input at any block size
+template <typename Config> static float inearErrorAtBlockSize() {
+  BasicParams<Config> p;
+  p.paths.H(0, 0)(0) = 1.0f;
+  p.paths.P(0, 0)(0) = 0.5f;
+  p.paths.speaker[0](0) = 1.0f;
+  p.state.S(0, 0)(0) = 0.8f;
+  p.noise.sample_sigma = 1e-6f;
+  p.dynamics.noise_gain = 0.0f;
+  p.audioConfig.inputWavPath = writeOfflineInput();
+  p.mode = RunMode::Offline;
+
+  std::vector<float> inear;
+  BasicDSPInterface<Config> dsp(p, 2);
+  dsp.setProcessMics(
+      [&](const BasicMicBlock<Config> &mb, typename Config::Block &control) {
+        inear.insert(inear.end(), mb.inear.col(0).begin(),
+                     mb.inear.col(0).end());
+        control.setZero();
+      });
+  dsp.runOffline();
+
+  // writeOfflineInput(): 64 blocks of 256 samples
+  if (inear.size() < size_t(64 * dsp::BLOCK_SIZE))
+    return 1.0f;
+  float maxErr = 0.0f;
+  for (size_t n = 0; n < size_t(64 * dsp::BLOCK_SIZE); ++n) {
+    const float x = 0.25f * std::sin(0.013f * static_cast<float>(n));
+    maxErr = std::max(maxErr, std::abs(inear[n] - 0.5f * x));
+  }
+  return maxErr;
+}
+
+TEST(offline_render_at_every_block_size) {
+  ASSERT_NEAR(inearErrorAtBlockSize<dsp::LowLatency32Config>(), 0.0f, 1e-4f);
+  ASSERT_NEAR(inearErrorAtBlockSize<dsp::LowLatency64Config>(), 0.0f, 1e-4f);
+  ASSERT_NEAR(inearErrorAtBlockSize<dsp::DefaultConfig>(), 0.0f, 1e-4f);
+  ASSERT_NEAR(inearErrorAtBlockSize<dsp::Offline1024Config>(), 0.0f, 1e-4f);
+}
+
+// Wisdom that sends every test path to `strategy`: H, P and the folded C are
+// one block long, the drifting S is planned at its full length
+static std::string writeWisdom(ConvolutionStrategy strategy) {
+  const std::string path = "/tmp/test_dsp_interface.wisdom";
+  constexpr int folded = KernelComposer<1024, 1024>::OUT_SIZE;
+  const int B = dsp::BLOCK_SIZE;
+  const int fullS = (folded + B - 1) / B * B;
+  std::ofstream out(path);
+  out << "cpu " << ConvolutionWisdom::cpuName() << "\n";
+  for (auto [irSize, taps] :
+       {std::pair{1024, B}, std::pair{folded, B}, std::pair{folded, fullS}}) {
+    out << B << ' ' << irSize << ' ' << taps << ' '
+        << fft::backendName(fft::defaultBackend()) << ' '
+        << strategyName(strategy) << " 0 0 0\n";
+  }
+  return path;
+}
+
+TEST(offline_render_with_every_convolution_strategy) {
+  // No wisdom: every path partitioned
+  ConvolutionWisdom none;
+  for (ConvolutionStrategy planned :
+       DSPInterface::planPaths(makeTestParams(), none, TuneMode::Never))
+    ASSERT_TRUE(planned == ConvolutionStrategy::Partitioned);
+
+  const auto reference = renderOffline(5);
+  for (ConvolutionStrategy s : kConvolutionStrategies) {
+    const std::string wisdom = writeWisdom(s);
+    Params p = makeTestParams();
+    p.audioConfig.inputWavPath = writeOfflineInput();
+    p.convolution.wisdomFile = wisdom;
+    p.dynamics.noise_gain = 0.01f; // as renderOffline()
+    {
+      DSPInterface dsp(p, 2);
+      for (ConvolutionStrategy planned : dsp.getPathPlan())
+        ASSERT_TRUE(planned == s);
+    }
+
+    const auto inear = renderOffline(5, true, wisdom);
+    ASSERT_EQ(inear.size(), reference.size());
+    float maxErr = 0.0f;
+    for (size_t k = 0; k < inear.size(); ++k)
+      maxErr =
+          std::max(maxErr, (inear[k] - reference[k]).cwiseAbs().maxCoeff());
+    ASSERT_NEAR(maxErr, 0.0f, 1e-4f);
+  }
+}
+
+TEST(offline_render_matches_across_fft_backends) {
+  // Kiss and Split round differently: the same render within float
+  // rounding, not bit for bit
+  const fft::Backend saved = fft::defaultBackend();
+  fft::setDefaultBackend(fft::Backend::Kiss);
+  const auto kiss = renderOffline(11);
+  fft::setDefaultBackend(fft::Backend::Split);
+  const auto split = renderOffline(11);
+  fft::setDefaultBackend(saved);
+
+  ASSERT_EQ(kiss.size(), size_t(64));
+  ASSERT_EQ(kiss.size(), split.size());
+  float maxErr = 0.0f, peak = 0.0f;
+  for (size_t k = 0; k < kiss.size(); ++k) {
+    maxErr = std::max(maxErr, (kiss[k] - split[k]).cwiseAbs().maxCoeff());
+    peak = std::max(peak, kiss[k].cwiseAbs().maxCoeff());
+  }
+  ASSERT_TRUE(peak > 0.01f);
+  ASSERT_NEAR(maxErr, 0.0f, 1e-5f);
+}
+
+// Mic blocks of an offline render with the feedforward control of
+// renderOffline() on every speaker (speaker l fed from reference mic l)
+static std::vector<MicBlock> renderMimo(Params &p) {
+  p.audioConfig.inputWavPath = writeOfflineInput();
+  p.mode = RunMode::Offline;
+  p.seed = 5;
+  DSPInterface dsp(p, 2);
+  std::vector<MicBlock> mics;
+  dsp.setProcessMics([&](const MicBlock &mb, Control &control) {
+    mics.push_back(mb);
+    for (Eigen::Index l = 0; l < control.cols(); ++l)
+      control.col(l) = -0.5f * mb.outside.col(l % mb.outside.cols());
+  });
+  dsp.runOffline();
+  return mics;
+}
+
+TEST(extra_channels_leave_the_first_mics_unchanged) {
+  Params siso = makeTestParams();
+  const auto reference = renderMimo(siso);
+
+  // Two of everything; speaker 1 is heard by the second mics only
+  Params p = makeTestParams();
+  p.setTopology({2, 2, 2});
+  p.paths.H(1, 0)(1) = 0.7f;
+  p.paths.P(1, 0)(2) = 0.3f;
+  p.paths.C(1, 0)(0) = 0.05f;
+  p.paths.C(1, 1)(0) = 0.1f;
+  p.paths.speaker[1](0) = 1.0f;
+  p.state.S(1, 0)(4) = 0.2f;
+  p.state.S(1, 1)(0) = 0.8f;
+  p.state.S_true = p.state.S;
+  const auto mimo = renderMimo(p);
+
+  ASSERT_EQ(mimo.size(), reference.size());
+  float maxErr = 0.0f;
+  bool secondMicsLive = false;
+  for (size_t k = 0; k < mimo.size(); ++k) {
+    ASSERT_EQ(mimo[k].outside.cols(), Eigen::Index(2));
+    ASSERT_EQ(mimo[k].inear.cols(), Eigen::Index(2));
+    maxErr = std::max(maxErr, (mimo[k].outside.col(0) - reference[k].outside)
+                                  .cwiseAbs()
+                                  .maxCoeff());
+    maxErr = std::max(
+        maxErr,
+        (mimo[k].inear.col(0) - reference[k].inear).cwiseAbs().maxCoeff());
+    secondMicsLive |= mimo[k].inear.col(1).cwiseAbs().maxCoeff() > 1e-3f;
+  }
+  ASSERT_NEAR(maxErr, 0.0f, 1e-5f);
+  ASSERT_TRUE(secondMicsLive);
+}
+
+TEST(each_speaker_reaches_its_own_paths) {
+  // No noise paths: the second error mic hears speaker 1 three samples late,
+  // nothing else is connected
+  Params p = makeTestParams();
+  p.setTopology({1, 2, 2});
+  p.paths.H(0, 0).setZero();
+  p.paths.P(0, 0).setZero();
+  p.paths.C(0, 0).setZero();
+  p.state.S(0, 0).setZero();
+  p.paths.speaker[1](0) = 1.0f;
+  p.state.S(1, 1)(3) = 1.0f;
+  p.state.S_true = p.state.S;
+  p.audioConfig.inputWavPath = writeOfflineInput();
+  p.mode = RunMode::Offline;
+
+  DSPInterface dsp(p, 2);
+  std::vector<MicBlock> mics;
+  dsp.setProcessMics([&](const MicBlock &mb, Control &control) {
+    mics.push_back(mb);
+    control.col(1).setConstant(static_cast<float>(mb.seq % 7) + 1.0f);
+  });
+  dsp.runOffline();
+
+  ASSERT_EQ(mics.size(), size_t(64));
+  float previous = 0.0f, stray = 0.0f, peak = 0.0f;
+  for (const MicBlock &mb : mics) {
+    stray = std::max(stray, mb.outside.cwiseAbs().maxCoeff());
+    stray = std::max(stray, mb.inear.col(0).cwiseAbs().maxCoeff());
+    // A constant per block, delayed by 3 samples
+    const auto e1 = mb.inear.col(1);
+    const float current = e1(dsp::BLOCK_SIZE - 1);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i)
+      ASSERT_NEAR(e1(i), i < 3 ? previous : current, 1e-4f);
+    previous = current;
+    peak = std::max(peak, current);
+  }
+  ASSERT_NEAR(stray, 0.0f, 1e-5f);
+  ASSERT_NEAR(peak, 7.0f, 1e-4f);
+}
+
+TEST(mismatched_path_matrices_are_rejected) {
+  auto rejects = [](const Params &p) {
+    try {
+      Params copy = p;
+      DSPInterface dsp(copy, 2);
+    } catch (const std::invalid_argument &) {
+      return true;
+    }
+    return false;
+  };
+
+  Params p = makeTestParams();
+  p.mode = RunMode::Offline;
+  p.paths.C.resize(1, 2); // two speakers' worth of C, one speaker
+  ASSERT_TRUE(rejects(p));
+
+  p = makeTestParams();
+  p.mode = RunMode::Offline;
+  p.paths.resize({1, 2, 1}); // S still 1 x 1
+  ASSERT_TRUE(rejects(p));
+
+  p = makeTestParams();
+  p.mode = RunMode::Offline;
+  p.setTopology({MAX_REFERENCE_MICS + 1, 1, 1});
+  ASSERT_TRUE(rejects(p));
+}
+
+TEST(positive_ir_tolerance_is_rejected) {
+  Params p = makeTestParams();
+  p.mode = RunMode::Offline;
+  p.convolution.irToleranceDb = 6.0f; // would zero every kernel
+  bool threw = false;
+  try {
+    DSPInterface dsp(p, 2);
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT_TRUE(threw);
+}
+
 int main() {
   RUN_TEST(constructs_and_destructs);
   RUN_TEST(getMics_returns_data);
@@ -136,6 +461,16 @@ int main() {
   RUN_TEST(processMics_callback_invoked);
   RUN_TEST(zero_control_inear_matches_noise_path);
   RUN_TEST(mic_block_has_sequence);
+  RUN_TEST(offline_render_is_bit_reproducible);
+  RUN_TEST(plant_lookahead_is_bit_identical_to_serial);
+  RUN_TEST(offline_controls_are_always_fresh);
+  RUN_TEST(offline_render_at_every_block_size);
+  RUN_TEST(offline_render_with_every_convolution_strategy);
+  RUN_TEST(offline_render_matches_across_fft_backends);
+  RUN_TEST(extra_channels_leave_the_first_mics_unchanged);
+  RUN_TEST(each_speaker_reaches_its_own_paths);
+  RUN_TEST(mismatched_path_matrices_are_rejected);
+  RUN_TEST(positive_ir_tolerance_is_rejected);
   PRINT_RESULTS();
   return g_fails > 0 ? 1 : 0;
 }
@@ -0,0 +1,182 @@
+// Tests for FastLinearSystem<IR_SIZE> (FFT overlap-save convolution)
+#include "test_harness.h"
+#include "utils/FastLinearSystem.h"
+#include "utils/LinearSystem.h"
+
+using FLS = FastLinearSystem<dsp::IR_SIZE>;
+using FLSFull = FastLinearSystem<dsp::IR_SIZE, false>;
+using LS = LinearSystem<dsp::IR_SIZE>;
+using Block = FLS::Block;
+using IRBlock = FLS::IRBlock;
+
+// Run `blocks` random blocks through both systems and compare sample by
+// sample against the direct-form reference.
+template <typename Sys>
+static float maxErrorVsDirect(Sys &sys, const IRBlock &h, int blocks) {
+  LS ref(h);
+  sys.setImpulseResponse(h);
+  float maxErr = 0.0f;
+  for (int b = 0; b < blocks; ++b) {
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    sys.step(x, y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      const float tol = std::max(1.0f, std::abs(yRef(i)));
+      maxErr = std::max(maxErr, std::abs(y(i) - yRef(i)) / tol);
+    }
+  }
+  return maxErr;
+}
+
+TEST(zero_ir_produces_zero) {
+  FLS sys;
+  Block input = Block::Ones();
+  Block output;
+  sys.step(input, output);
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+    ASSERT_NEAR(output(i), 0.0f, 1e-6f);
+  }
+}
+
+TEST(delta_ir_is_passthrough) {
+  IRBlock h = IRBlock::Zero();
+  h(0) = 1.0f;
+  FLS sys(h);
+  Block input;
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i)
+    input(i) = static_cast<float>(i + 1);
+
+  Block output;
+  sys.step(input, output);
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+    ASSERT_NEAR(output(i), input(i), 1e-3f);
+  }
+}
+
+TEST(tail_longer_than_block_is_accumulated) {
+  // Impulse at the start of block 0 must reappear IR_SIZE-1 samples later,
+  // i.e. several blocks downstream.
+  IRBlock h = IRBlock::Zero();
+  h(dsp::IR_SIZE - 1) = 1.0f;
+  FLS sys(h);
+
+  Block x = Block::Zero();
+  x(0) = 1.0f;
+  Block y;
+  sys.step(x, y);
+  x.setZero();
+  const int target = dsp::IR_SIZE - 1;
+  for (int b = 1; b <= target / static_cast<int>(dsp::BLOCK_SIZE); ++b) {
+    sys.step(x, y);
+  }
+  ASSERT_NEAR(y(target % dsp::BLOCK_SIZE), 1.0f, 1e-5f);
+}
+
+TEST(half_spectrum_matches_direct_form) {
+  IRBlock h = IRBlock::Random();
+  FLS sys;
+  ASSERT_TRUE(maxErrorVsDirect(sys, h, 12) < 1e-4f);
+}
+
+TEST(full_spectrum_matches_direct_form) {
+  IRBlock h = IRBlock::Random();
+  FLSFull sys;
+  ASSERT_TRUE(maxErrorVsDirect(sys, h, 12) < 1e-4f);
+}
+
+TEST(half_and_full_spectrum_agree) {
+  IRBlock h = IRBlock::Random();
+  FLS half(h);
+  FLSFull full(h);
+  for (int b = 0; b < 8; ++b) {
+    Block x = Block::Random();
+    Block y1, y2;
+    half.step(x, y1);
+    full.step(x, y2);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y1(i), y2(i), 1e-4f * std::max(1.0f, std::abs(y2(i))));
+    }
+  }
+}
+
+TEST(short_ir_matches_direct_form) {
+  // IR shorter than a block: overlap never spans more than one block
+  using Short = FastLinearSystem<64>;
+  LinearSystem<64> ref(Short::IRBlock::Random());
+  Short sys(ref.getImpulseResponse());
+  for (int b = 0; b < 4; ++b) {
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    sys.step(x, y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y(i), yRef(i), 1e-4f);
+    }
+  }
+}
+
+TEST(half_spectrum_halves_kernel_storage) {
+  ASSERT_EQ(FLS::NUM_BINS, FLS::FFT_SIZE / 2 + 1);
+  ASSERT_EQ(FLSFull::NUM_BINS, FLSFull::FFT_SIZE);
+}
+
+TEST(prepared_kernel_crossfades_over_one_block) {
+  // First block after the swap: (1 - w) * old + w * new; afterwards the new
+  // kernel alone, including the tails of the crossfade block's input
+  IRBlock h1 = IRBlock::Random(), h2 = IRBlock::Random();
+  FLS sys(h1), ref1(h1), ref2(h2);
+  const auto &fadeOut = crossfadeOutRamp();
+
+  Block x = Block::Random();
+  Block y, y1, y2;
+  sys.prepareImpulseResponse(h2);
+  sys.step(x, y);
+  ref1.step(x, y1);
+  ref2.step(x, y2);
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+    const float expected = fadeOut(i) * y1(i) + (1.0f - fadeOut(i)) * y2(i);
+    ASSERT_NEAR(y(i), expected, 1e-4f);
+  }
+  ASSERT_NEAR(sys.getImpulseResponse()(7), h2(7), 1e-7f);
+
+  for (int b = 0; b < 6; ++b) {
+    x = Block::Random();
+    sys.step(x, y);
+    ref2.step(x, y2);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y(i), y2(i), 1e-4f);
+    }
+  }
+}
+
+TEST(preparing_same_kernel_is_transparent) {
+  IRBlock h = IRBlock::Random();
+  FLS sys(h), ref(h);
+  for (int b = 0; b < 6; ++b) {
+    if (b % 2 == 1)
+      sys.prepareImpulseResponse(h);
+    Block x = Block::Random();
+    Block y, yRef;
+    sys.step(x, y);
+    ref.step(x, yRef);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y(i), yRef(i), 1e-4f);
+    }
+  }
+}
+
+int main() {
+  RUN_TEST(zero_ir_produces_zero);
+  RUN_TEST(delta_ir_is_passthrough);
+  RUN_TEST(tail_longer_than_block_is_accumulated);
+  RUN_TEST(half_spectrum_matches_direct_form);
+  RUN_TEST(full_spectrum_matches_direct_form);
+  RUN_TEST(half_and_full_spectrum_agree);
+  RUN_TEST(short_ir_matches_direct_form);
+  RUN_TEST(half_spectrum_halves_kernel_storage);
+  RUN_TEST(prepared_kernel_crossfades_over_one_block);
+  RUN_TEST(preparing_same_kernel_is_transparent);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
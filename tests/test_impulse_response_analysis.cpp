@@ -0,0 +1,98 @@
+// Tests for the impulse response analysis (effective length, tolerance trim)
+#include "test_harness.h"
+#include "utils/ImpulseResponseAnalysis.h"
+
+#include <cmath>
+#include <stdexcept>
+
+using IR = Eigen::Matrix<float, 1024, 1>;
+
+// Exponentially decaying response, as the simulated acoustic paths
+static IR decaying(float rate) {
+  IR h;
+  for (int i = 0; i < h.size(); ++i)
+    h(i) = 0.5f * std::exp(-rate * i);
+  return h;
+}
+
+TEST(effective_length_ignores_interior_zeros) {
+  IR h = IR::Zero();
+  h(3) = 1.0f;
+  h(700) = 0.25f;
+  ASSERT_EQ(effectiveLength(h), 701);
+  ASSERT_EQ(effectiveLength(IR::Zero().eval()), 0);
+}
+
+TEST(exact_tolerance_keeps_everything) {
+  IR h = decaying(0.01f);
+  const IR before = h;
+  ASSERT_EQ(trimToTolerance(h, 256, kExactTolerance), 0.0f);
+  ASSERT_TRUE(h == before);
+}
+
+TEST(decayed_tail_is_trimmed_within_tolerance) {
+  IR h = decaying(0.02f);
+  const IR before = h;
+  const float removed = trimToTolerance(h, 256, -60.0f);
+  ASSERT_TRUE(removed > 0.0f);
+  ASSERT_TRUE(removed <= 1e-6f);
+  // Energy falls 0.17 dB per tap: the last 60 dB start after ~345 taps
+  ASSERT_TRUE(effectiveLength(h) > 300);
+  ASSERT_TRUE(effectiveLength(h) < 400);
+  // What is kept is untouched
+  const int kept = effectiveLength(h);
+  ASSERT_TRUE(h.head(kept) == before.head(kept));
+  const double err = (h - before).cast<double>().squaredNorm() /
+                     before.cast<double>().squaredNorm();
+  ASSERT_NEAR(err, removed, 1e-9);
+}
+
+TEST(quiet_interior_partition_is_zeroed) {
+  IR h = IR::Random();
+  h.segment(256, 256) *= 1e-5f; // -100 dB gap between two loud partitions
+  const float removed = trimToTolerance(h, 256, -60.0f);
+  ASSERT_TRUE(removed <= 1e-6f);
+  ASSERT_TRUE(h.segment(256, 256).isZero(0.0f));
+  ASSERT_TRUE(h.segment(512, 256).cwiseAbs().maxCoeff() > 0.1f);
+  ASSERT_EQ(effectiveLength(h), 1024);
+}
+
+TEST(loud_response_is_left_alone) {
+  IR h = IR::Random();
+  const IR before = h;
+  trimToTolerance(h, 256, -100.0f);
+  // Random taps of ~0.3: no partition holds less than 1e-10 of the energy
+  ASSERT_TRUE(h.head(1000) == before.head(1000));
+}
+
+TEST(zero_response_is_unchanged) {
+  IR h = IR::Zero();
+  ASSERT_EQ(trimToTolerance(h, 256, -40.0f), 0.0f);
+  ASSERT_TRUE(h.isZero(0.0f));
+}
+
+TEST(tolerance_of_0db_or_more_is_rejected) {
+  for (float db : {0.0f, 3.0f, std::nanf("")}) {
+    bool threw = false;
+    try {
+      checkToleranceDb(db);
+    } catch (const std::invalid_argument &) {
+      threw = true;
+    }
+    ASSERT_TRUE(threw);
+  }
+  checkToleranceDb(-100.0f);
+  checkToleranceDb(kExactTolerance);
+}
+
+int main() {
+  RUN_TEST(effective_length_ignores_interior_zeros);
+  RUN_TEST(exact_tolerance_keeps_everything);
+  RUN_TEST(decayed_tail_is_trimmed_within_tolerance);
+  RUN_TEST(quiet_interior_partition_is_zeroed);
+  RUN_TEST(loud_response_is_left_alone);
+  RUN_TEST(zero_response_is_unchanged);
+  RUN_TEST(tolerance_of_0db_or_more_is_rejected);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// Tests for KernelComposer / composeImpulseResponses / composeCascade
+#include "test_harness.h"
+#include "utils/FastLinearSystem.h"
+#include "utils/KernelComposition.h"
+#include "utils/LinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+using IRBlock = Eigen::Matrix<float, dsp::IR_SIZE, 1>;
+using Block = Partitioning::Block;
+using Composer = KernelComposer<dsp::IR_SIZE, dsp::IR_SIZE>;
+
+TEST(composed_length_and_fft_size) {
+  ASSERT_EQ(Composer::OUT_SIZE, static_cast<int>(2 * dsp::IR_SIZE - 1));
+  ASSERT_TRUE(Composer::FFT_SIZE >= Composer::OUT_SIZE);
+  ASSERT_EQ(compositionFFTSize(1279), 2048);
+  ASSERT_EQ(compositionFFTSize(2048), 2048);
+}
+
+TEST(matches_direct_convolution) {
+  IRBlock a = IRBlock::Random();
+  IRBlock b = IRBlock::Random();
+  Composer composer;
+  composer.setFirst(a);
+  Composer::Composed c = composer.compose(b);
+
+  // Spot-check against the convolution sum, including the last tap, which
+  // would be corrupted by wrap-around if the FFT were too short
+  constexpr int IR = static_cast<int>(dsp::IR_SIZE);
+  for (int n : {0, 1, 500, 1023, 1500, 2046}) {
+    float ref = 0.0f;
+    for (int k = 0; k <= n; ++k) {
+      if (k < IR && n - k < IR)
+        ref += a(k) * b(n - k);
+    }
+    ASSERT_NEAR(c(n), ref, 1e-3f);
+  }
+}
+
+TEST(folded_kernel_equals_cascade) {
+  // speaker -> C as two engines vs. one engine with speaker*C
+  IRBlock spk = IRBlock::Zero();
+  spk(0) = 0.9f;
+  spk(5) = 0.2f;
+  spk(300) = -0.1f;
+  IRBlock C = IRBlock::Random();
+
+  PartitionedLinearSystem<dsp::IR_SIZE> stage1(spk), stage2(C);
+  Composer composer;
+  composer.setFirst(spk);
+  PartitionedLinearSystem<Composer::OUT_SIZE> folded(composer.compose(C));
+
+  for (int blk = 0; blk < 12; ++blk) {
+    Block x = Block::Random();
+    Block mid, yCascade, yFolded;
+    stage1.step(x, mid);
+    stage2.step(mid, yCascade);
+    folded.step(x, yFolded);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(yFolded(i), yCascade(i),
+                  1e-4f * std::max(1.0f, std::abs(yCascade(i))));
+    }
+  }
+}
+
+TEST(recompose_after_second_kernel_changes) {
+  IRBlock a = IRBlock::Zero();
+  a(2) = 1.0f; // pure delay of 2
+  Composer composer;
+  composer.setFirst(a);
+
+  IRBlock b = IRBlock::Random();
+  Composer::Composed c1 = composer.compose(b);
+  IRBlock b2 = IRBlock::Random();
+  Composer::Composed c2 = composer.compose(b2);
+  for (int i = 0; i < static_cast<int>(dsp::IR_SIZE); ++i) {
+    ASSERT_NEAR(c1(i + 2), b(i), 1e-5f);
+    ASSERT_NEAR(c2(i + 2), b2(i), 1e-5f);
+  }
+}
+
+TEST(compose_cascade_of_engines) {
+  using Short = FastLinearSystem<64>;
+  Short::IRBlock h1 = Short::IRBlock::Random();
+  Short::IRBlock h2 = Short::IRBlock::Random();
+  Short::IRBlock h3 = Short::IRBlock::Random();
+  Short s1(h1), s2(h2), s3(h3);
+
+  Eigen::VectorXf h = composeCascade(s1, s2, s3);
+  ASSERT_EQ(h.size(), 64 * 3 - 2);
+
+  // Feed an impulse through the chain and compare with the folded kernel
+  Block x = Block::Zero();
+  x(0) = 1.0f;
+  Block y1, y2, y3;
+  s1.step(x, y1);
+  s2.step(y1, y2);
+  s3.step(y2, y3);
+  for (int i = 0; i < h.size(); ++i) {
+    ASSERT_NEAR(y3(i), h(i), 1e-4f);
+  }
+}
+
+TEST(compose_impulse_responses_of_different_lengths) {
+  Eigen::VectorXf a = Eigen::VectorXf::Random(10);
+  Eigen::VectorXf b = Eigen::VectorXf::Random(300);
+  Eigen::VectorXf c = composeImpulseResponses(a, b);
+  ASSERT_EQ(c.size(), 309);
+  float ref = 0.0f;
+  for (int k = 0; k < 10; ++k)
+    ref += a(k) * b(299 - k);
+  ASSERT_NEAR(c(299), ref, 1e-4f);
+}
+
+int main() {
+  RUN_TEST(composed_length_and_fft_size);
+  RUN_TEST(matches_direct_convolution);
+  RUN_TEST(folded_kernel_equals_cascade);
+  RUN_TEST(recompose_after_second_kernel_changes);
+  RUN_TEST(compose_cascade_of_engines);
+  RUN_TEST(compose_impulse_responses_of_different_lengths);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
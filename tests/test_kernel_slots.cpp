@@ -0,0 +1,94 @@
+// Tests for KernelSlots<Kernel> (lock-free kernel handoff to the audio thread)
+#include "test_harness.h"
+#include "utils/KernelSlots.h"
+
+#include <array>
+#include <thread>
+
+TEST(acquire_without_publish_keeps_front) {
+  KernelSlots<int> slots;
+  slots.setupFront() = 7;
+  ASSERT_TRUE(!slots.acquire());
+  ASSERT_TRUE(!slots.changed());
+  ASSERT_EQ(slots.front(), 7);
+}
+
+TEST(publish_then_acquire_swaps_and_keeps_previous) {
+  KernelSlots<int> slots;
+  slots.setupFront() = 1;
+  slots.back() = 2;
+  slots.publish();
+  ASSERT_TRUE(slots.acquire());
+  ASSERT_EQ(slots.front(), 2);
+  ASSERT_EQ(slots.previous(), 1);
+  ASSERT_TRUE(!slots.acquire()); // change is reported once
+  ASSERT_EQ(slots.front(), 2);
+}
+
+TEST(latest_publish_wins) {
+  KernelSlots<int> slots;
+  for (int v = 1; v <= 5; ++v) {
+    slots.back() = v;
+    slots.publish();
+  }
+  ASSERT_TRUE(slots.acquire());
+  ASSERT_EQ(slots.front(), 5);
+}
+
+TEST(setupFront_discards_pending) {
+  KernelSlots<int> slots;
+  slots.back() = 3;
+  slots.publish();
+  slots.setupFront() = 9;
+  ASSERT_TRUE(!slots.acquire());
+  ASSERT_EQ(slots.front(), 9);
+}
+
+TEST(concurrent_publish_is_never_torn_or_reordered) {
+  // Each kernel is written as N copies of one value; the consumer must only
+  // ever see complete kernels, in non-decreasing order.
+  struct K {
+    std::array<int, 64> v{};
+  };
+  KernelSlots<K> slots;
+  constexpr int N = 200000;
+  std::jthread producer([&] {
+    for (int i = 1; i <= N; ++i) {
+      slots.back().v.fill(i);
+      slots.publish();
+    }
+  });
+
+  int last = 0;
+  bool torn = false, reordered = false;
+  while (last < N) {
+    if (!slots.acquire())
+      continue;
+    const K &k = slots.front();
+    for (int x : k.v)
+      torn |= (x != k.v[0]);
+    reordered |= (k.v[0] <= last);
+    last = k.v[0];
+  }
+  ASSERT_TRUE(!torn);
+  ASSERT_TRUE(!reordered);
+}
+
+TEST(crossfade_ramp_ends_at_zero) {
+  const auto &r = crossfadeOutRamp();
+  ASSERT_NEAR(r(dsp::BLOCK_SIZE - 1), 0.0f, 1e-7f);
+  ASSERT_NEAR(r(0), 1.0f - 1.0f / dsp::BLOCK_SIZE, 1e-7f);
+  for (int i = 1; i < static_cast<int>(dsp::BLOCK_SIZE); ++i)
+    ASSERT_TRUE(r(i) < r(i - 1));
+}
+
+int main() {
+  RUN_TEST(acquire_without_publish_keeps_front);
+  RUN_TEST(publish_then_acquire_swaps_and_keeps_previous);
+  RUN_TEST(latest_publish_wins);
+  RUN_TEST(setupFront_discards_pending);
+  RUN_TEST(concurrent_publish_is_never_torn_or_reordered);
+  RUN_TEST(crossfade_ramp_ends_at_zero);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+// Tests for LatencyHistogram (lock-free HDR-style histogram)
+#include "test_harness.h"
+#include "utils/LatencyHistogram.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST(empty_histogram_reports_zero) {
+  LatencyHistogram h;
+  ASSERT_EQ(h.count(), 0u);
+  ASSERT_EQ(h.percentile(0.99), 0u);
+  ASSERT_EQ(h.summary().maxNs, 0u);
+}
+
+TEST(small_values_are_exact) {
+  LatencyHistogram h;
+  for (uint64_t v = 0; v < 32; ++v)
+    h.record(v);
+  ASSERT_EQ(h.percentile(0.5), 15u);
+  ASSERT_EQ(h.summary().minNs, 0u);
+  ASSERT_EQ(h.summary().maxNs, 31u);
+}
+
+TEST(bucket_bounds_contain_value_within_resolution) {
+  for (uint64_t v : {33ull, 100ull, 1000ull, 5333333ull, 123456789012ull}) {
+    const size_t i = LatencyHistogram::bucketIndex(v);
+    const uint64_t upper = LatencyHistogram::bucketUpperBound(i);
+    ASSERT_TRUE(upper >= v);
+    ASSERT_TRUE(static_cast<double>(upper - v) <=
+                static_cast<double>(v) / LatencyHistogram::SUB_BUCKETS);
+    if (i > 0)
+      ASSERT_TRUE(LatencyHistogram::bucketUpperBound(i - 1) < v);
+  }
+}
+
+TEST(bucket_indices_are_monotonic_and_in_range) {
+  size_t last = 0;
+  for (uint64_t v = 1; v < LatencyHistogram::MAX_VALUE; v = v * 3 / 2 + 1) {
+    const size_t i = LatencyHistogram::bucketIndex(v);
+    ASSERT_TRUE(i >= last);
+    ASSERT_TRUE(i < LatencyHistogram::NUM_BUCKETS);
+    last = i;
+  }
+  ASSERT_EQ(LatencyHistogram::bucketIndex(LatencyHistogram::MAX_VALUE),
+            LatencyHistogram::NUM_BUCKETS - 1);
+}
+
+TEST(percentiles_of_uniform_distribution) {
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 100000; ++v)
+    h.record(v * 100); // 100 ns .. 10 ms
+  auto s = h.summary();
+  ASSERT_EQ(s.count, 100000u);
+  ASSERT_NEAR(static_cast<double>(s.p50Ns), 5.0e6, 5.0e6 * 0.04);
+  ASSERT_NEAR(static_cast<double>(s.p99Ns), 9.9e6, 9.9e6 * 0.04);
+  ASSERT_NEAR(s.meanNs, 5.00005e6, 1.0);
+  ASSERT_TRUE(s.p999Ns <= s.maxNs);
+}
+
+TEST(tail_is_visible) {
+  LatencyHistogram h;
+  for (int i = 0; i < 9990; ++i)
+    h.record(std::chrono::microseconds(50));
+  for (int i = 0; i < 10; ++i)
+    h.record(std::chrono::milliseconds(8));
+  ASSERT_TRUE(h.percentile(0.99) < 60000u);
+  ASSERT_TRUE(h.percentile(0.9995) >= 7'750'000u);
+}
+
+TEST(concurrent_records_are_all_counted) {
+  LatencyHistogram h;
+  std::vector<std::jthread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&h, t] {
+      for (int i = 0; i < 100000; ++i)
+        h.record(static_cast<uint64_t>(1000 * (t + 1) + i % 97));
+    });
+  threads.clear();
+  ASSERT_EQ(h.count(), 400000u);
+  ASSERT_EQ(h.summary().minNs, 1000u);
+  ASSERT_EQ(h.summary().maxNs, 4096u);
+}
+
+TEST(json_has_percentiles) {
+  LatencyHistogram h;
+  h.record(1000);
+  std::ostringstream os;
+  h.writeJson(os);
+  const std::string j = os.str();
+  ASSERT_TRUE(j.find("\"count\": 1") != std::string::npos);
+  ASSERT_TRUE(j.find("\"p999_ns\"") != std::string::npos);
+  ASSERT_TRUE(j.front() == '{' && j.back() == '}');
+}
+
+int main() {
+  RUN_TEST(empty_histogram_reports_zero);
+  RUN_TEST(small_values_are_exact);
+  RUN_TEST(bucket_bounds_contain_value_within_resolution);
+  RUN_TEST(bucket_indices_are_monotonic_and_in_range);
+  RUN_TEST(percentiles_of_uniform_distribution);
+  RUN_TEST(tail_is_visible);
+  RUN_TEST(concurrent_records_are_all_counted);
+  RUN_TEST(json_has_percentiles);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
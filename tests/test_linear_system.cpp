@@ -2,6 +2,9 @@
 #include "test_harness.h"
 #include "utils/LinearSystem.h"
 
+#include <cstdlib>
+#include <vector>
+
 using LS = LinearSystem<dsp::IR_SIZE>;
 using Block = LS::Block;
 using IRBlock = LS::IRBlock;
@@ -117,6 +120,34 @@ TEST(linearity) {
   }
 }
 
+// Many blocks at a small block size, so the history ring wraps several
+// times: every output still sees exactly the last IR_SIZE inputs
+TEST(history_wraps_at_small_block_size) {
+  using Cfg = dsp::LowLatency32Config;
+  using Sys = LinearSystem<300, Cfg>;
+  constexpr int B = static_cast<int>(Cfg::BLOCK_SIZE);
+  const Sys::IRBlock h = Sys::IRBlock::Random();
+  Sys sys(h);
+
+  const int blocks = 4 * Sys::HISTORY_SIZE / B + 3;
+  std::vector<float> x(blocks * B);
+  for (float &v : x)
+    v = static_cast<float>(std::rand()) / RAND_MAX - 0.5f;
+  for (int b = 0; b < blocks; ++b) {
+    Cfg::Block in, out;
+    for (int i = 0; i < B; ++i)
+      in(i) = x[b * B + i];
+    sys.step(in, out);
+    for (int i = 0; i < B; ++i) {
+      const int n = b * B + i;
+      double expected = 0.0;
+      for (int k = 0; k < 300 && k <= n; ++k)
+        expected += double(h(k)) * x[n - k];
+      ASSERT_NEAR(out(i), expected, 1e-4);
+    }
+  }
+}
+
 int main() {
   RUN_TEST(zero_ir_produces_zero);
   RUN_TEST(delta_ir_is_passthrough);
@@ -125,6 +156,7 @@ int main() {
   RUN_TEST(impulse_response_recovery);
   RUN_TEST(setImpulseResponse);
   RUN_TEST(linearity);
+  RUN_TEST(history_wraps_at_small_block_size);
   PRINT_RESULTS();
   return g_fails > 0 ? 1 : 0;
 }
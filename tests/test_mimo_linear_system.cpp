@@ -0,0 +1,163 @@
+// Tests for MimoLinearSystem<IR_SIZE> (path matrix over one shared,
+// channel-interleaved input delay line)
+#include "test_harness.h"
+#include "utils/MimoLinearSystem.h"
+#include "utils/MultiKernelLinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+using Mimo = MimoLinearSystem<dsp::IR_SIZE>;
+using PLS = PartitionedLinearSystem<dsp::IR_SIZE>;
+using Block = Mimo::Block;
+using IRBlock = Mimo::IRBlock;
+
+TEST(single_input_is_bit_identical_to_multi_kernel) {
+  // The plant's noise side: one input, a kernel per mic, swaps included
+  using MK = MultiKernelLinearSystem<dsp::IR_SIZE, 2>;
+  std::array<IRBlock, 2> h = {IRBlock::Random(), IRBlock::Random()};
+  Mimo mimo(1, 2);
+  MK mk;
+  for (int m = 0; m < 2; ++m) {
+    mimo.setImpulseResponse(m, 0, h[m]);
+    mk.setImpulseResponse(m, h[m]);
+  }
+  SpectralSum a, b;
+
+  for (int k = 0; k < 8; ++k) {
+    if (k == 3) {
+      const IRBlock next = IRBlock::Random();
+      mimo.prepareImpulseResponses(1, std::span(&next, 1));
+      mk.prepareImpulseResponse(1, next);
+    }
+    Block x = Block::Random();
+    mimo.push(x);
+    mk.push(x);
+    for (int m = 0; m < 2; ++m) {
+      ASSERT_EQ(mimo.kernelChanged(m), mk.kernelChanged(m));
+      Block y, yRef;
+      a.clear();
+      mimo.accumulate(m, a);
+      a.finish(y);
+      b.clear();
+      mk.accumulate(m, b);
+      b.finish(yRef);
+      ASSERT_TRUE(std::memcmp(y.data(), yRef.data(), sizeof(y)) == 0);
+    }
+  }
+}
+
+TEST(each_output_sums_its_row) {
+  // 3 inputs x 2 outputs against one engine per path
+  constexpr int J = 3, M = 2;
+  Mimo mimo(J, M);
+  std::vector<PLS> ref(J * M);
+  for (int m = 0; m < M; ++m)
+    for (int j = 0; j < J; ++j) {
+      const IRBlock h = IRBlock::Random();
+      mimo.setImpulseResponse(m, j, h);
+      ref[m * J + j].setImpulseResponse(h);
+    }
+  SpectralSum sum;
+
+  for (int k = 0; k < 6; ++k) {
+    const Eigen::Matrix<float, dsp::BLOCK_SIZE, J> x =
+        Eigen::Matrix<float, dsp::BLOCK_SIZE, J>::Random();
+    mimo.push(x);
+    std::array<Block, M> expected;
+    for (int m = 0; m < M; ++m) {
+      expected[m].setZero();
+      for (int j = 0; j < J; ++j) {
+        Block y;
+        ref[m * J + j].step(x.col(j), y);
+        expected[m] += y;
+      }
+    }
+    for (int m = 0; m < M; ++m) {
+      Block y;
+      sum.clear();
+      mimo.accumulate(m, sum);
+      sum.finish(y);
+      for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i)
+        ASSERT_NEAR(y(i), expected[m](i),
+                    1e-4f * std::max(1.0f, std::abs(expected[m](i))));
+    }
+  }
+}
+
+TEST(sparse_row_keeps_other_entries) {
+  // A one-tap response in the second block of input 1 only; input 0 silent
+  Mimo mimo(2, 1);
+  IRBlock h = IRBlock::Zero();
+  h(dsp::BLOCK_SIZE + 2) = 1.0f;
+  mimo.setImpulseResponse(0, 1, h);
+  ASSERT_NEAR(mimo.getImpulseResponse(0, 1)(dsp::BLOCK_SIZE + 2), 1.0f, 0.0f);
+  ASSERT_NEAR(mimo.getImpulseResponse(0, 0).cwiseAbs().sum(), 0.0f, 0.0f);
+
+  Eigen::Matrix<float, dsp::BLOCK_SIZE, 2> x =
+      Eigen::Matrix<float, dsp::BLOCK_SIZE, 2>::Random();
+  SpectralSum sum;
+  Block y;
+  mimo.push(x);
+  sum.clear();
+  mimo.accumulate(0, sum);
+  sum.finish(y);
+  mimo.push(Eigen::Matrix<float, dsp::BLOCK_SIZE, 2>::Zero());
+  sum.clear();
+  mimo.accumulate(0, sum);
+  sum.finish(y);
+  for (int i = 2; i < static_cast<int>(dsp::BLOCK_SIZE); ++i)
+    ASSERT_NEAR(y(i), x(i - 2, 1), 1e-5f);
+}
+
+TEST(prepared_row_crossfades_at_next_push) {
+  constexpr int J = 2;
+  std::array<IRBlock, J> h1 = {IRBlock::Random(), IRBlock::Random()};
+  std::array<IRBlock, J> h2 = {IRBlock::Random(), IRBlock::Random()};
+  Mimo mimo(J, 1);
+  std::array<PLS, J> ref1, ref2;
+  for (int j = 0; j < J; ++j) {
+    mimo.setImpulseResponse(0, j, h1[j]);
+    ref1[j].setImpulseResponse(h1[j]);
+    ref2[j].setImpulseResponse(h2[j]);
+  }
+  const auto &fadeOut = crossfadeOutRamp();
+  SpectralSum sum;
+
+  for (int k = 0; k < 10; ++k) {
+    if (k == 4)
+      mimo.prepareImpulseResponses(0, h2);
+    const Eigen::Matrix<float, dsp::BLOCK_SIZE, J> x =
+        Eigen::Matrix<float, dsp::BLOCK_SIZE, J>::Random();
+    mimo.push(x);
+    ASSERT_EQ(mimo.kernelChanged(0), k == 4);
+    Block y1 = Block::Zero(), y2 = Block::Zero(), y;
+    for (int j = 0; j < J; ++j) {
+      Block yj;
+      ref1[j].step(x.col(j), yj);
+      y1 += yj;
+      ref2[j].step(x.col(j), yj);
+      y2 += yj;
+    }
+    sum.clear();
+    mimo.accumulate(0, sum);
+    sum.finish(y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      float expected = k < 4 ? y1(i) : y2(i);
+      if (k == 4)
+        expected = fadeOut(i) * y1(i) + (1.0f - fadeOut(i)) * y2(i);
+      ASSERT_NEAR(y(i), expected, 1e-4f * std::max(1.0f, std::abs(expected)));
+    }
+  }
+}
+
+int main() {
+  RUN_TEST(single_input_is_bit_identical_to_multi_kernel);
+  RUN_TEST(each_output_sums_its_row);
+  RUN_TEST(sparse_row_keeps_other_entries);
+  RUN_TEST(prepared_row_crossfades_at_next_push);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
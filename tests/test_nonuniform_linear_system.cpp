@@ -0,0 +1,154 @@
+// Tests for NonUniformLinearSystem<IR_SIZE> (zero-latency non-uniform
+// partitioned convolution with a background tail)
+#include "test_harness.h"
+#include "utils/LinearSystem.h"
+#include "utils/NonUniformLinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+using Block = Partitioning::Block;
+
+// Max relative error against the uniformly partitioned engine
+template <typename Sys, int N> static float maxErrorVsUniform(int blocks) {
+  using IR = typename PartitionedLinearSystem<N>::IRBlock;
+  IR h = IR::Random(N) * 0.05f;
+  PartitionedLinearSystem<N> ref(h);
+  Sys sys(h);
+  float maxErr = 0.0f;
+  for (int b = 0; b < blocks; ++b) {
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    sys.step(x, y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      const float tol = std::max(1.0f, std::abs(yRef(i)));
+      maxErr = std::max(maxErr, std::abs(y(i) - yRef(i)) / tol);
+    }
+  }
+  return maxErr;
+}
+
+TEST(level_layout_is_gardner) {
+  NonUniformLinearSystem<8192> sys;
+  const auto levels = sys.levels();
+  ASSERT_TRUE(!levels.empty());
+  int covered = NonUniformLinearSystem<8192>::HEAD_SIZE;
+  int prevSize = dsp::BLOCK_SIZE;
+  for (const auto &l : levels) {
+    ASSERT_EQ(l.offset, covered);
+    ASSERT_EQ(l.offset, 2 * l.size); // one segment period of worker slack
+    ASSERT_TRUE(l.size >= prevSize);
+    covered += l.partitions * l.size;
+    prevSize = l.size;
+  }
+  ASSERT_TRUE(covered >= 8192);
+}
+
+TEST(short_ir_has_no_tail) {
+  NonUniformLinearSystem<dsp::IR_SIZE> sys;
+  ASSERT_TRUE(sys.levels().empty());
+}
+
+TEST(zero_latency_head) {
+  using Sys = NonUniformLinearSystem<8192>;
+  Sys::IRBlock h = Sys::IRBlock::Zero();
+  h(0) = 1.0f;
+  Sys sys(h);
+  Block x = Block::Random();
+  Block y;
+  sys.step(x, y);
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+    ASSERT_NEAR(y(i), x(i), 1e-5f);
+  }
+}
+
+TEST(tail_tap_arrives_on_time) {
+  using Sys = NonUniformLinearSystem<8192>;
+  Sys::IRBlock h = Sys::IRBlock::Zero();
+  h(8191) = 1.0f;
+  Sys sys(h);
+
+  Block x = Block::Zero();
+  x(0) = 1.0f;
+  Block y;
+  sys.step(x, y);
+  x.setZero();
+  for (int b = 1; b <= 8191 / static_cast<int>(dsp::BLOCK_SIZE); ++b) {
+    sys.step(x, y);
+  }
+  ASSERT_NEAR(y(8191 % dsp::BLOCK_SIZE), 1.0f, 1e-5f);
+}
+
+TEST(matches_uniform_partitioning) {
+  ASSERT_TRUE((maxErrorVsUniform<NonUniformLinearSystem<8192>, 8192>(80)) <
+              1e-4f);
+}
+
+TEST(capped_last_level_matches_uniform_partitioning) {
+  using Sys = NonUniformLinearSystem<8192, 4 * dsp::BLOCK_SIZE>;
+  ASSERT_TRUE((maxErrorVsUniform<Sys, 8192>(80)) < 1e-4f);
+}
+
+TEST(non_multiple_ir_matches_direct_form) {
+  using Sys = NonUniformLinearSystem<3000>;
+  using IR = LinearSystem<3000>::IRBlock;
+  IR h = IR::Random() * 0.05f;
+  LinearSystem<3000> ref(h);
+  Sys sys(h);
+  for (int b = 0; b < 30; ++b) {
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    sys.step(x, y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y(i), yRef(i), 1e-4f);
+    }
+  }
+}
+
+TEST(sparse_ir_matches_direct_form) {
+  // Nonzero taps only in the head and in one late tail partition, so most
+  // levels have nothing to convolve
+  using Sys = NonUniformLinearSystem<8192>;
+  using IR = LinearSystem<8192>::IRBlock;
+  IR h = IR::Zero(8192);
+  h.head(100).setRandom();
+  h.segment(6000, 50).setRandom();
+  LinearSystem<8192> ref(h);
+  Sys sys(h);
+  for (int b = 0; b < 40; ++b) {
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    sys.step(x, y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y(i), yRef(i), 1e-4f);
+    }
+  }
+}
+
+TEST(worker_stats_count_segments) {
+  using Sys = NonUniformLinearSystem<8192>;
+  Sys sys(Sys::IRBlock::Random() * 0.05f);
+  Block x = Block::Random();
+  Block y;
+  for (int b = 0; b < 64; ++b)
+    sys.step(x, y);
+  const auto s = sys.workerStats();
+  ASSERT_TRUE(s.segments > 0);
+  ASSERT_TRUE(s.late <= s.segments);
+  ASSERT_TRUE(s.minSlackUs >= 0.0);
+}
+
+int main() {
+  RUN_TEST(level_layout_is_gardner);
+  RUN_TEST(short_ir_has_no_tail);
+  RUN_TEST(zero_latency_head);
+  RUN_TEST(tail_tap_arrives_on_time);
+  RUN_TEST(matches_uniform_partitioning);
+  RUN_TEST(capped_last_level_matches_uniform_partitioning);
+  RUN_TEST(non_multiple_ir_matches_direct_form);
+  RUN_TEST(sparse_ir_matches_direct_form);
+  RUN_TEST(worker_stats_count_segments);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+// Tests for PartitionedLinearSystem<IR_SIZE> (uniformly partitioned
+// overlap-save convolution)
+#include "test_harness.h"
+#include "utils/FastLinearSystem.h"
+#include "utils/LinearSystem.h"
+#include "utils/PartitionedLinearSystem.h"
+
+using PLS = PartitionedLinearSystem<dsp::IR_SIZE>;
+using Block = PLS::Block;
+using IRBlock = PLS::IRBlock;
+
+// Max relative error against the direct-form reference over `blocks` blocks
+template <int N>
+static float maxErrorVsDirect(const typename LinearSystem<N>::IRBlock &h,
+                              int blocks) {
+  LinearSystem<N> ref(h);
+  PartitionedLinearSystem<N> sys(h);
+  float maxErr = 0.0f;
+  for (int b = 0; b < blocks; ++b) {
+    Block x = Block::Random();
+    Block yRef, y;
+    ref.step(x, yRef);
+    sys.step(x, y);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      const float tol = std::max(1.0f, std::abs(yRef(i)));
+      maxErr = std::max(maxErr, std::abs(y(i) - yRef(i)) / tol);
+    }
+  }
+  return maxErr;
+}
+
+TEST(partition_count) {
+  ASSERT_EQ(PLS::NUM_PARTITIONS,
+            static_cast<int>(dsp::IR_SIZE / dsp::BLOCK_SIZE));
+  ASSERT_EQ(PartitionedLinearSystem<300>::NUM_PARTITIONS, 2);
+  ASSERT_EQ(PLS::FFT_SIZE, static_cast<int>(2 * dsp::BLOCK_SIZE));
+}
+
+TEST(zero_ir_produces_zero) {
+  PLS sys;
+  Block input = Block::Ones();
+  Block output;
+  sys.step(input, output);
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+    ASSERT_NEAR(output(i), 0.0f, 1e-6f);
+  }
+}
+
+TEST(delta_ir_is_passthrough) {
+  IRBlock h = IRBlock::Zero();
+  h(0) = 1.0f;
+  PLS sys(h);
+  Block input = Block::Random();
+  Block output;
+  sys.step(input, output);
+  for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+    ASSERT_NEAR(output(i), input(i), 1e-5f);
+  }
+}
+
+TEST(last_tap_delay_crosses_partitions) {
+  IRBlock h = IRBlock::Zero();
+  h(dsp::IR_SIZE - 1) = 1.0f;
+  PLS sys(h);
+
+  Block x = Block::Zero();
+  x(0) = 1.0f;
+  Block y;
+  sys.step(x, y);
+  x.setZero();
+  const int target = dsp::IR_SIZE - 1;
+  for (int b = 1; b <= target / static_cast<int>(dsp::BLOCK_SIZE); ++b) {
+    sys.step(x, y);
+  }
+  ASSERT_NEAR(y(target % dsp::BLOCK_SIZE), 1.0f, 1e-5f);
+}
+
+TEST(matches_direct_form) {
+  ASSERT_TRUE(maxErrorVsDirect<dsp::IR_SIZE>(IRBlock::Random(), 12) < 1e-4f);
+}
+
+TEST(non_multiple_ir_matches_direct_form) {
+  using H = LinearSystem<300>::IRBlock;
+  ASSERT_TRUE(maxErrorVsDirect<300>(H::Random(), 6) < 1e-4f);
+}
+
+TEST(long_ir_matches_direct_form) {
+  using H = LinearSystem<4096>::IRBlock;
+  H h = H::Random() * 0.1f;
+  ASSERT_TRUE(maxErrorVsDirect<4096>(h, 20) < 1e-4f);
+}
+
+TEST(matches_fast_linear_system) {
+  IRBlock h = IRBlock::Random();
+  PLS sys(h);
+  FastLinearSystem<dsp::IR_SIZE> fast(h);
+  for (int b = 0; b < 8; ++b) {
+    Block x = Block::Random();
+    Block y1, y2;
+    sys.step(x, y1);
+    fast.step(x, y2);
+    for (int i = 0; i < static_cast<int>(dsp::BLOCK_SIZE); ++i) {
+      ASSERT_NEAR(y1(i), y2(i), 1e-4f * std::max(1.0f, std::abs(y2(i))));
+    }
+  }
+}
+
+TEST(room_length_ir_uses_heap_storage) {
+  using Room = PartitionedLinearSystem<65536>;
+  Room::IRBlock h = Room::IRBlock::Zero(65536);
+  h(65535) = 0.5f;
+  Room sys(h);
+  ASSERT_EQ(sys.getImpulseResponse().size(), 65536);
+  Block x = Block::Zero();
+  x(0) = 1.0f;
+  Block y;
+  sys.step(x, y);
+  ASSERT_NEAR(y.cwiseAbs().maxCoeff(), 0.0f, 1e-6f);
+}
+
+TEST(zero_partitions_are_skipped) {
+  // Partitions 1 and 3 (of 4) are empty: only 0 and 2 are convolved
+  IRBlock h = IRBlock::Random();
+  h.segment(dsp::BLOCK_SIZE, dsp::BLOCK_SIZE).setZero();
+  h.tail(dsp::BLOCK_SIZE).setZero();
+  PartitionedKernel<PLS::NUM_PARTITIONS> kernel;
+  kernel.set(h);
+  ASSERT_EQ(kernel.numActive(), 2);
+  ASSERT_EQ(kernel.active(0), 0);
+  ASSERT_EQ(kernel.active(1), 2);
+  ASSERT_TRUE(maxErrorVsDirect<dsp::IR_SIZE>(h, 12) < 1e-4f);
+}
+
+int main() {
+  RUN_TEST(partition_count);
+  RUN_TEST(zero_ir_produces_zero);
+  RUN_TEST(delta_ir_is_passthrough);
+  RUN_TEST(last_tap_delay_crosses_partitions);
+  RUN_TEST(matches_direct_form);
+  RUN_TEST(non_multiple_ir_matches_direct_form);
+  RUN_TEST(long_ir_matches_direct_form);
+  RUN_TEST(matches_fast_linear_system);
+  RUN_TEST(room_length_ir_uses_heap_storage);
+  RUN_TEST(zero_partitions_are_skipped);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,126 @@
+// Tests for Philox4x32 (counter-based RNG with block fills)
+#include "dsp_config.h"
+#include "test_harness.h"
+#include "utils/Philox.h"
+
+#include <cmath>
+
+using Block = Eigen::Matrix<float, dsp::BLOCK_SIZE, 1>;
+using Counter = Philox4x32::Counter;
+
+// Known-answer vectors from the Random123 distribution (kat_vectors)
+TEST(matches_random123_known_answers) {
+  const Counter a = Philox4x32::encrypt({0, 0, 0, 0}, {0, 0});
+  ASSERT_EQ(a[0], 0x6627e8d5u);
+  ASSERT_EQ(a[1], 0xe169c58du);
+  ASSERT_EQ(a[2], 0xbc57ac4cu);
+  ASSERT_EQ(a[3], 0x9b00dbd8u);
+
+  const Counter b = Philox4x32::encrypt(
+      {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+      {0xffffffff, 0xffffffff});
+  ASSERT_EQ(b[0], 0x408f276du);
+  ASSERT_EQ(b[1], 0x41c83b0eu);
+  ASSERT_EQ(b[2], 0xa20bc7c6u);
+  ASSERT_EQ(b[3], 0x6d5451fdu);
+
+  const Counter c = Philox4x32::encrypt(
+      {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+      {0xa4093822, 0x299f31d0});
+  ASSERT_EQ(c[0], 0xd16cfe09u);
+  ASSERT_EQ(c[1], 0x94fdccebu);
+  ASSERT_EQ(c[2], 0x5001e420u);
+  ASSERT_EQ(c[3], 0x24126ea1u);
+}
+
+TEST(batched_fill_matches_scalar_counters) {
+  Philox4x32 batched(0x1234567890abcdefull, 7), scalar(0x1234567890abcdefull, 7);
+  Block u;
+  batched.fillUniform(u);
+  for (int j = 0; j < static_cast<int>(dsp::BLOCK_SIZE / 4); ++j) {
+    const Counter w = scalar.next();
+    for (int k = 0; k < 4; ++k)
+      ASSERT_EQ(u(4 * j + k), static_cast<float>(w[k] >> 8) * 0x1p-24f);
+  }
+  ASSERT_EQ(batched.position(), scalar.position());
+}
+
+TEST(same_seed_and_stream_reproduce) {
+  Philox4x32 a(42, 3), b(42, 3);
+  Block x, y;
+  a.fillNormal(x);
+  b.fillNormal(y);
+  ASSERT_TRUE(x == y);
+}
+
+TEST(streams_and_seeds_are_independent) {
+  Philox4x32 a(42, 0), b(42, 1), c(43, 0);
+  Block x, y, z;
+  a.fillNormal(x);
+  b.fillNormal(y);
+  c.fillNormal(z);
+  ASSERT_TRUE(x != y);
+  ASSERT_TRUE(x != z);
+  // Uncorrelated to within a few standard errors (1/sqrt(256) = 0.06)
+  const float rxy = x.dot(y) / std::sqrt(x.squaredNorm() * y.squaredNorm());
+  ASSERT_TRUE(std::abs(rxy) < 0.25f);
+}
+
+TEST(seek_replays_a_block) {
+  Philox4x32 rng(9, 2);
+  Block first, second, replay;
+  rng.fillNormal(first);
+  const uint64_t mark = rng.position();
+  ASSERT_EQ(mark, static_cast<uint64_t>(dsp::BLOCK_SIZE / 4));
+  rng.fillNormal(second);
+  rng.seek(mark);
+  rng.fillNormal(replay);
+  ASSERT_TRUE(second == replay);
+}
+
+TEST(odd_sizes_consume_whole_counters) {
+  Philox4x32 rng(1, 0);
+  Eigen::VectorXf v(70);
+  rng.fillUniform(v);
+  ASSERT_EQ(rng.position(), 18u); // ceil(70 / 4)
+  Eigen::VectorXf empty(0);
+  rng.fillUniform(empty);
+  ASSERT_EQ(rng.position(), 18u);
+}
+
+TEST(uniform_range_and_moments) {
+  Philox4x32 rng(5, 0);
+  Eigen::VectorXf v(1 << 16);
+  rng.fillUniform(v, -1.0f, 1.0f);
+  ASSERT_TRUE(v.minCoeff() >= -1.0f);
+  ASSERT_TRUE(v.maxCoeff() < 1.0f);
+  ASSERT_NEAR(v.mean(), 0.0f, 0.01f);
+  ASSERT_NEAR(v.squaredNorm() / v.size(), 1.0f / 3.0f, 0.01f);
+}
+
+TEST(normal_moments) {
+  Philox4x32 rng(6, 0);
+  Eigen::VectorXf v(1 << 16);
+  rng.fillNormal(v, 2.0f, 0.5f);
+  ASSERT_TRUE(v.allFinite());
+  const float mean = v.mean();
+  const float var = (v.array() - mean).square().mean();
+  ASSERT_NEAR(mean, 2.0f, 0.01f);
+  ASSERT_NEAR(var, 0.25f, 0.01f);
+  // Tails: about 0.27% of N(0,1) lies beyond 3 sigma
+  const auto beyond = ((v.array() - 2.0f).abs() > 1.5f).count();
+  ASSERT_TRUE(beyond > 80 && beyond < 280);
+}
+
+int main() {
+  RUN_TEST(matches_random123_known_answers);
+  RUN_TEST(batched_fill_matches_scalar_counters);
+  RUN_TEST(same_seed_and_stream_reproduce);
+  RUN_TEST(streams_and_seeds_are_independent);
+  RUN_TEST(seek_replays_a_block);
+  RUN_TEST(odd_sizes_consume_whole_counters);
+  RUN_TEST(uniform_range_and_moments);
+  RUN_TEST(normal_moments);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
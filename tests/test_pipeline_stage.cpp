@@ -0,0 +1,105 @@
+// Tests for PipelineStage (one-ahead worker stage)
+#include "test_harness.h"
+#include "utils/PipelineStage.h"
+
+#include <chrono>
+#include <cstdint>
+#include <semaphore>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(results_match_inline_stateful_computation) {
+  // Running sum: each result depends on every earlier job
+  long state = 0;
+  PipelineStage<int, long> stage([&](const int &job, long &out) {
+    state += job;
+    out = state;
+  });
+
+  long expected = 0;
+  stage.submit(1);
+  for (int k = 1; k <= 1000; ++k) {
+    stage.submit(k + 1); // next job queued before this result is used
+    expected += k;
+    ASSERT_EQ(stage.wait(), expected);
+    stage.release();
+  }
+  ASSERT_EQ(stage.wait(), expected + 1001);
+  stage.release();
+}
+
+TEST(worker_runs_while_consumer_is_busy) {
+  PipelineStage<int, int> stage([](const int &job, int &out) {
+    std::this_thread::sleep_for(2ms);
+    out = 2 * job;
+  });
+  stage.submit(0);
+  for (int k = 0; k < 20; ++k) {
+    stage.submit(k + 1);
+    ASSERT_EQ(stage.wait(), 2 * k);
+    stage.release();
+    std::this_thread::sleep_for(5ms); // consumer work covers the job
+  }
+  ASSERT_EQ(stage.wait(), 40);
+  stage.release();
+  // Only the very first wait can have found its job unfinished
+  ASSERT_TRUE(stage.stalls() <= 1u);
+}
+
+TEST(slow_worker_stalls_consumer) {
+  // Each job is held until its wait() has counted the stall, so every wait
+  // finds its result unfinished however the threads are scheduled
+  std::binary_semaphore go{0};
+  PipelineStage<int, int> stage([&](const int &job, int &out) {
+    go.acquire();
+    out = job;
+  });
+  for (int k = 0; k < 5; ++k) {
+    stage.submit(k);
+    std::jthread releaser([&] {
+      while (stage.stalls() < static_cast<uint64_t>(k) + 1)
+        std::this_thread::yield();
+      go.release();
+    });
+    ASSERT_EQ(stage.wait(), k);
+    stage.release();
+  }
+  ASSERT_EQ(stage.stalls(), 5u);
+}
+
+TEST(worker_starts_on_first_submit) {
+  bool ran = false;
+  {
+    PipelineStage<int, int> unused([&](const int &, int &) { ran = true; });
+    ASSERT_TRUE(!unused.started());
+  }
+  ASSERT_TRUE(!ran);
+
+  PipelineStage<int, int> stage([](const int &job, int &out) { out = job; });
+  ASSERT_TRUE(!stage.started());
+  stage.submit(7);
+  ASSERT_TRUE(stage.started());
+  ASSERT_EQ(stage.wait(), 7);
+  stage.release();
+}
+
+TEST(destroys_with_unconsumed_jobs) {
+  for (int i = 0; i < 20; ++i) {
+    PipelineStage<int, int> stage([](const int &job, int &out) { out = job; });
+    stage.submit(1);
+    if (i % 2)
+      stage.submit(2);
+  }
+  ASSERT_TRUE(true);
+}
+
+int main() {
+  RUN_TEST(results_match_inline_stateful_computation);
+  RUN_TEST(worker_runs_while_consumer_is_busy);
+  RUN_TEST(slow_worker_stalls_consumer);
+  RUN_TEST(worker_starts_on_first_submit);
+  RUN_TEST(destroys_with_unconsumed_jobs);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
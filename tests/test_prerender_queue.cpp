@@ -0,0 +1,128 @@
+// Tests for PrerenderQueue (background block producer)
+#include "test_harness.h"
+#include "utils/PrerenderQueue.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// pop() until a block is ready (bounded: false if the producer never
+// delivers one)
+template <typename Q, typename T> static bool popWhenReady(Q &q, T &v) {
+  for (int i = 0; i < 20000; ++i) {
+    if (q.pop(v))
+      return true;
+    std::this_thread::sleep_for(100us);
+  }
+  return false;
+}
+
+// Wait (bounded) until the producer has filled the ring
+template <typename Q> static bool waitUntilFull(const Q &q) {
+  for (int i = 0; i < 2000 && q.ready() < q.ahead(); ++i)
+    std::this_thread::sleep_for(1ms);
+  return q.ready() == q.ahead();
+}
+
+TEST(blocks_come_out_in_render_order) {
+  int next = 0;
+  PrerenderQueue<int, 8> q([&](int &v) { v = next++; });
+  q.start();
+  for (int i = 0; i < 1000; ++i) {
+    int v = -1;
+    ASSERT_TRUE(popWhenReady(q, v));
+    ASSERT_EQ(v, i);
+  }
+}
+
+TEST(producer_renders_ahead) {
+  int next = 0;
+  PrerenderQueue<int, 8> q([&](int &v) { v = next++; });
+  q.start();
+  ASSERT_TRUE(waitUntilFull(q));
+  ASSERT_EQ(q.underruns(), 0u);
+
+  // Stays at most Ahead blocks ahead...
+  std::this_thread::sleep_for(10ms);
+  ASSERT_EQ(next, 8);
+
+  // ...and refills once drained to half
+  int v;
+  for (int i = 0; i < 4; ++i)
+    ASSERT_TRUE(q.pop(v));
+  ASSERT_TRUE(waitUntilFull(q));
+  ASSERT_EQ(next, 12);
+}
+
+TEST(slow_producer_counts_underruns_but_never_skips) {
+  int next = 0;
+  PrerenderQueue<int, 4> q([&](int &v) {
+    std::this_thread::sleep_for(2ms);
+    v = next++;
+  });
+  q.start();
+  int v = -1;
+  ASSERT_TRUE(!q.pop(v)); // nothing can be ready yet, and pop() won't wait
+  ASSERT_EQ(v, -1);
+  ASSERT_EQ(q.underruns(), 1u);
+  // Whatever got popped is still every block in order
+  int expected = 0;
+  while (expected < 10) {
+    if (q.pop(v)) {
+      ASSERT_EQ(v, expected);
+      ++expected;
+    } else {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+  ASSERT_TRUE(q.underruns() >= 1u);
+}
+
+TEST(unstarted_queue_renders_in_place) {
+  int next = 0;
+  PrerenderQueue<int, 4> q([&](int &v) { v = next++; });
+  int v = -1;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(q.pop(v));
+    ASSERT_EQ(v, i);
+  }
+  ASSERT_EQ(next, 10); // nothing rendered ahead
+  ASSERT_EQ(q.underruns(), 0u);
+}
+
+TEST(stop_keeps_rendered_blocks) {
+  int next = 0;
+  PrerenderQueue<int, 4> q([&](int &v) { v = next++; });
+  q.start();
+  ASSERT_TRUE(waitUntilFull(q));
+  q.stop();
+  int v = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(q.pop(v));
+    ASSERT_EQ(v, i);
+  }
+  ASSERT_EQ(q.ready(), 0u);
+  ASSERT_TRUE(!q.pop(v));
+}
+
+TEST(destroys_while_producer_sleeps) {
+  for (int i = 0; i < 50; ++i) {
+    PrerenderQueue<int, 2> q([](int &v) { v = 1; });
+    q.start();
+    if (i % 2)
+      std::this_thread::sleep_for(100us);
+  }
+  ASSERT_TRUE(true);
+}
+
+int main() {
+  RUN_TEST(blocks_come_out_in_render_order);
+  RUN_TEST(producer_renders_ahead);
+  RUN_TEST(slow_producer_counts_underruns_but_never_skips);
+  RUN_TEST(unstarted_queue_renders_in_place);
+  RUN_TEST(stop_keeps_rendered_blocks);
+  RUN_TEST(destroys_while_producer_sleeps);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// Tests for fft::RealFFT and its backends
+#include "test_harness.h"
+#include "utils/RealFFT.h"
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using cf = std::complex<float>;
+
+static std::vector<float> randomSignal(int n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+  std::vector<float> x(n);
+  for (auto &v : x)
+    v = u(rng);
+  return x;
+}
+
+// Max |X - DFT(x)| over the half spectrum, DFT computed in double
+static double maxErrorVsDft(fft::Backend backend, int n) {
+  const std::vector<float> x = randomSignal(n, n);
+  fft::RealFFT t(n, backend);
+  std::vector<cf> X(t.bins());
+  t.fwd(X.data(), x.data());
+  double maxErr = 0.0;
+  for (int k = 0; k < t.bins(); ++k) {
+    std::complex<double> ref = 0.0;
+    for (int i = 0; i < n; ++i)
+      ref += static_cast<double>(x[i]) *
+             std::polar(1.0, -2.0 * std::numbers::pi * k * i / n);
+    maxErr = std::max(maxErr, std::abs(std::complex<double>(X[k]) - ref));
+  }
+  return maxErr;
+}
+
+TEST(parse_backend_names) {
+  ASSERT_TRUE(fft::parseBackend("kiss") == fft::Backend::Kiss);
+  ASSERT_TRUE(fft::parseBackend("split") == fft::Backend::Split);
+  bool threw = false;
+  try {
+    fft::parseBackend("fftw");
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  ASSERT_TRUE(threw);
+}
+
+TEST(both_backends_match_dft) {
+  for (int n : {8, 16, 64, 512, 2048}) {
+    ASSERT_TRUE(maxErrorVsDft(fft::Backend::Kiss, n) < 1e-3 * std::sqrt(n));
+    ASSERT_TRUE(maxErrorVsDft(fft::Backend::Split, n) < 1e-3 * std::sqrt(n));
+  }
+}
+
+TEST(round_trip_is_identity) {
+  for (fft::Backend backend : {fft::Backend::Kiss, fft::Backend::Split}) {
+    for (int n : {8, 64, 512, 8192}) {
+      const std::vector<float> x = randomSignal(n, 3);
+      fft::RealFFT t(n, backend);
+      std::vector<cf> X(t.bins());
+      std::vector<float> y(n);
+      t.fwd(X.data(), x.data());
+      t.inv(y.data(), X.data());
+      for (int i = 0; i < n; ++i)
+        ASSERT_NEAR(y[i], x[i], 1e-5f);
+    }
+  }
+}
+
+TEST(backends_agree_on_inverse) {
+  const int n = 1024;
+  fft::RealFFT kiss(n, fft::Backend::Kiss), split(n, fft::Backend::Split);
+  const std::vector<float> x = randomSignal(n, 9);
+  std::vector<cf> X(n / 2 + 1);
+  kiss.fwd(X.data(), x.data());
+  X[7] *= cf(0.5f, 2.0f); // any half spectrum, not only one of a signal
+  std::vector<float> a(n), b(n);
+  kiss.inv(a.data(), X.data());
+  split.inv(b.data(), X.data());
+  for (int i = 0; i < n; ++i)
+    ASSERT_NEAR(a[i], b[i], 1e-5f);
+}
+
+TEST(split_plans_are_shared) {
+  fft::RealFFT a(512, fft::Backend::Split), b(512, fft::Backend::Split);
+  fft::RealFFT c(1024, fft::Backend::Split);
+  ASSERT_TRUE(a.plan() != nullptr);
+  ASSERT_TRUE(a.plan() == b.plan());
+  ASSERT_TRUE(a.plan() != c.plan());
+  ASSERT_TRUE(fft::splitPlan(512).get() == a.plan());
+}
+
+TEST(unsupported_sizes_fall_back_to_kiss) {
+  fft::RealFFT odd(48, fft::Backend::Split);
+  ASSERT_TRUE(odd.backend() == fft::Backend::Kiss);
+  ASSERT_TRUE(odd.plan() == nullptr);
+  const std::vector<float> x = randomSignal(48, 5);
+  std::vector<cf> X(odd.bins());
+  std::vector<float> y(48);
+  odd.fwd(X.data(), x.data());
+  odd.inv(y.data(), X.data());
+  for (int i = 0; i < 48; ++i)
+    ASSERT_NEAR(y[i], x[i], 1e-5f);
+}
+
+TEST(default_backend_is_runtime_selectable) {
+  const fft::Backend saved = fft::defaultBackend();
+  fft::setDefaultBackend(fft::Backend::Kiss);
+  ASSERT_TRUE(fft::RealFFT(256).backend() == fft::Backend::Kiss);
+  fft::setDefaultBackend(fft::Backend::Split);
+  ASSERT_TRUE(fft::RealFFT(256).backend() == fft::Backend::Split);
+  fft::setDefaultBackend(saved);
+}
+
+int main() {
+  RUN_TEST(parse_backend_names);
+  RUN_TEST(both_backends_match_dft);
+  RUN_TEST(round_trip_is_identity);
+  RUN_TEST(backends_agree_on_inverse);
+  RUN_TEST(split_plans_are_shared);
+  RUN_TEST(unsupported_sizes_fall_back_to_kiss);
+  RUN_TEST(default_backend_is_runtime_selectable);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
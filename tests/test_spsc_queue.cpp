@@ -0,0 +1,129 @@
+// Tests for SPSCQueue<T, Capacity> (wait-free SPSC FIFO with overrun count)
+#include "test_harness.h"
+#include "utils/SPSCQueue.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(empty_queue_has_no_front) {
+  SPSCQueue<int, 4> q;
+  ASSERT_TRUE(q.front() == nullptr);
+  int out;
+  ASSERT_TRUE(!q.tryPop(out));
+  ASSERT_EQ(q.size(), 0u);
+}
+
+TEST(fifo_order) {
+  SPSCQueue<int, 8> q;
+  for (int i = 0; i < 5; ++i)
+    ASSERT_TRUE(q.push(i));
+  ASSERT_EQ(q.size(), 5u);
+  for (int i = 0; i < 5; ++i) {
+    int out = -1;
+    ASSERT_TRUE(q.tryPop(out));
+    ASSERT_EQ(out, i);
+  }
+}
+
+TEST(full_queue_drops_newest_and_counts_overrun) {
+  SPSCQueue<int, 4> q;
+  for (int i = 0; i < 4; ++i)
+    ASSERT_TRUE(q.push(i));
+  ASSERT_TRUE(!q.push(99));
+  ASSERT_TRUE(!q.push(100));
+  ASSERT_EQ(q.overruns(), 2u);
+
+  // The oldest elements survive, unlike RingBuffer's overwrite
+  ASSERT_EQ(*q.front(), 0);
+  q.pop();
+  ASSERT_TRUE(q.push(4));
+  for (int i = 1; i <= 4; ++i) {
+    int out;
+    ASSERT_TRUE(q.tryPop(out));
+    ASSERT_EQ(out, i);
+  }
+}
+
+TEST(indices_wrap) {
+  SPSCQueue<int, 2> q;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(q.push(i));
+    int out;
+    ASSERT_TRUE(q.tryPop(out));
+    ASSERT_EQ(out, i);
+  }
+}
+
+TEST(waitFor_times_out_when_empty) {
+  SPSCQueue<int, 4> q;
+  const auto t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(!q.waitFor(5ms));
+  ASSERT_TRUE(std::chrono::steady_clock::now() - t0 >= 4ms);
+}
+
+TEST(waitFor_wakes_on_push) {
+  SPSCQueue<int, 4> q;
+  std::jthread producer([&] {
+    std::this_thread::sleep_for(10ms);
+    q.push(7);
+  });
+  const auto t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(q.waitFor(5s));
+  ASSERT_TRUE(std::chrono::steady_clock::now() - t0 < 2s);
+  ASSERT_EQ(*q.front(), 7);
+}
+
+TEST(wake_interrupts_wait) {
+  SPSCQueue<int, 4> q;
+  std::jthread waker([&] {
+    std::this_thread::sleep_for(10ms);
+    q.wake();
+  });
+  const auto t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(!q.waitFor(5s));
+  ASSERT_TRUE(std::chrono::steady_clock::now() - t0 < 2s);
+}
+
+TEST(concurrent_transfer_is_lossless_in_order) {
+  // Every element is either delivered in order or counted as an overrun
+  SPSCQueue<uint64_t, 16> q;
+  constexpr uint64_t N = 500000;
+  std::jthread producer([&] {
+    for (uint64_t i = 1; i <= N; ++i)
+      q.push(i);
+    q.push(0); // may be dropped; the consumer also stops on the count
+  });
+
+  uint64_t last = 0, received = 0;
+  bool ordered = true;
+  while (received + q.overruns() < N) {
+    uint64_t v;
+    if (!q.tryPop(v)) {
+      q.waitFor(1ms);
+      continue;
+    }
+    if (v == 0)
+      break;
+    ordered &= (v > last);
+    last = v;
+    ++received;
+  }
+  producer.join();
+  ASSERT_TRUE(ordered);
+  ASSERT_TRUE(received + q.overruns() >= N);
+}
+
+int main() {
+  RUN_TEST(empty_queue_has_no_front);
+  RUN_TEST(fifo_order);
+  RUN_TEST(full_queue_drops_newest_and_counts_overrun);
+  RUN_TEST(indices_wrap);
+  RUN_TEST(waitFor_times_out_when_empty);
+  RUN_TEST(waitFor_wakes_on_push);
+  RUN_TEST(wake_interrupts_wait);
+  RUN_TEST(concurrent_transfer_is_lossless_in_order);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+// Tests for TripleBuffer<T> (latest-value channel)
+#include "test_harness.h"
+#include "utils/BlockPool.h"
+#include "utils/TripleBuffer.h"
+#include <Eigen/Dense>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(initial_tryRead_returns_false) {
+  TripleBuffer<int> tb;
+  int out = -1;
+  ASSERT_TRUE(!tb.tryRead(out));
+  ASSERT_EQ(out, -1);
+  ASSERT_TRUE(tb.acquire() == nullptr);
+}
+
+TEST(publish_then_tryRead) {
+  TripleBuffer<int> tb;
+  tb.publish(42);
+  int out = 0;
+  ASSERT_TRUE(tb.tryRead(out));
+  ASSERT_EQ(out, 42);
+  ASSERT_TRUE(!tb.tryRead(out)); // nothing new
+}
+
+TEST(readLatest_and_hasNew) {
+  TripleBuffer<int> tb;
+  ASSERT_TRUE(!tb.hasNew());
+  tb.publish(10);
+  ASSERT_TRUE(tb.hasNew());
+  int out = 0;
+  tb.readLatest(out);
+  ASSERT_EQ(out, 10);
+  ASSERT_TRUE(!tb.hasNew());
+  tb.readLatest(out); // same value again
+  ASSERT_EQ(out, 10);
+}
+
+TEST(sequence_counts_publishes) {
+  TripleBuffer<int> tb;
+  ASSERT_EQ(tb.sequence(), 0u);
+  tb.publish(1);
+  tb.publish(2);
+  ASSERT_EQ(tb.sequence(), 2u);
+  int out;
+  tb.tryRead(out);
+  ASSERT_EQ(tb.readSequence(), 2u);
+}
+
+TEST(multiple_publishes_latest_wins) {
+  TripleBuffer<int> tb;
+  for (int i = 1; i <= 5; ++i)
+    tb.publish(i);
+  int out = 0;
+  ASSERT_TRUE(tb.tryRead(out));
+  ASSERT_EQ(out, 5);
+}
+
+TEST(beginWrite_commit_and_in_place_read) {
+  TripleBuffer<int> tb;
+  tb.beginWrite() = 99;
+  ASSERT_TRUE(!tb.hasNew()); // not visible before commit
+  tb.commit();
+  const int *v = tb.acquire();
+  ASSERT_TRUE(v != nullptr);
+  ASSERT_EQ(*v, 99);
+  tb.publish(100); // writer never touches the slot the reader holds
+  ASSERT_EQ(*v, 99);
+}
+
+TEST(carries_pool_handles_without_leaking) {
+  using Pool = BlockPool<int, 8>;
+  Pool pool;
+  {
+    TripleBuffer<Pool::Handle> tb;
+    for (int i = 0; i < 100; ++i) {
+      Pool::Handle h = pool.acquire();
+      ASSERT_TRUE(static_cast<bool>(h));
+      *h = i;
+      tb.publish(std::move(h));
+      if (i % 3 == 0) {
+        const Pool::Handle *latest = tb.acquire();
+        ASSERT_TRUE(latest && **latest == i);
+      }
+    }
+  }
+  // Every slot is back
+  std::vector<Pool::Handle> all;
+  for (size_t i = 0; i < Pool::capacity(); ++i)
+    all.push_back(pool.acquire());
+  ASSERT_EQ(pool.exhausted(), 0u);
+}
+
+TEST(stress_reads_are_never_torn) {
+  // Every published block is filled with one value; a torn read would mix
+  // two. Sequence numbers seen by the reader must never go backwards.
+  using Block = Eigen::Matrix<float, 256, 1>;
+  TripleBuffer<Block> tb;
+  std::atomic<bool> done{false};
+  constexpr int N = 100000;
+
+  std::jthread writer([&] {
+    for (int i = 1; i <= N; ++i) {
+      tb.beginWrite().setConstant(static_cast<float>(i));
+      tb.commit();
+      if (i % 64 == 0)
+        std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  int torn = 0, reads = 0;
+  float last = 0.0f;
+  bool backwards = false;
+  while (!done.load() || tb.hasNew()) {
+    const Block *b = tb.acquire();
+    if (!b) {
+      std::this_thread::yield();
+      continue;
+    }
+    ++reads;
+    if (b->minCoeff() != b->maxCoeff())
+      ++torn;
+    backwards |= (*b)(0) < last;
+    last = (*b)(0);
+  }
+  writer.join();
+  ASSERT_EQ(torn, 0);
+  ASSERT_TRUE(!backwards);
+  ASSERT_TRUE(reads > 0);
+  ASSERT_EQ(last, static_cast<float>(N)); // the final value is delivered
+}
+
+int main() {
+  RUN_TEST(initial_tryRead_returns_false);
+  RUN_TEST(publish_then_tryRead);
+  RUN_TEST(readLatest_and_hasNew);
+  RUN_TEST(sequence_counts_publishes);
+  RUN_TEST(multiple_publishes_latest_wins);
+  RUN_TEST(beginWrite_commit_and_in_place_read);
+  RUN_TEST(carries_pool_handles_without_leaking);
+  RUN_TEST(stress_reads_are_never_torn);
+  PRINT_RESULTS();
+  return g_fails > 0 ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 // Tests for WavWriter
 #include "test_harness.h"
 #include "wav_writer.h"
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
@@ -86,12 +87,67 @@ TEST(file_size_reasonable) {
   ASSERT_NEAR(static_cast<float>(size), static_cast<float>(expected), 8.0f);
 }
 
+TEST(multichannel_block_is_interleaved) {
+  std::remove(TEST_WAV.c_str());
+  Eigen::MatrixXf b(dsp::BLOCK_SIZE, 2);
+  b.col(0).setConstant(0.25f);
+  b.col(1).setConstant(-0.5f);
+  {
+    WavWriter w(TEST_WAV, {.numChannels = 2});
+    w.open();
+    w.writeBlock(b);
+    ASSERT_EQ(w.getSamplesWritten(), static_cast<size_t>(dsp::BLOCK_SIZE));
+    w.close();
+  }
+  std::ifstream f(TEST_WAV, std::ios::binary);
+  uint32_t dataSize = 0;
+  f.seekg(40);
+  f.read(reinterpret_cast<char *>(&dataSize), 4);
+  ASSERT_EQ(dataSize, static_cast<uint32_t>(dsp::BLOCK_SIZE * 2 * 2));
+  int16_t frame[2];
+  f.read(reinterpret_cast<char *>(frame), sizeof(frame));
+  ASSERT_EQ(frame[0], static_cast<int16_t>(0.25f * 32767.0f));
+  ASSERT_EQ(frame[1], static_cast<int16_t>(-0.5f * 32767.0f));
+}
+
+TEST(mismatched_channel_count_is_rejected) {
+  std::remove(TEST_WAV.c_str());
+  WavWriter w(TEST_WAV, {.numChannels = 2});
+  w.open();
+  bool blockThrew = false;
+  try {
+    w.writeBlock(Eigen::MatrixXf::Zero(dsp::BLOCK_SIZE, 3));
+  } catch (const std::invalid_argument &) {
+    blockThrew = true;
+  }
+  ASSERT_TRUE(blockThrew);
+  // A mono Block is whole stereo frames by count, but still one channel
+  bool monoThrew = false;
+  try {
+    w.writeBlock(Block(Block::Zero()));
+  } catch (const std::invalid_argument &) {
+    monoThrew = true;
+  }
+  ASSERT_TRUE(monoThrew);
+  bool samplesThrew = false;
+  const float odd[3] = {0.0f, 0.0f, 0.0f};
+  try {
+    w.writeSamples(odd, 3);
+  } catch (const std::invalid_argument &) {
+    samplesThrew = true;
+  }
+  ASSERT_TRUE(samplesThrew);
+  ASSERT_EQ(w.getSamplesWritten(), static_cast<size_t>(0));
+}
+
 int main() {
   RUN_TEST(open_creates_file);
   RUN_TEST(samples_written_count);
   RUN_TEST(duration_correct);
   RUN_TEST(wav_header_valid);
   RUN_TEST(file_size_reasonable);
+  RUN_TEST(multichannel_block_is_interleaved);
+  RUN_TEST(mismatched_channel_count_is_rejected);
   PRINT_RESULTS();
   std::remove(TEST_WAV.c_str());
   return g_fails > 0 ? 1 : 0;